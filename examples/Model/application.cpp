@@ -93,8 +93,14 @@ Application::InitializeVulkan()
             return false;
         }
 
-    m_uniformBuffer.Allocate( &m_deviceContext, nullptr, sizeof( float ) * 16 * 4 * 128,
-                              VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT );
+    {
+        voUniformAllocator::CreateParms_t parms =
+            {
+                .frameSize = sizeof( float ) * 16 * 4 * 128,
+                .numFrames = m_deviceContext.swapChain.GetFramesInFlight(),
+            };
+        m_uniforms.Create( &m_deviceContext, parms );
+    }
 
     //	Full screen texture rendering
     {
@@ -107,7 +113,7 @@ Application::InitializeVulkan()
 
         voDescriptors::CreateParms_t descriptorParms {};
         memset( &descriptorParms, 0, sizeof( descriptorParms ) );
-        descriptorParms.numUniformsVertex = 2;
+        descriptorParms.numUniformsVertex = 1; // the sampler of the shader is not read yet
         modelDescriptors.Create( &m_deviceContext, descriptorParms );
 
         voPipeline::CreateParms_t pipelineParms = {
@@ -141,7 +147,7 @@ Application::Cleanup()
     m_modelTriangle.Cleanup( m_deviceContext );
 
     modelDescriptors.Cleanup( &m_deviceContext );
-    m_uniformBuffer.Cleanup( &m_deviceContext );
+    m_uniforms.Cleanup( &m_deviceContext );
 
     // Delete Device Context
     m_deviceContext.Cleanup();
@@ -153,29 +159,8 @@ Application::Cleanup()
 void
 Application::ResizeWindow( int windowWidth, int windowHeight )
 {
+    // Viewport and scissor are dynamic, pipelines are kept across resizes
     m_deviceContext.ResizeWindow( windowWidth, windowHeight );
-
-    //	Resize full screen texture rendering
-    {
-        m_trianglePipeline.Cleanup( &m_deviceContext );
-
-        voPipeline::CreateParms_t pipelineParms = {
-            .renderPass  = m_deviceContext.swapChain.GetRenderPass(),
-            .descriptors = &modelDescriptors,
-            .shader      = &m_triangleShader,
-            .width       = m_deviceContext.swapChain.GetWidth(),
-            .height      = m_deviceContext.swapChain.GetHeight(),
-            .cullMode    = voPipeline::CULL_MODE_BACK,
-            .depthTest   = true,
-            .depthWrite  = true,
-        };
-        if( !m_trianglePipeline.Create( &m_deviceContext, pipelineParms ) )
-            {
-                printf( "Unable to build pipeline!\n" );
-                assert( 0 );
-                return;
-            }
-    }
 }
 
 void
@@ -224,31 +209,30 @@ Application::MainLoop()
 {
     while( !m_window->ShouldClose() )
         {
-            UpdateUniforms();
-
             // Draw the Scene
             DrawFrame();
         }
 }
 
 void
-Application::UpdateUniforms()
+Application::UpdateUniforms( uint32_t frameIndex )
 {
-    uint32_t uboByteOffset    = 0;
-    uint32_t cameraByteOFfset = 0;
-    uint32_t shadowByteOffset = 0;
-
-    struct camera_t
+    // Matches the uniform block of model.vert
+    struct object_t
     {
+        using std140_t = std140_block_t< mat4, mat4, mat4 >;
+
+        mat4 matModel;
         mat4 matView;
         mat4 matProj;
-        mat4 pad0;
-        mat4 pad1;
     };
-    camera_t camera {};
+
+    m_uniforms.BeginFrame( frameIndex );
 
     {
-        auto * mappedData = (unsigned char *)m_uniformBuffer.MapBuffer( &m_deviceContext );
+        Body & body = modelBody;
+
+        auto object = m_uniforms.Allocate< object_t >();
 
         {
             vec3 camPos    = { 10, 0, 0 };
@@ -274,19 +258,12 @@ Application::UpdateUniforms()
             const float fovy   = 45.0f;
             const float aspect = (float)windowWidth / (float)windowHeight; // Fixed aspect ratio
 
-            glm_perspective( glm_rad( fovy ), aspect, zNear, zFar, camera.matProj );
-
-            glm_lookat( camPos, camLookAt, camUp, camera.matView );
-
-            memcpy( mappedData + uboByteOffset, &camera, sizeof( camera ) );
+            glm_perspective( glm_rad( fovy ), aspect, zNear, zFar, object.ptr->matProj );
 
-            cameraByteOFfset  = uboByteOffset;
-            uboByteOffset    += m_deviceContext.GetAligendUniformByteOffset( sizeof( camera ) );
+            glm_lookat( camPos, camLookAt, camUp, object.ptr->matView );
         }
 
         {
-            Body & body = modelBody;
-
             // Create the transformation matrix
             mat4 matOrient;
             glm_mat4_identity( matOrient );
@@ -295,52 +272,45 @@ Application::UpdateUniforms()
             mat4 rotationMatrix;
             glm_quat_mat4( body.orientation, rotationMatrix );
 
-            // Combine identity matrix with body's rotation
-            glm_mat4_mul( matOrient, rotationMatrix, matOrient );
-
-            // Write to the mapped buffer
-            memcpy( mappedData + uboByteOffset, matOrient, sizeof( matOrient ) );
-
-            // Create render model
-            voRenderModel renderModel {};
-            renderModel.model         = &m_modelTriangle;
-            renderModel.uboByteOffset = uboByteOffset;
-            renderModel.uboByteSize   = sizeof( matOrient );
+            // Combine identity matrix with body's rotation, straight into the uniform buffer
+            glm_mat4_mul( matOrient, rotationMatrix, object.ptr->matModel );
+        }
 
-            // Copy body's position
-            glm_vec3_copy( body.position, renderModel.pos );
+        // Create render model
+        voRenderModel renderModel {};
+        renderModel.model         = &m_modelTriangle;
+        renderModel.uboByteOffset = object.offset;
+        renderModel.uboByteSize   = sizeof( object_t );
 
-            m_renderModels = renderModel;
+        // Copy body's position
+        glm_vec3_copy( body.position, renderModel.pos );
 
-            // Update offset for next iteration
-            uboByteOffset += m_deviceContext.GetAligendUniformByteOffset( sizeof( matOrient ) );
-        }
-
-        m_uniformBuffer.UnmapBuffer( &m_deviceContext );
+        m_renderModels = renderModel;
     }
+
+    m_uniforms.EndFrame( &m_deviceContext );
 }
 
 void
 Application::DrawFrame()
 {
     //	Begin the render frame
-    const uint32_t imageIndex = m_deviceContext.BeginFrame();
+    const uint32_t frameIndex = m_deviceContext.BeginFrame();
+
+    // The GPU is done with this frame slot, its uniforms can be rewritten
+    UpdateUniforms( frameIndex );
     {
         //	Draw the offscreen framebuffer to the swap chain frame buffer
         m_deviceContext.BeginRenderPass();
         {
-            VkCommandBuffer cmdBuffer = m_deviceContext.m_vkCommandBuffers[imageIndex];
+            VkCommandBuffer cmdBuffer = m_deviceContext.m_vkCommandBuffers[frameIndex];
 
             {
-                const int camOffset = 0;
-                const int camSize   = sizeof( float ) * 16 * 4;
-
                 // Binding the pipeline - or "use shader"
                 m_trianglePipeline.BindPipeline( cmdBuffer );
 
                 voDescriptor descriptor = m_trianglePipeline.GetFreeDescriptor();
-                descriptor.BindBuffer( &m_uniformBuffer, camOffset, camSize, 0 );                                       // bind the camera matrices
-                descriptor.BindBuffer( &m_uniformBuffer, m_renderModels.uboByteOffset, m_renderModels.uboByteSize, 1 ); // bind the model matrices
+                descriptor.BindBuffer( m_uniforms.GetBuffer(), m_renderModels.uboByteOffset, m_renderModels.uboByteSize, 0 ); // bind the object matrices
                 descriptor.BindDescriptor( &m_deviceContext, cmdBuffer, &m_trianglePipeline );
                 m_renderModels.model->DrawIndexed( cmdBuffer );
             }
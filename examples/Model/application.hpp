@@ -33,7 +33,7 @@ class Application
     void InitializeImGui();
     void Cleanup();
 
-    void UpdateUniforms();
+    void UpdateUniforms( uint32_t frameIndex );
     void DrawFrame();
 
     void ResizeWindow( int windowWidth, int windowHeight );
@@ -49,7 +49,7 @@ class Application
     voShader        m_triangleShader;
     voPipeline      m_trianglePipeline;
 
-    voBuffer m_uniformBuffer;
+    voUniformAllocator m_uniforms;
 
     // User input
     vec2  m_mousePosition;
@@ -65,6 +65,7 @@ Application::InitializeImGui()
     {
         voDescriptors::CreateParms_t descriptorParms = {
             .numImageSamplers = 1,
+            .maxExternalSets  = 1,
         };
 
         m_imDescriptors.Create( &m_deviceContext, descriptorParms );
@@ -185,8 +186,14 @@ Application::InitializeVulkan()
     //
     //	Uniform Buffer
     //
-    m_uniformBuffer.Allocate( &m_deviceContext, nullptr, sizeof( float ) * 16 * 4 * 128,
-                              VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT );
+    {
+        voUniformAllocator::CreateParms_t parms =
+            {
+                .frameSize = sizeof( float ) * 16 * 4 * 128,
+                .numFrames = m_deviceContext.swapChain.GetFramesInFlight(),
+            };
+        m_uniforms.Create( &m_deviceContext, parms );
+    }
 
     //
     //	Offscreen rendering
@@ -212,8 +219,7 @@ Application::InitializeVulkan()
             }
 
         voDescriptors::CreateParms_t descriptorParms {
-            .numUniformsFragment = 1,
-            .numImageSamplers    = 1,
+            .shader = &m_copyShader,
         };
         m_copyDescriptors.Create( &m_deviceContext, descriptorParms );
 
@@ -265,7 +271,7 @@ Application::Cleanup()
     m_bodies.clear();
 
     // Delete Uniform Buffer Memory
-    m_uniformBuffer.Cleanup( &m_deviceContext );
+    m_uniforms.Cleanup( &m_deviceContext );
 
     // Delete Samplers
     voSamplers::Cleanup( &m_deviceContext );
@@ -280,31 +286,9 @@ Application::Cleanup()
 void
 Application::ResizeWindow( int windowWidth, int windowHeight )
 {
+    // Viewport and scissor are dynamic, pipelines are kept across resizes.
+    // The offscreen buffer follows the swapchain once per frame, see DrawFrame
     m_deviceContext.ResizeWindow( windowWidth, windowHeight );
-
-    Resize( &m_deviceContext, m_deviceContext.swapChain.GetWidth(), m_deviceContext.swapChain.GetHeight() );
-
-    //	Resize full screen texture rendering
-    {
-        m_copyPipeline.Cleanup( &m_deviceContext );
-
-        voPipeline::CreateParms_t pipelineParms = {
-            .renderPass  = m_deviceContext.swapChain.GetRenderPass(),
-            .descriptors = &m_copyDescriptors,
-            .shader      = &m_copyShader,
-            .width       = m_deviceContext.swapChain.GetWidth(),
-            .height      = m_deviceContext.swapChain.GetHeight(),
-            .cullMode    = voPipeline::CULL_MODE_BACK,
-            .depthTest   = false,
-            .depthWrite  = false,
-        };
-        if( !m_copyPipeline.Create( &m_deviceContext, pipelineParms ) )
-            {
-                printf( "Unable to build pipeline!\n" );
-                assert( 0 );
-                return;
-            }
-    }
 }
 
 void
@@ -378,34 +362,29 @@ Application::MainLoop()
 {
     while( !m_window->ShouldClose() )
         {
-            // Update Shader uniforms
-            UpdateUniforms();
-
             // Draw the Scene
             DrawFrame();
         }
 }
 
 void
-Application::UpdateUniforms()
+Application::UpdateUniforms( uint32_t frameIndex )
 {
-    uint32_t uboByteOffset    = 0;
-    uint32_t cameraByteOFfset = 0;
-    uint32_t shadowByteOffset = 0;
-
+    // Matches the camera blocks of checkerboardShadowed.vert and shadow.vert
     struct camera_t
     {
+        using std140_t = std140_block_t< mat4, mat4 >;
+
         mat4 matView;
         mat4 matProj;
-        mat4 pad0;
-        mat4 pad1;
     };
-    camera_t camera {};
 
-    {
-        auto * mappedData = (unsigned char *)m_uniformBuffer.MapBuffer( &m_deviceContext );
+    m_uniforms.BeginFrame( frameIndex );
 
+    {
         {
+            auto camera = m_uniforms.Allocate< camera_t >();
+
             vec3 camPos    = { 10, 0, 5 };
             vec3 camLookAt = { 0, 0, 0 };
             vec3 camUp     = { 0, 0, 1 };
@@ -429,17 +408,16 @@ Application::UpdateUniforms()
             const float fovy   = 45.0f;
             const float aspect = (float)windowWidth / (float)windowHeight; // Fixed aspect ratio
 
-            glm_perspective( glm_rad( fovy ), aspect, zNear, zFar, camera.matProj );
-
-            glm_lookat( camPos, camLookAt, camUp, camera.matView );
+            glm_perspective( glm_rad( fovy ), aspect, zNear, zFar, camera.ptr->matProj );
 
-            memcpy( mappedData + uboByteOffset, &camera, sizeof( camera ) );
+            glm_lookat( camPos, camLookAt, camUp, camera.ptr->matView );
 
-            cameraByteOFfset  = uboByteOffset;
-            uboByteOffset    += m_deviceContext.GetAligendUniformByteOffset( sizeof( camera ) );
+            m_viewUniforms.cameraOffset = camera.offset;
         }
 
         {
+            auto camera = m_uniforms.Allocate< camera_t >();
+
             vec3 camLookAt = { 0, 0, 0 };
             vec3 camUp     = { 0, 0, 1 };
             vec3 tmp;
@@ -459,16 +437,14 @@ Application::UpdateUniforms()
             const float zNear     = 25.0f;
             const float zFar      = 175.0f;
 
-            glm_ortho( xmin, xmax, ymin, ymax, zNear, zFar, camera.matProj );
-            glm_mat4_transpose( camera.matProj );
+            glm_ortho( xmin, xmax, ymin, ymax, zNear, zFar, camera.ptr->matProj );
+            glm_mat4_transpose( camera.ptr->matProj );
 
-            glm_lookat( camPos, camLookAt, camUp, camera.matView );
-            glm_mat4_transpose( camera.matView );
+            glm_lookat( camPos, camLookAt, camUp, camera.ptr->matView );
+            glm_mat4_transpose( camera.ptr->matView );
 
-            memcpy( mappedData + uboByteOffset, &camera, sizeof( camera ) );
-
-            shadowByteOffset  = uboByteOffset;
-            uboByteOffset    += m_deviceContext.GetAligendUniformByteOffset( sizeof( camera ) );
+            m_viewUniforms.shadowOffset = camera.offset;
+            m_viewUniforms.size         = sizeof( camera_t );
         }
 
         m_renderModels.clear();
@@ -476,27 +452,21 @@ Application::UpdateUniforms()
             {
                 Body & body = m_bodies[i];
 
-                // Create the transformation matrix properly
-                mat4 matOrient;
-                glm_mat4_identity( matOrient );
-
-                // Write to the mapped buffer
-                memcpy( mappedData + uboByteOffset, matOrient, sizeof( matOrient ) );
+                // Create the transformation matrix properly, straight into the uniform buffer
+                auto matOrient = m_uniforms.Allocate< mat4 >();
+                glm_mat4_identity( *matOrient.ptr );
 
                 // Create render model
                 voRenderModel renderModel {};
                 renderModel.model         = m_models[i];
-                renderModel.uboByteOffset = uboByteOffset;
-                renderModel.uboByteSize   = sizeof( matOrient );
+                renderModel.uboByteOffset = matOrient.offset;
+                renderModel.uboByteSize   = sizeof( mat4 );
                 glm_vec3_copy( body.m_position, renderModel.pos );
                 m_renderModels.push_back( renderModel );
-
-                // Update offset for next iteration
-                uboByteOffset += m_deviceContext.GetAligendUniformByteOffset( sizeof( matOrient ) );
             }
-
-        m_uniformBuffer.UnmapBuffer( &m_deviceContext );
     }
+
+    m_uniforms.EndFrame( &m_deviceContext );
 }
 
 void
@@ -505,17 +475,31 @@ Application::DrawFrame()
     //
     //	Begin the render frame
     //
-    const uint32_t imageIndex = m_deviceContext.BeginFrame();
+    const uint32_t frameIndex = m_deviceContext.BeginFrame();
+
+    // Bursts of resize events result in a single rebuild of the offscreen buffer
+    {
+        extern voFrameBuffer g_offscreenFrameBuffer;
+
+        const VkExtent2D extent = m_deviceContext.swapChain.GetExtent();
+        if( g_offscreenFrameBuffer.parms.width != extent.width || g_offscreenFrameBuffer.parms.height != extent.height )
+            {
+                Resize( &m_deviceContext, static_cast< int >( extent.width ), static_cast< int >( extent.height ) );
+            }
+    }
+
+    // Update Shader uniforms, the GPU is done with this frame slot
+    UpdateUniforms( frameIndex );
 
     // Draw everything in an offscreen buffer
-    DrawOffscreen( &m_deviceContext, imageIndex, &m_uniformBuffer, m_renderModels.data(), (int)m_renderModels.size() );
+    DrawOffscreen( &m_deviceContext, frameIndex, m_uniforms.GetBuffer(), m_viewUniforms, m_renderModels.data(), (int)m_renderModels.size() );
 
     //
     //	Draw the offscreen framebuffer to the swap chain frame buffer
     //
     m_deviceContext.BeginRenderPass();
     {
-        VkCommandBuffer cmdBuffer = m_deviceContext.m_vkCommandBuffers[imageIndex];
+        VkCommandBuffer cmdBuffer = m_deviceContext.m_vkCommandBuffers[frameIndex];
 
         {
             extern voFrameBuffer g_offscreenFrameBuffer;
@@ -55,7 +55,7 @@ class Application
     void InitializeImGui();
     void Cleanup();
 
-    void UpdateUniforms();
+    void UpdateUniforms( uint32_t frameIndex );
     void DrawFrame();
 
     void ResizeWindow( int windowWidth, int windowHeight );
@@ -68,7 +68,8 @@ class Application
 
     voDeviceContext m_deviceContext;
 
-    voBuffer m_uniformBuffer;
+    voUniformAllocator m_uniforms;
+    view_uniforms_t    m_viewUniforms {};
 
     voModel                  m_modelFullScreen;
     std::vector< voModel * > m_models;
@@ -72,7 +72,9 @@ InitOffscreen( voDeviceContext * device, int width, int height )
 
         voDescriptors::CreateParms_t descriptorParms {};
         memset( &descriptorParms, 0, sizeof( descriptorParms ) );
-        descriptorParms.numUniformsVertex = 2;
+        descriptorParms.shader          = &g_shadowShader;
+        descriptorParms.dynamicUniforms = 1 << 1; // model matrices, moved on every draw
+        descriptorParms.transient       = true;   // pushed into the command buffer when the device supports it
         g_shadowDescriptors.Create( device, descriptorParms );
 
         voPipeline::CreateParms_t pipelineParms =
@@ -108,9 +110,8 @@ InitOffscreen( voDeviceContext * device, int width, int height )
 
         voDescriptors::CreateParms_t descriptorParms {};
         memset( &descriptorParms, 0, sizeof( descriptorParms ) );
-        descriptorParms.numUniformsVertex   = 3;
-        descriptorParms.numUniformsFragment = 1;
-        descriptorParms.numImageSamplers    = 1;
+        descriptorParms.shader          = &g_checkerboardShadowShader;
+        descriptorParms.dynamicUniforms = 1 << 1; // model matrices, moved on every draw
         g_checkerboardShadowDescriptors.Create( device, descriptorParms );
 
         voPipeline::CreateParms_t pipelineParms;
@@ -151,15 +152,15 @@ CleanupOffscreen( voDeviceContext * device )
 }
 
 void
-DrawOffscreen( voDeviceContext * device, int cmdBufferIndex, voBuffer * uniforms, const voRenderModel * renderModels, const int numModels )
+DrawOffscreen( voDeviceContext * device, int cmdBufferIndex, voBuffer * uniforms, const view_uniforms_t & views, const voRenderModel * renderModels, const int numModels )
 {
     VkCommandBuffer cmdBuffer = device->m_vkCommandBuffers[cmdBufferIndex];
 
-    const int camOffset = 0;
-    const int camSize   = sizeof( float ) * 16 * 4;
+    const uint32_t camOffset = views.cameraOffset;
+    const uint32_t camSize   = views.size;
 
-    const int shadowCamOffset = device->GetAligendUniformByteOffset( camOffset + camSize );
-    const int shadowCamSize   = camSize;
+    const uint32_t shadowCamOffset = views.shadowOffset;
+    const uint32_t shadowCamSize   = views.size;
 
     //
     //	Update the Shadows
@@ -171,13 +172,14 @@ DrawOffscreen( voDeviceContext * device, int cmdBufferIndex, voBuffer * uniforms
 
         // Binding the pipeline is effectively the "use shader" we had back in our opengl apps
         g_shadowPipeline.BindPipeline( cmdBuffer );
+
+        // Descriptor is how we bind our buffers and images, the models only move its dynamic offset
+        voDescriptor descriptor = g_shadowPipeline.GetFreeDescriptor();
+        descriptor.BindBuffer( uniforms, shadowCamOffset, shadowCamSize, 0 ); // bind the camera matrices
         for( int i = 0; i < numModels; i++ )
             {
                 const voRenderModel & renderModel = renderModels[i];
 
-                // Descriptor is how we bind our buffers and images
-                voDescriptor descriptor = g_shadowPipeline.GetFreeDescriptor();
-                descriptor.BindBuffer( uniforms, shadowCamOffset, shadowCamSize, 0 );                     // bind the camera matrices
                 descriptor.BindBuffer( uniforms, renderModel.uboByteOffset, renderModel.uboByteSize, 1 ); // bind the model matrices
                 descriptor.BindDescriptor( device, cmdBuffer, &g_shadowPipeline );
                 renderModel.model->DrawIndexed( cmdBuffer );
@@ -201,16 +203,17 @@ DrawOffscreen( voDeviceContext * device, int cmdBufferIndex, voBuffer * uniforms
         {
             // Binding the pipeline is effectively the "use shader" we had back in our opengl apps
             g_checkerboardShadowPipeline.BindPipeline( cmdBuffer );
+
+            // Descriptor is how we bind our buffers and images, the models only move its dynamic offset
+            voDescriptor descriptor = g_checkerboardShadowPipeline.GetFreeDescriptor();
+            descriptor.BindBuffer( uniforms, camOffset, camSize, 0 );             // bind the camera matrices
+            descriptor.BindBuffer( uniforms, shadowCamOffset, shadowCamSize, 2 ); // bind the shadow camera matrices
+            descriptor.BindImage( VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL, g_shadowFrameBuffer.imageDepth.vkImageView, voSamplers::m_samplerStandard, 0 );
             for( int i = 0; i < numModels; i++ )
                 {
                     const voRenderModel & renderModel = renderModels[i];
 
-                    // Descriptor is how we bind our buffers and images
-                    voDescriptor descriptor = g_checkerboardShadowPipeline.GetFreeDescriptor();
-                    descriptor.BindBuffer( uniforms, camOffset, camSize, 0 );                                 // bind the camera matrices
                     descriptor.BindBuffer( uniforms, renderModel.uboByteOffset, renderModel.uboByteSize, 1 ); // bind the model matrices
-                    descriptor.BindBuffer( uniforms, shadowCamOffset, shadowCamSize, 2 );                     // bind the shadow camera matrices
-                    descriptor.BindImage( VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL, g_shadowFrameBuffer.imageDepth.vkImageView, voSamplers::m_samplerStandard, 0 );
                     descriptor.BindDescriptor( device, cmdBuffer, &g_checkerboardShadowPipeline );
                     renderModel.model->DrawIndexed( cmdBuffer );
                 }
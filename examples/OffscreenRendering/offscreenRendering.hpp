@@ -1,15 +1,24 @@
 #ifndef VULKANO_OFFSCREENRENDERING_H
 #define VULKANO_OFFSCREENRENDERING_H
 
+#include <cstdint>
+
 class voDeviceContext;
 class voBuffer;
 struct voRenderModel;
 
+/** @brief Where the view dependent uniforms of the frame live in the uniform buffer */
+struct view_uniforms_t
+{
+    uint32_t cameraOffset;
+    uint32_t shadowOffset;
+    uint32_t size;
+};
 
 bool InitOffscreen( voDeviceContext * device, int width, int height );
 bool CleanupOffscreen( voDeviceContext * device );
 
-void DrawOffscreen( voDeviceContext * device, int cmdBufferIndex, voBuffer * uniforms, const voRenderModel * renderModels, const int numModels );
+void DrawOffscreen( voDeviceContext * device, int cmdBufferIndex, voBuffer * uniforms, const view_uniforms_t & views, const voRenderModel * renderModels, const int numModels );
 
 void Resize( voDeviceContext * device, int width, int height );
 
@@ -132,28 +132,8 @@ Application::Cleanup()
 void
 Application::ResizeWindow( int windowWidth, int windowHeight )
 {
+    // Viewport and scissor are dynamic, pipelines are kept across resizes
     m_deviceContext.ResizeWindow( windowWidth, windowHeight );
-
-    //	Resize full screen texture rendering
-    {
-        m_trianglePipeline.Cleanup( &m_deviceContext );
-
-        voPipeline::CreateParms_t pipelineParms = {
-            .renderPass = m_deviceContext.swapChain.GetRenderPass(),
-            .shader     = &m_triangleShader,
-            .width      = m_deviceContext.swapChain.GetWidth(),
-            .height     = m_deviceContext.swapChain.GetHeight(),
-            .cullMode   = voPipeline::CULL_MODE_BACK,
-            .depthTest  = false,
-            .depthWrite = false,
-        };
-        if( !m_trianglePipeline.Create( &m_deviceContext, pipelineParms ) )
-            {
-                printf( "Unable to build pipeline!\n" );
-                assert( 0 );
-                return;
-            }
-    }
 }
 
 void
@@ -170,12 +150,12 @@ void
 Application::DrawFrame()
 {
     //	Begin the render frame
-    const uint32_t imageIndex = m_deviceContext.BeginFrame();
+    const uint32_t frameIndex = m_deviceContext.BeginFrame();
     {
         //	Draw the offscreen framebuffer to the swap chain frame buffer
         m_deviceContext.BeginRenderPass();
         {
-            VkCommandBuffer cmdBuffer = m_deviceContext.m_vkCommandBuffers[imageIndex];
+            VkCommandBuffer cmdBuffer = m_deviceContext.m_vkCommandBuffers[frameIndex];
 
             {
                 // Binding the pipeline - or "use shader"
@@ -0,0 +1,168 @@
+#ifndef VULKANO_BINDLESS_H
+#define VULKANO_BINDLESS_H
+
+#include <mutex>
+#include <vector>
+#include "vo_api.hpp"
+#include "vo_common.hpp"
+
+class voDeviceContext;
+class voBuffer;
+class voPipeline;
+
+/**
+ * @class voBindless
+ * @brief One global descriptor set holding every texture, sampler and storage buffer, referenced by index.
+ *
+ * @details Opt-in bindless mode, on devices supporting descriptor indexing (`device_features_t::descriptorIndexing`).
+ * The set holds three large, partially bound arrays: sampled images at binding 0, samplers at binding 1 and storage buffers
+ * at binding 2. Resources are added once and referenced by a 32-bit index, passed to the shaders through push constants
+ * or instance data, so draws with different materials are batched without rebinding descriptors.
+ *
+ * The set is created update-after-bind: adding a resource writes its slot while command buffers using the set are pending.
+ * Removed slots are only handed out again once the frame being recorded has been executed.
+ * Pipelines created with `voPipeline::CreateParms_t::bindless` have the set at `SET_INDEX`, after their own descriptors.
+ *
+ * @code
+ * // GLSL
+ * layout( set = 1, binding = 0 ) uniform texture2D textures[];
+ * layout( set = 1, binding = 1 ) uniform sampler   samplers[];
+ * layout( push_constant ) uniform material_t { uint albedo; uint sampler; } material;
+ * ...
+ * vec4 albedo = texture( sampler2D( textures[nonuniformEXT( material.albedo )], samplers[material.sampler] ), uv );
+ *
+ * // C++
+ * bindless.Create( device, {} );
+ * const uint32_t albedo  = bindless.AddImage( device, texture.vkImageView );
+ * const uint32_t sampler = bindless.AddSampler( device, voSamplers::m_samplerStandard );
+ *
+ * pipeline.BindPipeline( cmdBuffer );
+ * bindless.BindDescriptor( cmdBuffer, &pipeline );
+ * const uint32_t material[2] = { albedo, sampler };
+ * vkCmdPushConstants( cmdBuffer, pipeline.vkPipelineLayout, VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof( material ), material );
+ * model.DrawIndexed( cmdBuffer );
+ * @endcode
+ *
+ * @see `voDescriptors`, `voPipeline`
+ */
+class VO_API voBindless
+{
+  public:
+    voBindless()  = default;
+    ~voBindless() = default;
+
+    voBindless( const voBindless & )             = delete;
+    voBindless & operator=( const voBindless & ) = delete;
+
+    static const uint32_t SET_INDEX     = 1;          ///< Set of the pipeline layout the global set is bound to
+    static const uint32_t INVALID_INDEX = UINT32_MAX; ///< Returned once an array is full
+
+    /**
+     * @enum resource_t
+     * @brief The arrays of the set, by binding.
+     */
+    enum resource_t
+    {
+        RESOURCE_IMAGE,
+        RESOURCE_SAMPLER,
+        RESOURCE_STORAGE_BUFFER,
+        RESOURCE_COUNT,
+    };
+
+    /**
+     * @struct CreateParms_t
+     * @brief Sizes of the arrays of the global set.
+     */
+    struct CreateParms_t
+    {
+        uint32_t maxImages { 4096 };
+        uint32_t maxSamplers { 64 };
+        uint32_t maxStorageBuffers { 4096 };
+    };
+
+    /**
+     * @brief Creates the global set, and its layout.
+     * @param device The device context, with descriptor indexing enabled.
+     * @param parms The parameters for creating the global set.
+     * @return True if creation is successful, false if the device does not support descriptor indexing.
+     */
+    bool Create( voDeviceContext * device, const CreateParms_t & parms );
+
+    /**
+     * @brief Destroys the global set, its layout and pool.
+     * @param device The device context.
+     */
+    void Cleanup( voDeviceContext * device );
+
+    /* -------------------------------------- Resources ---------------------------------------------------------------- */
+
+    /**
+     * @brief Adds a sampled image to the set.
+     * @param device The device context.
+     * @param imageView The view of the image.
+     * @param imageLayout The layout the image is in when sampled.
+     * @return The index of the image, or INVALID_INDEX if the array is full.
+     */
+    uint32_t AddImage( voDeviceContext * device, VkImageView imageView, VkImageLayout imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL );
+
+    /**
+     * @brief Adds a sampler to the set.
+     * @param device The device context.
+     * @param sampler The sampler.
+     * @return The index of the sampler, or INVALID_INDEX if the array is full.
+     */
+    uint32_t AddSampler( voDeviceContext * device, VkSampler sampler );
+
+    /**
+     * @brief Adds a storage buffer to the set.
+     * @param device The device context.
+     * @param storageBuffer The buffer, created with `VK_BUFFER_USAGE_STORAGE_BUFFER_BIT`.
+     * @param offset The offset in the buffer to start binding from.
+     * @param size The size of the range to bind.
+     * @return The index of the buffer, or INVALID_INDEX if the array is full.
+     */
+    uint32_t AddStorageBuffer( voDeviceContext * device, voBuffer * storageBuffer, VkDeviceSize offset = 0, VkDeviceSize size = VK_WHOLE_SIZE );
+
+    /**
+     * @brief Removes a resource, its index is reused once the frame being recorded has been executed.
+     * @param device The device context.
+     * @param resource The array the resource was added to.
+     * @param index The index returned when adding the resource.
+     */
+    void Remove( voDeviceContext * device, resource_t resource, uint32_t index );
+
+    /* -------------------------------------- Binding ------------------------------------------------------------------ */
+
+    /**
+     * @brief Binds the global set at `SET_INDEX`, at the bind point of the pipeline.
+     * @param vkCommandBuffer The command buffer to bind the set to.
+     * @param pso A pipeline created with the bindless set.
+     */
+    void BindDescriptor( VkCommandBuffer vkCommandBuffer, voPipeline * pso ) const;
+
+    /* -------------------------------------- Handlers ----------------------------------------------------------------- */
+
+    VkDescriptorPool      vkDescriptorPool { VK_NULL_HANDLE };
+    VkDescriptorSetLayout vkDescriptorSetLayout { VK_NULL_HANDLE };
+    VkDescriptorSetLayout vkEmptySetLayout { VK_NULL_HANDLE }; ///< Fills the sets below `SET_INDEX` of pipelines without descriptors, owned by `voLayoutCache`
+    VkDescriptorSet       vkDescriptorSet { VK_NULL_HANDLE };
+
+  private:
+    /**
+     * @struct slots_t
+     * @brief The indices of an array, handed out and recycled.
+     */
+    struct slots_t
+    {
+        uint32_t                capacity { 0 };
+        uint32_t                numUsed { 0 }; ///< Indices never handed out start here
+        std::vector< uint32_t > freeList {};   ///< Removed indices, once the GPU is done with them
+    };
+
+    uint32_t AllocateSlot( resource_t resource );
+
+    slots_t    m_slots[RESOURCE_COUNT] {};
+    std::mutex m_mutex;
+};
+
+#endif //VULKANO_BINDLESS_H
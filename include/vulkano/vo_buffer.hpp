@@ -1,13 +1,50 @@
 #ifndef VULKANO_BUFFER_H
 #define VULKANO_BUFFER_H
 
+#include <algorithm>
 #include "vo_api.hpp"
 #include "vo_common.hpp"
+#include "vo_descriptor.hpp"
 #include "vo_deviceContext.hpp"
+#include "vo_memory.hpp"
 
 /**
  * @class voBuffer
  * @brief Encapsulates a general purpose Vulkan buffer.
+ *
+ * @details The memory backing the buffer is sub-allocated from the device context allocator (`voMemory`),
+ * in the pool of the requested usage class.
+ * Device local buffers live in `DEVICE_LOCAL` memory. When that memory is also host visible (ReBAR, UMA) their initial
+ * contents are written directly, otherwise data goes through the staging ring of the device context (`voUploadContext`).
+ * Later updates of device local buffers are always staged, ordered after the frames in flight reading them.
+ * Persistent buffers stay mapped for their whole life and expose a stable CPU pointer. They accept non-coherent
+ * (and cached) memory types, in which case the written byte ranges are marked dirty and flushed explicitly.
+ *
+ * @code
+ * voBuffer::CreateParms_t parms =
+ * {
+ *     .size        = sizeof( vert_t ) * vertices.size(),
+ *     .usageFlags  = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+ *     .memoryClass = voMemory::MEMORY_CLASS_GEOMETRY,
+ *     .deviceLocal = true,
+ * };
+ * buffer.Create( device, parms, vertices.data() );
+ *
+ * // Re-upload part of the buffer
+ * buffer.Update( device, offset, vertices.data() + first, sizeof( vert_t ) * count );
+ *
+ * // Persistently mapped uniforms, written every frame without mapping
+ * auto * ptr = (uint8_t *)uniforms.GetMappedPtr();
+ * memcpy( ptr + offset, &camera, sizeof( camera ) );
+ * uniforms.MarkDirty( offset, sizeof( camera ) );
+ * uniforms.FlushDirty( device );
+ *
+ * // ...
+ *
+ * buffer.Cleanup( device );
+ * @endcode
+ *
+ * @see `voMemory`, `voUploadContext`, `voDeviceContext`
  */
 class VO_API voBuffer
 {
@@ -15,8 +52,33 @@ public:
     voBuffer() = default;
     ~voBuffer() = default;
 
+    /**
+     * @struct CreateParms_t
+     * @brief Parameters for creating a buffer.
+     */
+    struct CreateParms_t
+    {
+        VkDeviceSize            size;                                        ///< Size of the buffer in bytes
+        VkBufferUsageFlags      usageFlags;                                  ///< Usage flags for the buffer
+        voMemory::MemoryClass_t memoryClass { voMemory::MEMORY_CLASS_DEFAULT }; ///< Pool the memory comes from
+        uint8_t                 dedicated : 1 { false };                      ///< Use a dedicated allocation
+        uint8_t                 deviceLocal : 1 { false };                    ///< Place the buffer in device local memory
+        uint8_t                 persistent : 1 { false };                     ///< Keep the buffer mapped for its whole life
+        uint8_t                 cached : 1 { false };                         ///< Prefer host cached memory (persistent only)
+        uint8_t                 concurrent : 1 { false };                     ///< Shared between the graphics and compute queues without ownership transfers
+    };
+
     /* -------------------------------------- Base --------------------------------------------------------------------- */
 
+    /**
+     * @brief Creates the buffer and allocates its memory.
+     * @param device The device context.
+     * @param parms The parameters for creating the buffer.
+     * @param data Optional pointer to the initial contents (parms.size bytes).
+     * @return True if creation is successful, false otherwise.
+     */
+    bool Create( voDeviceContext * device, const CreateParms_t & parms, const void * data = nullptr );
+
     /**
      * @brief Allocates memory for the buffer.
      * @param device The device context.
@@ -24,8 +86,26 @@ public:
      * @param size Size of the data.
      * @param usageFlags Usage flags for the buffer.
      * @return True if allocation is successful, false otherwise.
+     *
+     * @details Vertex and index buffers are placed in device local memory from the geometry pool,
+     * everything else in host visible memory from the default pool.
+     */
+    bool Allocate( voDeviceContext * device, const void * data, VkDeviceSize size, VkBufferUsageFlags usageFlags );
+
+    /**
+     * @brief Updates a sub-range of the buffer.
+     * @param device The device context.
+     * @param offset Offset in bytes from the start of the buffer.
+     * @param data Pointer to the new contents.
+     * @param size Size of the range in bytes.
+     *
+     * @details Buffers created with `VK_BUFFER_USAGE_TRANSFER_DST_BIT`, device local ones included, are staged through
+     * `voUploadContext`, the copy waits for the frames in flight reading the range. Inside an upload batch the copy is only
+     * guaranteed to have landed once the batch ends.
+     * Other buffers are host visible and written in place, through the mapped pointer of persistent ones: the range must not
+     * be read by a frame in flight, like the region of the frame being recorded.
      */
-    bool Allocate( voDeviceContext * device, const void * data, int size, VkBufferUsageFlagBits usageFlags );
+    void Update( voDeviceContext * device, VkDeviceSize offset, const void * data, VkDeviceSize size );
 
     /** @brief Cleanup the wrapped buffer. */
     void Cleanup( voDeviceContext * device ) const;
@@ -42,6 +122,7 @@ public:
      * This pathway, or 'mapping', is necessary when the CPU requires direct access to the data contained within the buffer.
      * It's important to note that not all memory can be mapped for CPU access. The memory type must have the VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT property.
      * After calling this function, the returned pointer can be used to load data into the buffer.
+     * Persistent buffers simply return their mapped pointer.
      */
     void * MapBuffer( voDeviceContext * device ) const;
 
@@ -53,15 +134,47 @@ public:
      * Once we're done with reading from or writing to the mapped memory, we should unmap it.
      * Ensure the termination of this connection to prevent potential memory leaks and undefined behavior.
      * It is also necessary to ensure that all operations involving the mapped memory have completed before this call.
+     * Persistent buffers are never unmapped before `Cleanup`.
      */
     void UnmapBuffer( voDeviceContext * device ) const;
 
+    /** @brief Check if the memory of the buffer can be mapped */
+    [[nodiscard]] bool IsHostVisible() const;
+
+    /** @brief Check if host writes are visible to the device without flushing */
+    [[nodiscard]] bool IsHostCoherent() const;
+
+    /* -------------------------------------- Persistent Mapping ------------------------------------------------------- */
+
+    /** @brief Get the CPU pointer of a persistent buffer, stable for the lifetime of the buffer */
+    [[nodiscard]] void * GetMappedPtr() const;
+
+    /**
+     * @brief Marks a byte range written through the mapped pointer.
+     * @param offset Offset in bytes from the start of the buffer.
+     * @param size Size of the range in bytes.
+     *
+     * @details Ranges are merged, only the union of the dirty ranges is flushed. No-op on coherent memory.
+     */
+    void MarkDirty( VkDeviceSize offset, VkDeviceSize size );
+
+    /**
+     * @brief Flushes the dirty range to the device, required on non-coherent memory before the GPU reads it.
+     * @param device The device context.
+     */
+    void FlushDirty( voDeviceContext * device );
+
     /* -------------------------------------- Handlers ----------------------------------------------------------------- */
 
     VkBuffer              vkBuffer              { VK_NULL_HANDLE }; ///< Buffer handle.
-    VkDeviceMemory        vkBufferMemory        { VK_NULL_HANDLE }; ///< Device memory handle.
+    VmaAllocation         vmaAllocation         { VK_NULL_HANDLE }; ///< Sub-allocation backing the buffer.
     VkDeviceSize          vkBufferSize          { 0 };
-    VkMemoryPropertyFlags vkMemoryPropertyFlags { 0 };
+    VkMemoryPropertyFlags vkMemoryPropertyFlags { 0 };              ///< Properties of the memory type picked by the allocator.
+    VkBufferUsageFlags    vkUsageFlags          { 0 };              ///< Usage the buffer was created with.
+
+    void *                mappedData            { nullptr };        ///< Persistent CPU pointer, null when not persistent.
+    VkDeviceSize          dirtyBegin            { VK_WHOLE_SIZE };  ///< Start of the dirty range.
+    VkDeviceSize          dirtyEnd              { 0 };              ///< End of the dirty range.
 };
 
 
@@ -72,23 +185,63 @@ public:
 FORCE_INLINE void
 voBuffer::Cleanup(voDeviceContext * device ) const
 {
-    vkDestroyBuffer( device->deviceInfo.logical, vkBuffer, nullptr );
-    vkFreeMemory( device->deviceInfo.logical, vkBufferMemory, nullptr );
+    voDescriptors::Forget( device, reinterpret_cast< uint64_t >( vkBuffer ) );
+    device->m_memory->DestroyBuffer( vkBuffer, vmaAllocation );
 }
 
 FORCE_INLINE void *
 voBuffer::MapBuffer(voDeviceContext * device ) const
 {
-    void * mapped_ptr   = nullptr;
-    uint32_t byteOffset = 0;
-    vkMapMemory( device->deviceInfo.logical, vkBufferMemory, byteOffset, vkBufferSize, 0, &mapped_ptr );
+    if ( mappedData != nullptr )
+    {
+        return mappedData;
+    }
+
+    void * mapped_ptr = nullptr;
+    device->m_memory->MapMemory( vmaAllocation, &mapped_ptr );
     return mapped_ptr;
 }
 
 FORCE_INLINE void
 voBuffer::UnmapBuffer(voDeviceContext * device ) const
 {
-    vkUnmapMemory( device->deviceInfo.logical, vkBufferMemory );
+    if ( mappedData != nullptr )
+    {
+        return;
+    }
+
+    device->m_memory->UnmapMemory( vmaAllocation );
+}
+
+FORCE_INLINE bool
+voBuffer::IsHostVisible() const
+{
+    return ( vkMemoryPropertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT ) != 0;
+}
+
+FORCE_INLINE bool
+voBuffer::IsHostCoherent() const
+{
+    return ( vkMemoryPropertyFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT ) != 0;
+}
+
+FORCE_INLINE void *
+voBuffer::GetMappedPtr() const
+{
+    voAssert( mappedData != nullptr );
+    return mappedData;
+}
+
+FORCE_INLINE void
+voBuffer::MarkDirty( VkDeviceSize offset, VkDeviceSize size )
+{
+    if ( IsHostCoherent() )
+    {
+        return;
+    }
+
+    dirtyBegin = std::min( dirtyBegin, offset );
+    dirtyEnd   = std::max( dirtyEnd, offset + size );
 }
 
 #endif //VULKANO_BUFFER_H
@@ -0,0 +1,168 @@
+#ifndef VULKANO_COMMANDALLOCATOR_H
+#define VULKANO_COMMANDALLOCATOR_H
+
+#include <vector>
+#include "vo_api.hpp"
+#include "vo_common.hpp"
+
+class voDeviceContext;
+
+/**
+ * @class voCommandAllocator
+ * @brief Per-thread, per-frame command pools, to record command buffers from several threads.
+ *
+ * @details A `VkCommandPool` must not be used by two threads at once, so every recording thread owns a pool
+ * for each frame slot. Threads are identified by an index in [0, GetNumThreads()), 0 being the main thread,
+ * and only ever touch their own pools: allocating needs no lock.
+ * The command buffers of a pool are reused from one frame to the next, the whole pool is reset by `BeginFrame`
+ * once the GPU has retired the frame slot.
+ *
+ * Draws of a render pass are split in chunks recorded into secondary command buffers by worker threads.
+ * The secondary command buffers are then executed by the frame command buffer, in the order of the chunks
+ * and whatever the order the threads completed in. The render pass has to be begun with
+ * `VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS`, it then only contains the executed command buffers.
+ *
+ * @code
+ * const voCommandAllocator::inheritance_t inheritance = device->swapChain.GetInheritance();
+ * std::vector< VkCommandBuffer >           chunks( numThreads );
+ *
+ * // On each worker thread
+ * VkCommandBuffer cmdBuffer = device->m_commandAllocator.BeginSecondary( device, threadIndex, inheritance );
+ * pipeline.BindPipeline( cmdBuffer );
+ * for( int i = first; i < last; i++ )
+ *     {
+ *         models[i].DrawIndexed( cmdBuffer );
+ *     }
+ * voCommandAllocator::EndSecondary( cmdBuffer );
+ * chunks[threadIndex] = cmdBuffer;
+ *
+ * // On the main thread, once every worker is done
+ * device->swapChain.BeginRenderPass( device, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS );
+ * voCommandAllocator::Execute( device->m_vkCommandBuffers[frameIndex], chunks.size(), chunks.data() );
+ * device->swapChain.EndRenderPass( device );
+ * @endcode
+ *
+ * @see `voDeviceContext`, `voSwapChain`, `voFrameBuffer`
+ */
+class VO_API voCommandAllocator
+{
+  public:
+    voCommandAllocator()  = default;
+    ~voCommandAllocator() = default;
+
+    /**
+     * @struct CreateParms_t
+     * @brief Parameters for creating the command allocator.
+     */
+    struct CreateParms_t
+    {
+        uint32_t numThreads;  ///< Number of recording threads, the main thread included
+        uint32_t numFrames;   ///< Number of frame slots
+        uint32_t queueFamily; ///< Family of the queue the command buffers are submitted to
+    };
+
+    /**
+     * @struct inheritance_t
+     * @brief The render pass a secondary command buffer is recorded for, and the dynamic state it has to set.
+     *
+     * @details Secondary command buffers do not inherit the viewport, scissor and depth bias of the primary.
+     */
+    struct inheritance_t
+    {
+        VkRenderPass  renderPass { VK_NULL_HANDLE };
+        uint32_t      subpass { 0 };
+        VkFramebuffer framebuffer { VK_NULL_HANDLE }; ///< Optional, helps some drivers
+        VkExtent2D    extent { 0, 0 };                ///< Viewport and scissor
+        float         depthBiasConstant { 0.0F };     ///< Set along with the slope when any is not zero
+        float         depthBiasSlope { 0.0F };
+    };
+
+    /**
+     * @brief Creates a command pool per thread and per frame slot.
+     * @param device The device context.
+     * @param parms The parameters for creating the allocator.
+     * @return True if creation is successful, false otherwise.
+     */
+    bool Create( voDeviceContext * device, const CreateParms_t & parms );
+
+    /**
+     * @brief Destroys every pool along with its command buffers, the GPU must be done with them.
+     * @param device The device context.
+     */
+    void Cleanup( voDeviceContext * device );
+
+    /**
+     * @brief Resets the pools of a frame slot, its command buffers are recycled.
+     *
+     * @details Called by the device context once the GPU has retired the slot, before any thread records for it.
+     *
+     * @param device The device context.
+     * @param frameIndex The frame slot being recorded.
+     */
+    void BeginFrame( voDeviceContext * device, uint32_t frameIndex );
+
+    /* -------------------------------------- Recording ---------------------------------------------------------------- */
+
+    /**
+     * @brief Gets a command buffer from the pool of a thread for the current frame slot, without beginning it.
+     * @param device The device context.
+     * @param threadIndex The index of the calling thread.
+     * @param level Primary or secondary.
+     * @return A command buffer valid until the frame slot is reused.
+     */
+    VkCommandBuffer Allocate( voDeviceContext * device, uint32_t threadIndex, VkCommandBufferLevel level );
+
+    /**
+     * @brief Begins a secondary command buffer continuing a render pass, and sets its dynamic state.
+     * @param device The device context.
+     * @param threadIndex The index of the calling thread.
+     * @param inheritance The render pass the commands are executed in.
+     * @return The command buffer to record the draws into.
+     */
+    VkCommandBuffer BeginSecondary( voDeviceContext * device, uint32_t threadIndex, const inheritance_t & inheritance );
+
+    /**
+     * @brief Ends a secondary command buffer.
+     * @param cmdBuffer A command buffer returned by `BeginSecondary`.
+     */
+    static void EndSecondary( VkCommandBuffer cmdBuffer );
+
+    /**
+     * @brief Executes secondary command buffers in order, null entries (empty chunks) are skipped.
+     * @param primary The command buffer of the frame, inside a render pass begun with secondary contents.
+     * @param numCmdBuffers Number of secondary command buffers.
+     * @param cmdBuffers The secondary command buffers, in the order of their chunks.
+     */
+    static void Execute( VkCommandBuffer primary, size_t numCmdBuffers, const VkCommandBuffer * cmdBuffers );
+
+    /** @brief Get the number of recording threads */
+    [[nodiscard]] uint32_t GetNumThreads() const;
+
+  private:
+    /**
+     * @struct pool_t
+     * @brief The pool of a thread for a frame slot, and the command buffers allocated from it.
+     */
+    struct pool_t
+    {
+        VkCommandPool                  vkCommandPool { VK_NULL_HANDLE };
+        std::vector< VkCommandBuffer > cmdBuffers[2] {}; ///< Primary and secondary command buffers
+        uint32_t                       numUsed[2] { 0, 0 };
+    };
+
+    std::vector< pool_t > m_pools {}; ///< Indexed by frame slot, then by thread
+    uint32_t              m_numThreads { 0 };
+    uint32_t              m_frameIndex { 0 };
+};
+
+// ======================================================================================================================
+// ============================================ Inline ==================================================================
+// ======================================================================================================================
+
+FORCE_INLINE uint32_t
+voCommandAllocator::GetNumThreads() const
+{
+    return m_numThreads;
+}
+
+#endif //VULKANO_COMMANDALLOCATOR_H
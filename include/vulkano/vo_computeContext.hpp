@@ -0,0 +1,147 @@
+#ifndef VULKANO_COMPUTECONTEXT_H
+#define VULKANO_COMPUTECONTEXT_H
+
+#include <vector>
+#include "vo_api.hpp"
+#include "vo_common.hpp"
+#include "vo_queue.hpp"
+
+class voDeviceContext;
+
+/**
+ * @class voComputeContext
+ * @brief Records compute passes and submits them to the compute queue of the device.
+ *
+ * @details Compute passes run on the async compute queue when the device exposes a compute family without graphics,
+ * and on the graphics queue otherwise. In both cases `Submit` returns a point of the queue timeline, which the frame
+ * (or any other submission) waits on through `voDeviceContext::AddFrameWait`. The handoff is a semaphore wait on the GPU,
+ * so culling, skinning or post-processing overlap the graphics work recorded before the stages that consume them.
+ *
+ * The command buffers are used as a ring, a command buffer is recycled once its last submission has been retired.
+ * Buffers and images shared with the graphics queue should be created with the `concurrent` flag,
+ * so no ownership transfer is needed between the two families.
+ *
+ * @code
+ * VkCommandBuffer cmdBuffer = device->m_computeContext.Begin( device );
+ *
+ * cullPipeline.BindPipelineCompute( cmdBuffer );
+ * descriptor.BindDescriptor( device, cmdBuffer, &cullPipeline );
+ * voPipeline::DispatchCompute( cmdBuffer, ( numObjects + 63 ) / 64, 1, 1 );
+ *
+ * const uint64_t value = device->m_computeContext.Submit( device );
+ *
+ * // The draw calls reading the culled indirect buffer wait for the pass on the GPU
+ * device->AddFrameWait( device->m_computeContext.GetWait( value, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT ) );
+ * @endcode
+ *
+ * @see `voDeviceContext`, `voQueue`, `voPipeline`
+ */
+class VO_API voComputeContext
+{
+  public:
+    voComputeContext()  = default;
+    ~voComputeContext() = default;
+
+    /**
+     * @struct CreateParms_t
+     * @brief Parameters for creating the compute context.
+     */
+    struct CreateParms_t
+    {
+        uint32_t numCommandBuffers; ///< Size of the command buffer ring
+    };
+
+    /**
+     * @brief Creates the command pool and the command buffer ring on the compute family.
+     * @param device The device context.
+     * @param parms The parameters for creating the compute context.
+     * @return True if creation is successful, false otherwise.
+     */
+    bool Create( voDeviceContext * device, const CreateParms_t & parms );
+
+    /**
+     * @brief Waits for every compute pass and releases every resource of the context.
+     * @param device The device context.
+     */
+    void Cleanup( voDeviceContext * device );
+
+    /* -------------------------------------- Passes ------------------------------------------------------------------- */
+
+    /**
+     * @brief Begins recording a compute pass.
+     *
+     * @details Only blocks when the next command buffer of the ring is still executing.
+     *
+     * @param device The device context.
+     * @return The command buffer to record the pass into.
+     */
+    VkCommandBuffer Begin( voDeviceContext * device );
+
+    /**
+     * @brief Ends and submits the pass being recorded.
+     *
+     * @param device The device context.
+     * @param numWaits Number of timeline points the pass waits for, e.g. the frame producing its inputs.
+     * @param waits The timeline points.
+     * @return The compute queue timeline value signaled once the pass completes.
+     */
+    uint64_t Submit( voDeviceContext * device, uint32_t numWaits = 0, const voQueue::wait_t * waits = nullptr );
+
+    /**
+     * @brief Builds the wait another submission uses to consume the results of a pass.
+     * @param value A value returned by `Submit`.
+     * @param stages The stages of the consuming submission that read the results.
+     */
+    [[nodiscard]] voQueue::wait_t GetWait( uint64_t value, VkPipelineStageFlags stages ) const;
+
+    /** @brief Check if passes run on their own queue, in parallel with the graphics queue */
+    [[nodiscard]] bool IsAsync() const;
+
+    /** @brief Get the queue the passes are submitted to */
+    [[nodiscard]] voQueue * GetQueue() const;
+
+  private:
+    /**
+     * @struct pass_t
+     * @brief A command buffer of the ring and the timeline value of its last submission.
+     */
+    struct pass_t
+    {
+        VkCommandBuffer cmdBuffer { VK_NULL_HANDLE };
+        uint64_t        value { 0 };
+    };
+
+    /* -------------------------------------- Handlers ----------------------------------------------------------------- */
+
+    voQueue *     m_queue { nullptr };
+    VkCommandPool m_vkCommandPool { VK_NULL_HANDLE };
+
+    std::vector< pass_t > m_passes {};
+    uint32_t              m_current { 0 };    ///< Pass being recorded, or next to be recorded
+    uint8_t               m_isAsync : 1 { false };
+    uint8_t               m_isRecording : 1 { false };
+};
+
+// ======================================================================================================================
+// ============================================ Inline ==================================================================
+// ======================================================================================================================
+
+FORCE_INLINE voQueue::wait_t
+voComputeContext::GetWait( uint64_t value, VkPipelineStageFlags stages ) const
+{
+    return { .queue = m_queue, .value = value, .stages = stages };
+}
+
+FORCE_INLINE bool
+voComputeContext::IsAsync() const
+{
+    return m_isAsync == 1;
+}
+
+FORCE_INLINE voQueue *
+voComputeContext::GetQueue() const
+{
+    return m_queue;
+}
+
+#endif //VULKANO_COMPUTECONTEXT_H
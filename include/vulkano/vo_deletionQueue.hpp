@@ -0,0 +1,197 @@
+#ifndef VULKANO_DELETIONQUEUE_H
+#define VULKANO_DELETIONQUEUE_H
+
+#include <functional>
+#include <mutex>
+#include <utility>
+#include <vector>
+#include "vo_api.hpp"
+#include "vo_common.hpp"
+
+class voDeviceContext;
+class voQueue;
+
+// ======================================================================================================================
+// ============================================ voDeletionQueue =========================================================
+// ======================================================================================================================
+
+/**
+ * @class voDeletionQueue
+ * @brief Defers the destruction of Vulkan objects until the GPU is done with them.
+ *
+ * @details Every entry is keyed on a point of a queue timeline, the value of the last submission that may use the object.
+ * Objects released while a frame is being recorded are pending until the frame is submitted,
+ * the swapchain then stamps them with the timeline value of the frame.
+ * `Collect`, called by the device context at the beginning of every frame, destroys the entries the GPU went past,
+ * so buffers, images, pipelines or framebuffers can be replaced at any time without draining the device.
+ *
+ * @code
+ * // The pipeline may still be used by frames in flight
+ * device->m_deletionQueue.Release( pipeline );
+ * pipeline = {};
+ * pipeline.Create( device, parms );
+ *
+ * // Objects used by a compute pass are released after the pass
+ * device->m_deletionQueue.Destroy( device->m_computeContext.GetQueue(), value, [buffer]( voDeviceContext * device ) { buffer.Cleanup( device ); } );
+ * @endcode
+ *
+ * @see `voHandle`, `voQueue`, `voDeviceContext`
+ */
+class VO_API voDeletionQueue
+{
+  public:
+    voDeletionQueue()  = default;
+    ~voDeletionQueue() = default;
+
+    voDeletionQueue( const voDeletionQueue & )             = delete;
+    voDeletionQueue & operator=( const voDeletionQueue & ) = delete;
+
+    using deleter_t = std::function< void( voDeviceContext * ) >;
+
+    /**
+     * @brief Destroys an object once the frame being recorded has been executed.
+     * @param deleter Releases the object.
+     */
+    void Destroy( deleter_t && deleter );
+
+    /**
+     * @brief Destroys an object once a queue reached a timeline value.
+     * @param queue The queue of the last submission using the object.
+     * @param value The timeline value of that submission.
+     * @param deleter Releases the object.
+     */
+    void Destroy( voQueue * queue, uint64_t value, deleter_t && deleter );
+
+    /**
+     * @brief Destroys a copy of an object, with its `Cleanup` method, once the frame being recorded has been executed.
+     *
+     * @details The handles are copied, the caller resets or recreates the object right away.
+     *
+     * @param object A `voBuffer`, `voImage`, `voPipeline`, `voFrameBuffer` or any type with `Cleanup( voDeviceContext * )`.
+     */
+    template< typename T >
+    void Release( const T & object );
+
+    /**
+     * @brief Keys the pending entries on a submitted timeline value.
+     * @param queue The queue of the submission.
+     * @param value The timeline value of the submission.
+     */
+    void Stamp( voQueue * queue, uint64_t value );
+
+    /**
+     * @brief Destroys the entries whose timeline value has been reached, without blocking.
+     * @param device The device context.
+     */
+    void Collect( voDeviceContext * device );
+
+    /**
+     * @brief Waits for every entry and destroys them, pending ones included.
+     * @details Entries queued by the deleters meanwhile are destroyed as well.
+     * @param device The device context, its queues must be idle or about to be.
+     */
+    void Flush( voDeviceContext * device );
+
+    /** @brief Get the number of objects waiting to be destroyed */
+    [[nodiscard]] size_t GetNumEntries();
+
+  private:
+    /**
+     * @struct entry_t
+     * @brief An object waiting for a point of a queue timeline.
+     */
+    struct entry_t
+    {
+        voQueue * queue;    ///< Null while pending the submission of the frame
+        uint64_t  value;
+        deleter_t deleter;
+    };
+
+    std::vector< entry_t > m_entries {};
+    std::mutex             m_mutex;
+};
+
+// ======================================================================================================================
+// ============================================ voHandle ================================================================
+// ======================================================================================================================
+
+/**
+ * @class voHandle
+ * @brief Move-only owner of an object whose destruction goes through the deletion queue.
+ *
+ * @details Resetting, reassigning or destroying the handle releases the owned object with `voDeletionQueue::Release`,
+ * it is then destroyed once the frames using it have been executed.
+ *
+ * @code
+ * voHandle< voPipeline > pipeline( device->m_deletionQueue );
+ * pipeline->Create( device, parms );
+ *
+ * // On resize, the old pipeline outlives the frames in flight
+ * pipeline.Reset();
+ * pipeline->Create( device, resizedParms );
+ * @endcode
+ *
+ * @see `voDeletionQueue`
+ */
+template< typename T >
+class voHandle
+{
+  public:
+    voHandle() = default;
+    explicit voHandle( voDeletionQueue & deletionQueue ) : m_deletionQueue( &deletionQueue ) {}
+    ~voHandle() { Reset(); }
+
+    voHandle( const voHandle & )             = delete;
+    voHandle & operator=( const voHandle & ) = delete;
+
+    voHandle( voHandle && other ) noexcept
+        : m_deletionQueue( std::exchange( other.m_deletionQueue, nullptr ) )
+        , m_object( std::exchange( other.m_object, T {} ) )
+    {
+    }
+
+    voHandle &
+    operator=( voHandle && other ) noexcept
+    {
+        if( this != &other )
+            {
+                Reset();
+                m_deletionQueue = std::exchange( other.m_deletionQueue, nullptr );
+                m_object        = std::exchange( other.m_object, T {} );
+            }
+        return *this;
+    }
+
+    /** @brief Releases the owned object through the deletion queue and leaves an empty one */
+    void
+    Reset()
+    {
+        if( m_deletionQueue != nullptr )
+            {
+                m_deletionQueue->Release( m_object );
+            }
+        m_object = T {};
+    }
+
+    T * operator->() { return &m_object; }
+    const T * operator->() const { return &m_object; }
+    T & operator*() { return m_object; }
+    const T & operator*() const { return m_object; }
+
+  private:
+    voDeletionQueue * m_deletionQueue { nullptr };
+    T                 m_object {};
+};
+
+// ======================================================================================================================
+// ============================================ Inline ==================================================================
+// ======================================================================================================================
+
+template< typename T >
+FORCE_INLINE void
+voDeletionQueue::Release( const T & object )
+{
+    Destroy( [copy = T( object )]( voDeviceContext * device ) mutable { copy.Cleanup( device ); } );
+}
+
+#endif //VULKANO_DELETIONQUEUE_H
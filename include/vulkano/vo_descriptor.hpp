@@ -1,14 +1,21 @@
 #ifndef VULKANO_DESCRIPTOR_H
 #define VULKANO_DESCRIPTOR_H
 
+#include <atomic>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 #include "vo_api.hpp"
 #include "vo_common.hpp"
+#include "vo_descriptorAllocator.hpp"
 
 class voDeviceContext;
 class voDescriptors;
 class voBuffer;
 class voPipeline;
 class voImage;
+class voShader;
 
 // ======================================================================================================================
 // ============================================ voDescriptors ============================================================
@@ -35,11 +42,34 @@ class voImage;
  * voBuffer buffer;
  * descriptor.BindBuffer(&buffer, offset, size, slot);
  *
- * // Bind the descriptor to a command buffer
+ * // Bind a storage buffer written by a compute pass
+ * descriptor.BindStorageBuffer(&particles, 0, VK_WHOLE_SIZE, 0);
+ *
+ * // Bind the descriptor to a command buffer, at the bind point of the pipeline
  * voPipeline pipeline;
  * descriptor.BindDescriptor(&deviceContext, commandBuffer, &pipeline);
  * @endcode
  *
+ * Binding only fills the descriptor, the descriptor set is picked by `BindDescriptor`: a set already written with the same
+ * resources is reused, so objects binding the same buffers and images every frame never write their set again.
+ *
+ * Slots created dynamic in `voDescriptors` keep their offset apart from the set. Moving them only changes the dynamic offsets
+ * given to the next `BindDescriptor`, so draws sharing a descriptor only bind the set again:
+ *
+ * @code
+ * voDescriptor descriptor = pipeline.GetFreeDescriptor();
+ * descriptor.BindBuffer( uniforms, cameraOffset, sizeof( camera_t ), 0 );
+ * for( const voRenderModel & renderModel : renderModels )
+ *     {
+ *         descriptor.BindBuffer( uniforms, renderModel.uboByteOffset, renderModel.uboByteSize, 1 ); // dynamic slot
+ *         descriptor.BindDescriptor( &deviceContext, commandBuffer, &pipeline );
+ *         renderModel.model->DrawIndexed( commandBuffer );
+ *     }
+ * @endcode
+ *
+ * Slots are counted per kind of resource: the n-th uniform buffer binding of the layout reads the uniform buffer slot n,
+ * the n-th image binding the image slot n, and so on, whether the layout was counted by hand or reflected from the shaders.
+ *
  * @see `voDeviceContext`, `voBuffer`, `voPipeline`
  */
 class VO_API voDescriptor
@@ -54,7 +84,7 @@ class VO_API voDescriptor
      * @param imageLayout The layout of the image to be bound.
      * @param imageView The view of the image to be bound.
      * @param sampler The sampler object to be used for the image.
-     * @param slot The slot in the descriptor set to bind the image to.
+     * @param slot The slot among the sampled images, in binding order.
      */
     void BindImage( VkImageLayout imageLayout, VkImageView imageView, VkSampler sampler, int slot );
 
@@ -62,14 +92,35 @@ class VO_API voDescriptor
      * @brief Binds a buffer to a specific slot in the descriptor set.
      *
      * @param uniformBuffer The buffer to be bound.
-     * @param offset The offset in the buffer to start binding from.
+     * @param offset The offset in the buffer to start binding from, passed at bind time for dynamic slots.
      * @param size The size of the buffer to bind.
-     * @param slot The slot in the descriptor set to bind the buffer to.
+     * @param slot The slot among the uniform buffers, in binding order.
      */
     void BindBuffer( voBuffer * uniformBuffer, VkDeviceSize offset, VkDeviceSize size, int slot );
 
     /**
-     * @brief Binds the descriptor set to a command buffer.
+     * @brief Binds a storage buffer to a specific slot in the descriptor set.
+     *
+     * @param storageBuffer The buffer to be bound, created with `VK_BUFFER_USAGE_STORAGE_BUFFER_BIT`.
+     * @param offset The offset in the buffer to start binding from, passed at bind time for dynamic slots.
+     * @param size The size of the buffer to bind.
+     * @param slot The slot among the storage buffers.
+     */
+    void BindStorageBuffer( voBuffer * storageBuffer, VkDeviceSize offset, VkDeviceSize size, int slot );
+
+    /**
+     * @brief Binds a storage image to a specific slot in the descriptor set.
+     *
+     * @param imageView The view of the image, created with `VK_IMAGE_USAGE_STORAGE_BIT`.
+     * @param slot The slot among the storage images.
+     */
+    void BindStorageImage( VkImageView imageView, int slot );
+
+    /**
+     * @brief Binds the descriptor set to a command buffer, at the graphics or compute bind point of the pipeline.
+     *
+     * @details The set is only looked up again once a resource other than a dynamic offset has changed,
+     * it is valid for the frame being recorded.
      *
      * @param device The device context to use for binding.
      * @param vkCommandBuffer The command buffer to bind the descriptor set to.
@@ -81,15 +132,33 @@ class VO_API voDescriptor
     friend class voDescriptors;
     voDescriptors * m_parent { nullptr };
 
-    int m_id { -1 }; ///< Id of the descriptor set to be used
-
-    int m_numBuffers { 0 }; ///< Total amount of buffers binded
     static const int MAX_BUFFERS { 16 };
-    VkDescriptorBufferInfo m_bufferInfo[MAX_BUFFERS] {};
-
-    int m_numImages { 0 }; ///< Total amount of images binded
     static const int MAX_IMAGEINFO { 16 };
-    VkDescriptorImageInfo m_imageInfo[MAX_IMAGEINFO] {};
+
+    /**
+     * @struct bindings_t
+     * @brief The bound resources, laid out for the update template of the descriptor set layout.
+     */
+    struct bindings_t
+    {
+        VkDescriptorBufferInfo buffers[MAX_BUFFERS];
+        VkDescriptorImageInfo  images[MAX_IMAGEINFO];
+        VkDescriptorBufferInfo storageBuffers[MAX_BUFFERS];
+        VkDescriptorImageInfo  storageImages[MAX_IMAGEINFO];
+    };
+    bindings_t m_bindings {};
+
+    uint32_t m_dynamicOffsets[MAX_BUFFERS] {};        ///< Offsets of the dynamic uniform buffers
+    uint32_t m_dynamicStorageOffsets[MAX_BUFFERS] {}; ///< Offsets of the dynamic storage buffers
+
+    VkDescriptorSet m_vkDescriptorSet { VK_NULL_HANDLE }; ///< Set picked by the last bind
+    uint64_t        m_cacheGeneration { 0 };              ///< Evictions of the cache when the set was picked
+    bool            m_dirty { true };                     ///< A resource changed since the last bind, for cached sets
+
+    int m_numBuffers { 0 };        ///< Total amount of buffers binded, up to the highest slot
+    int m_numImages { 0 };         ///< Total amount of images binded, up to the highest slot
+    int m_numStorageBuffers { 0 }; ///< Total amount of storage buffers binded, up to the highest slot
+    int m_numStorageImages { 0 };  ///< Total amount of storage images binded, up to the highest slot
 };
 
 // ======================================================================================================================
@@ -105,6 +174,13 @@ class VO_API voDescriptor
  * The class provides functionalities for creating a descriptor pool and descriptor set layout, 
  * cleaning up and destroying the descriptor pool and descriptor set layout, and getting a free descriptor from the pool.
  *
+ * Descriptor sets are cached by the resources they hold: binding the same buffers, offsets and images again reuses the set
+ * written the first time, through a descriptor update template. The least recently used sets are released once the cache
+ * is full, after the frame that dropped them has been executed, and the sets holding a resource are evicted when it is destroyed. Layouts whose bindings change on every draw are created
+ * `transient`, their sets are allocated from the frame pools of `voDescriptorAllocator` and written on every bind instead,
+ * or when the device supports VK_KHR_push_descriptor,
+ * transient bindings are pushed straight into the command buffer and no set is allocated at all.
+ *
  * @see `voDeviceContext`, `voDescriptor`
  */
 class VO_API voDescriptors
@@ -121,14 +197,24 @@ class VO_API voDescriptors
     */
     struct CreateParms_t
     {
-        uint32_t numUniformsVertex { 0 };
-        uint32_t numUniformsFragment { 0 };
-        uint32_t numImageSamplers { 0 };
+        uint32_t numUniformsVertex { 0 };    ///< Uniform buffers of the vertex stage
+        uint32_t numUniformsFragment { 0 };  ///< Uniform buffers of the fragment stage, after the vertex ones
+        uint32_t numImageSamplers { 0 };     ///< Combined image samplers of the fragment stage
+        uint32_t numStorageBuffers { 0 };
+        uint32_t numStorageImages { 0 };
+        VkShaderStageFlags stageFlags { 0 }; ///< Stages of every binding, zero keeps the stages above, compute for storage, or the reflected ones
+        uint32_t dynamicUniforms { 0 };       ///< Mask of the uniform buffer slots bound with a dynamic offset
+        uint32_t dynamicStorageBuffers { 0 }; ///< Mask of the storage buffer slots bound with a dynamic offset
+        uint8_t transient : 1 { false };     ///< Bindings change on every draw, pushed or written on every bind instead of cached
+        voShader * shader { nullptr };       ///< Bindings of set 0 reflected from the shader, the counts above are then ignored
+        uint32_t maxExternalSets { 0 };      ///< Sets allocated outside of the class from `vkDescriptorPool`, like the UI ones
     };
     CreateParms_t m_parms {};
 
     /**
-     * @brief Create a descriptor pool and descriptor set layout.
+     * @brief Create the descriptor set layout, from the counts or from the reflection of the shader.
+     *
+     * @details The layout is shared through the layout cache of the device, a pool is only created for external sets.
      *
      * @param device The Vulkan device to create the descriptor pool and layout for.
      * @param parms The creation parameters for the descriptor pool and layout.
@@ -136,28 +222,104 @@ class VO_API voDescriptors
     void Create( voDeviceContext * device, const CreateParms_t & parms );
 
     /**
-     * @brief Clean up and destroy the descriptor pool and descriptor set layout.
+     * @brief Clean up and destroy the descriptor pool and the cached sets, the layout stays in the layout cache.
      *
-     * @param device The Vulkan device to destroy the descriptor pool and layout for.
+     * @param device The Vulkan device to destroy the descriptor pool for.
      */
     void Cleanup( voDeviceContext * device );
 
     /**
-     * @brief Get a free descriptor from the pool.
+     * @brief Get a free descriptor, its set is picked when it is bound.
      *
-     * @return A voDescriptor object representing a free descriptor in the pool.
+     * @return A voDescriptor object with no resource bound.
      */
     voDescriptor GetFreeDescriptor();
 
+    /**
+     * @brief Evicts the cached sets holding a buffer, image view or sampler, from every layout. Called before the resource is destroyed.
+     *
+     * @details Sets are cached by handle, a resource created later with the same handle must not find the sets of the destroyed one.
+     *
+     * @param device The device context the sets are freed with.
+     * @param handle The `VkBuffer`, `VkImageView` or `VkSampler` about to be destroyed.
+     */
+    static void Forget( voDeviceContext * device, uint64_t handle );
+
+    /** @brief Get the bindings the layout was created from */
+    [[nodiscard]] const std::vector< VkDescriptorSetLayoutBinding > & GetLayoutBindings() const;
+
+    /** @brief Get the creation flags of the layout */
+    [[nodiscard]] VkDescriptorSetLayoutCreateFlags GetLayoutFlags() const;
+
     /* -------------------------------------- Handlers ----------------------------------------------------------------- */
 
-    static const int MAX_DESCRIPTOR_SETS = 256;
+    VkDescriptorPool vkDescriptorPool { VK_NULL_HANDLE }; ///< For sets allocated outside of the class, only created with `maxExternalSets`
+    VkDescriptorSetLayout vkDescriptorSetLayout { VK_NULL_HANDLE }; ///< Owned by `voLayoutCache`
+    VkDescriptorUpdateTemplate vkUpdateTemplate { VK_NULL_HANDLE }; ///< Writes a whole set from a `voDescriptor`
 
-    VkDescriptorPool vkDescriptorPool { VK_NULL_HANDLE };
-    VkDescriptorSetLayout vkDescriptorSetLayout { VK_NULL_HANDLE };
+  private:
+    friend class voDescriptor;
+
+    static const int MAX_KEY_WORDS        = ( voDescriptor::MAX_BUFFERS + voDescriptor::MAX_IMAGEINFO ) * 2 * 3;
+    static const int MAX_PUSH_DESCRIPTORS = 32; ///< Guaranteed `maxPushDescriptors`, larger layouts keep their sets
+
+    /**
+     * @struct cache_entry_t
+     * @brief A written descriptor set, and the resources it holds.
+     */
+    struct cache_entry_t
+    {
+        uint64_t                hash { 0 };
+        std::vector< uint64_t > key {}; ///< Handles, offsets, ranges and layouts of the bound resources
+        VkDescriptorSet         vkDescriptorSet { VK_NULL_HANDLE };
+        uint32_t                pool { 0 }; ///< Index of the cache pool the set was allocated from
+    };
+
+    /**
+     * @brief Gets a descriptor set holding the resources, written only if no cached set holds them already.
+     */
+    VkDescriptorSet GetCachedSet( voDeviceContext * device, const voDescriptor::bindings_t & bindings );
 
-    int numDescriptorUsed { 0 };                              ///< Number of descriptors in the pool that are in use
-    VkDescriptorSet vkDescriptorSets[MAX_DESCRIPTOR_SETS] {}; ///< All descriptor set objects
+    /**
+     * @brief Writes the resources into the command buffer, for layouts created with the push descriptor flag.
+     */
+    void PushDescriptor( VkCommandBuffer vkCommandBuffer, voPipeline * pso, const voDescriptor::bindings_t & bindings ) const;
+
+    /**
+     * @brief Drops a cached set, it is freed once the frame being recorded has been executed.
+     */
+    void EvictEntry( voDeviceContext * device, std::list< cache_entry_t >::iterator entry );
+
+    /**
+     * @brief Allocates a set for the cache, a new pool is created once every pool is full.
+     */
+    VkDescriptorSet AllocateCachedSet( voDeviceContext * device, uint32_t & pool );
+
+    /**
+     * @brief Creates a pool holding sets of the layout.
+     */
+    VkDescriptorPool CreatePool( voDeviceContext * device, uint32_t maxSets ) const;
+
+    /**
+     * @brief Gathers the dynamic offsets of a descriptor, in binding order, returns their number.
+     */
+    uint32_t GetDynamicOffsets( const voDescriptor & descriptor, uint32_t * offsets ) const;
+
+    /**
+     * @brief Packs the resources into a key, returns the number of words written.
+     */
+    uint32_t PackKey( const voDescriptor::bindings_t & bindings, uint64_t * key ) const;
+
+    std::vector< VkDescriptorSetLayoutBinding >    m_layoutBindings {};
+    std::vector< VkDescriptorUpdateTemplateEntry > m_templateEntries {}; ///< Where every binding is read from in the bindings
+    bool                                           m_pushDescriptors { false };
+    voDescriptorAllocator::usage_t                 m_setUsage {}; ///< Descriptors of one set, for the frame allocator
+
+    std::mutex                                                           m_cacheMutex;
+    std::list< cache_entry_t >                                           m_cache {}; ///< Most recently used first
+    std::unordered_map< uint64_t, std::list< cache_entry_t >::iterator > m_cacheLookup {};
+    std::vector< VkDescriptorPool >                                      m_cachePools {}; ///< Grown as the cache fills up
+    std::atomic< uint64_t >                                              m_cacheGeneration { 0 }; ///< Bumped by every eviction
 };
 
 // ======================================================================================================================
@@ -169,8 +331,19 @@ voDescriptors::GetFreeDescriptor()
 {
     voDescriptor descriptor = {};
     descriptor.m_parent     = this;
-    descriptor.m_id         = numDescriptorUsed++ % MAX_DESCRIPTOR_SETS;
     return descriptor;
 }
 
+FORCE_INLINE const std::vector< VkDescriptorSetLayoutBinding > &
+voDescriptors::GetLayoutBindings() const
+{
+    return m_layoutBindings;
+}
+
+FORCE_INLINE VkDescriptorSetLayoutCreateFlags
+voDescriptors::GetLayoutFlags() const
+{
+    return m_pushDescriptors ? static_cast< VkDescriptorSetLayoutCreateFlags >( VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT_KHR ) : 0U;
+}
+
 #endif //VULKANO_DESCRIPTOR_H
@@ -0,0 +1,159 @@
+#ifndef VULKANO_DESCRIPTORALLOCATOR_H
+#define VULKANO_DESCRIPTORALLOCATOR_H
+
+#include <algorithm>
+#include <mutex>
+#include <vector>
+#include "vo_api.hpp"
+#include "vo_common.hpp"
+
+class voDeviceContext;
+
+/**
+ * @class voDescriptorAllocator
+ * @brief Per-frame descriptor pools, for descriptor sets only used by the frame being recorded.
+ *
+ * @details Each frame slot owns a chain of descriptor pools. Sets are allocated from the current pool of the slot,
+ * and a new pool is chained once it is full, so any number of sets can be allocated in a frame.
+ * Sets are never freed one by one: `BeginFrame` resets the pools of the slot as a whole, once the GPU has retired it.
+ *
+ * Pool sizes are learnt from the usage of the frames: a slot that had to chain pools replaces them with a single pool
+ * sized for the peak of its last frame, with some headroom, and every pool created afterwards is at least that large.
+ *
+ * Used by transient `voDescriptors` layouts when push descriptors are unavailable.
+ *
+ * @code
+ * voDescriptorAllocator::usage_t usage {};
+ * usage.Add( VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 2 );
+ *
+ * VkDescriptorSet set = device->m_descriptorAllocator.Allocate( device, layout, usage );
+ * vkUpdateDescriptorSetWithTemplate( device->deviceInfo.logical, set, updateTemplate, &data );
+ * @endcode
+ *
+ * @see `voDescriptors`, `voCommandAllocator`
+ */
+class VO_API voDescriptorAllocator
+{
+  public:
+    voDescriptorAllocator()  = default;
+    ~voDescriptorAllocator() = default;
+
+    voDescriptorAllocator( const voDescriptorAllocator & )             = delete;
+    voDescriptorAllocator & operator=( const voDescriptorAllocator & ) = delete;
+
+    static const uint32_t NUM_DESCRIPTOR_TYPES = VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT + 1; ///< Core types, from the sampler to the input attachment
+
+    /**
+     * @struct usage_t
+     * @brief Number of sets, and of descriptors of every type, of a set layout or of a pool.
+     */
+    struct usage_t
+    {
+        uint32_t numSets { 0 };
+        uint32_t numDescriptors[NUM_DESCRIPTOR_TYPES] {};
+
+        /** @brief Adds descriptors of a type */
+        void Add( VkDescriptorType type, uint32_t count );
+
+        /** @brief Adds another usage */
+        void Add( const usage_t & usage );
+
+        /** @brief Keeps the largest count of every entry */
+        void Max( const usage_t & usage );
+    };
+
+    /**
+     * @struct CreateParms_t
+     * @brief Parameters for creating the descriptor allocator.
+     */
+    struct CreateParms_t
+    {
+        uint32_t numFrames;   ///< Number of frame slots
+        uint32_t initialSets; ///< Number of sets of the first pools, until the frames have been measured
+    };
+
+    /**
+     * @brief Prepares the pool chains, pools are only created once sets are allocated.
+     * @param device The device context.
+     * @param parms The parameters for creating the allocator.
+     * @return True if creation is successful, false otherwise.
+     */
+    bool Create( voDeviceContext * device, const CreateParms_t & parms );
+
+    /**
+     * @brief Destroys every pool along with its sets, the GPU must be done with them.
+     * @param device The device context.
+     */
+    void Cleanup( voDeviceContext * device );
+
+    /**
+     * @brief Resets the pools of a frame slot, its sets are released.
+     *
+     * @details Called by the device context once the GPU has retired the slot, before any set is allocated for it.
+     *
+     * @param device The device context.
+     * @param frameIndex The frame slot being recorded.
+     */
+    void BeginFrame( voDeviceContext * device, uint32_t frameIndex );
+
+    /**
+     * @brief Allocates a set for the frame being recorded, thread safe.
+     * @param device The device context.
+     * @param layout The layout of the set.
+     * @param usage The descriptors of the layout, one set.
+     * @return A set valid until the frame slot is reused.
+     */
+    VkDescriptorSet Allocate( voDeviceContext * device, VkDescriptorSetLayout layout, const usage_t & usage );
+
+  private:
+    /**
+     * @struct frame_t
+     * @brief The pool chain of a frame slot, and what its frame allocated.
+     */
+    struct frame_t
+    {
+        std::vector< VkDescriptorPool > pools {};
+        uint32_t                        current { 0 }; ///< Pool sets are allocated from, the next ones are full
+        usage_t                         used {};
+    };
+
+    VkDescriptorPool CreatePool( voDeviceContext * device, const usage_t & size ) const;
+
+    std::vector< frame_t > m_frames {};
+    uint32_t               m_frameIndex { 0 };
+    usage_t                m_poolSize {}; ///< Learnt from the peaks of the frames
+    std::mutex             m_mutex;
+};
+
+// ======================================================================================================================
+// ============================================ Inline ==================================================================
+// ======================================================================================================================
+
+FORCE_INLINE void
+voDescriptorAllocator::usage_t::Add( VkDescriptorType type, uint32_t count )
+{
+    voAssert( type < NUM_DESCRIPTOR_TYPES && "Descriptor type not handled by the allocator" );
+    numDescriptors[type] += count;
+}
+
+FORCE_INLINE void
+voDescriptorAllocator::usage_t::Add( const usage_t & usage )
+{
+    numSets += usage.numSets;
+    for( uint32_t i = 0; i < NUM_DESCRIPTOR_TYPES; i++ )
+        {
+            numDescriptors[i] += usage.numDescriptors[i];
+        }
+}
+
+FORCE_INLINE void
+voDescriptorAllocator::usage_t::Max( const usage_t & usage )
+{
+    numSets = std::max( numSets, usage.numSets );
+    for( uint32_t i = 0; i < NUM_DESCRIPTOR_TYPES; i++ )
+        {
+            numDescriptors[i] = std::max( numDescriptors[i], usage.numDescriptors[i] );
+        }
+}
+
+#endif //VULKANO_DESCRIPTORALLOCATOR_H
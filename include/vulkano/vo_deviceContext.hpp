@@ -3,8 +3,20 @@
 
 #include <vector>
 #include "vo_api.hpp"
+#include "vo_commandAllocator.hpp"
 #include "vo_common.hpp"
+#include "vo_computeContext.hpp"
+#include "vo_deletionQueue.hpp"
+#include "vo_descriptorAllocator.hpp"
+#include "vo_fence.hpp"
+#include "vo_jobSystem.hpp"
+#include "vo_layoutCache.hpp"
+#include "vo_memory.hpp"
+#include "vo_pipelineCache.hpp"
+#include "vo_pipelineRegistry.hpp"
+#include "vo_queue.hpp"
 #include "vo_swapChain.hpp"
+#include "vo_uploadContext.hpp"
 
 // ======================================================================================================================
 // ============================================ Structs =================================================================
@@ -23,8 +35,25 @@ struct VO_API function_set_t
      */
     static void Link( VkInstance instance );
 
+    /**
+     * @brief Links the function pointers of the optional device extensions
+     *
+     * @param device The logical device
+     */
+    static void LinkDevice( VkDevice device );
+
     static PFN_vkCreateDebugReportCallbackEXT vkCreateDebugReportCallbackEXT;
     static PFN_vkDestroyDebugReportCallbackEXT vkDestroyDebugReportCallbackEXT;
+    static PFN_vkCmdPushDescriptorSetKHR vkCmdPushDescriptorSetKHR; ///< Only set when `device_features_t::pushDescriptor` is
+
+    // Only set when `device_features_t::extendedDynamicState` is
+    static PFN_vkCmdSetCullModeEXT vkCmdSetCullModeEXT;
+    static PFN_vkCmdSetFrontFaceEXT vkCmdSetFrontFaceEXT;
+    static PFN_vkCmdSetPrimitiveTopologyEXT vkCmdSetPrimitiveTopologyEXT;
+    static PFN_vkCmdSetDepthTestEnableEXT vkCmdSetDepthTestEnableEXT;
+    static PFN_vkCmdSetDepthWriteEnableEXT vkCmdSetDepthWriteEnableEXT;
+    static PFN_vkCmdSetDepthCompareOpEXT vkCmdSetDepthCompareOpEXT;
+    static PFN_vkCmdSetDepthBiasEnableEXT vkCmdSetDepthBiasEnableEXT; ///< Only set when `device_features_t::extendedDynamicState2` is
 };
 
 /**
@@ -37,6 +66,11 @@ struct VO_API physical_device_properties_t
     VkPhysicalDeviceProperties deviceProperties {};
     VkPhysicalDeviceMemoryProperties memoryProperties {};
     VkPhysicalDeviceFeatures features {};
+    VkPhysicalDeviceVulkan12Features features12 {}; ///< Only queried on Vulkan 1.2 devices
+    VkPhysicalDeviceExtendedDynamicStateFeaturesEXT featuresDynamicState {};   ///< Only queried when VK_EXT_extended_dynamic_state is supported
+    VkPhysicalDeviceExtendedDynamicState2FeaturesEXT featuresDynamicState2 {}; ///< Only queried when VK_EXT_extended_dynamic_state2 is supported
+    VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT featuresPipelineLibrary {};     ///< Only queried when VK_EXT_graphics_pipeline_library is supported
+    VkPhysicalDeviceGraphicsPipelineLibraryPropertiesEXT propertiesPipelineLibrary {}; ///< Only queried when VK_EXT_graphics_pipeline_library is supported
     VkSurfaceCapabilitiesKHR surfaceCapabilities {};
 
     std::vector< VkSurfaceFormatKHR > surfaceFormats {};
@@ -76,6 +110,20 @@ struct VO_API device_t
     int index { -1 };
 };
 
+/**
+ * @struct device_features_t
+ * @brief Optional features that were found and enabled on the logical device
+ */
+struct VO_API device_features_t
+{
+    uint8_t timelineSemaphore : 1 { false };
+    uint8_t descriptorIndexing : 1 { false }; ///< Update-after-bind, partially bound descriptor arrays, for `voBindless`
+    uint8_t pushDescriptor : 1 { false };     ///< VK_KHR_push_descriptor, transient descriptors are written into the command buffer
+    uint8_t extendedDynamicState : 1 { false };  ///< VK_EXT_extended_dynamic_state, cull mode, front face, topology and depth state set when recording
+    uint8_t extendedDynamicState2 : 1 { false }; ///< VK_EXT_extended_dynamic_state2, depth bias enable set when recording
+    uint8_t graphicsPipelineLibrary : 1 { false }; ///< VK_EXT_graphics_pipeline_library with fast linking, graphics pipelines linked from cached parts
+};
+
 /**
  * @struct queueFamilyIndices_t
  * @brief Contains the indices of the queue families
@@ -86,6 +134,8 @@ struct VO_API queue_families_t
     // Locations
     int32_t graphicsFamily { -1 };
     int32_t presentationFamily { -1 };
+    int32_t transferFamily { -1 }; ///< Transfer capable family without graphics, -1 if the device has none
+    int32_t computeFamily { -1 };  ///< Compute capable family without graphics, -1 if the device has none
 
     /** @brief Check if the queue families are valid */
     FORCE_INLINE bool
@@ -99,6 +149,20 @@ struct VO_API queue_families_t
     {
         return graphicsFamily == presentationFamily;
     }
+
+    /** @brief Check if uploads can run on their own queue family */
+    FORCE_INLINE bool
+    HasDedicatedTransfer() const
+    {
+        return transferFamily > -1;
+    }
+
+    /** @brief Check if compute work can run asynchronously on its own queue family */
+    FORCE_INLINE bool
+    HasDedicatedCompute() const
+    {
+        return computeFamily > -1;
+    }
 };
 
 // ======================================================================================================================
@@ -112,6 +176,11 @@ struct VO_API queue_families_t
  * @details The voDeviceContext class is responsible for managing a Vulkan Device Context.
  * It provides functionalities for creating a Vulkan instance, device, physical device, logical device, 
  * command buffers, and swap chain, as well as cleaning up and releasing all Vulkan resources attached.
+ * It owns the `voMemory` allocator every buffer and image of the library is sub-allocated from,
+ * and the `voUploadContext` used to upload data into device local memory, on a dedicated transfer queue when available.
+ * Compute work is recorded through the `voComputeContext`, on an async compute queue when available.
+ * Objects that may still be used by the GPU are destroyed through the `voDeletionQueue`, once the frames using them have been executed.
+ * Work spread over several threads (loading, culling, command recording) is scheduled on its `voJobSystem`.
  * It also provides functionalities for finding a memory type index that matches the specified filter and properties,
  * getting the physical device properties, and beginning and ending a frame.
  *
@@ -200,14 +269,91 @@ class VO_API voDeviceContext
 
     queue_families_t queueIds {};
 
+    device_features_t enabledFeatures {};
+
     VkQueue m_vkGraphicsQueue { VK_NULL_HANDLE };
     VkQueue presentQueue { VK_NULL_HANDLE };
 
+    /* ------------------------------------- Synchronization -------------------------------------- */
+
+    /**
+     * @brief Graphics queue, every submission returns a timeline value
+     * @details `m_vkGraphicsQueue` is the same `VkQueue`, submissions should go through this object.
+     * @see voQueue
+     */
+    voQueue m_graphicsQueue;
+
+    /**
+     * @brief Queue of the dedicated transfer family, only created when the device has one
+     * @see GetTransferQueue
+     */
+    voQueue m_transferQueue;
+
+    /** @brief Get the queue uploads are submitted to, the graphics queue when there is no dedicated transfer family */
+    voQueue * GetTransferQueue();
+
+    /**
+     * @brief Queue of the dedicated compute family, only created when the device has one
+     * @see GetComputeQueue
+     */
+    voQueue m_computeQueue;
+
+    /** @brief Get the queue compute work is submitted to, the graphics queue when there is no dedicated compute family */
+    voQueue * GetComputeQueue();
+
+    /**
+     * @brief Get the distinct families of the graphics and compute queues
+     *
+     * @details Resources created with `VK_SHARING_MODE_CONCURRENT` are shared between these families.
+     *
+     * @param families Receives up to two family indices
+     * @return The number of distinct families
+     */
+    uint32_t GetConcurrentFamilies( uint32_t families[2] ) const;
+
+    /**
+     * @brief Fences recycled by `voFence` and by queues without timeline semaphores
+     * @see voFencePool
+     */
+    voFencePool m_fencePool;
+
     std::vector< physical_device_properties_t > m_physicalDevices {};
 
     std::vector< const char * > m_validationLayers {};
     static const std::vector< const char * > m_deviceExtensions;
 
+    /* ------------------------------------- Memory -------------------------------------- */
+
+    /**
+     * @brief Device memory allocator, created along with the logical device
+     * @see voMemory
+     */
+    voMemory * m_memory { nullptr };
+
+    /**
+     * @brief Staging ring used to fill device local resources
+     * @see voUploadContext
+     */
+    voUploadContext m_uploadContext;
+
+    /**
+     * @brief Command buffers submitted to the compute queue
+     * @see voComputeContext
+     */
+    voComputeContext m_computeContext;
+
+    /**
+     * @brief Objects waiting for the GPU to be done with them before being destroyed
+     * @see voDeletionQueue
+     */
+    voDeletionQueue m_deletionQueue;
+
+    /**
+     * @brief Work-stealing thread pool, its thread indices select the pools of `m_commandAllocator`
+     * @see voJobSystem
+     */
+    voJobSystem m_jobSystem;
+
     /* ------------------------------------- Command Buffers -------------------------------------- */
 
     /**
@@ -221,6 +367,36 @@ class VO_API voDeviceContext
 
     std::vector< VkCommandBuffer > m_vkCommandBuffers {};
 
+    /**
+     * @brief Per-thread, per-frame command pools, for command buffers recorded by worker threads
+     * @see voCommandAllocator
+     */
+    voCommandAllocator m_commandAllocator;
+
+    /**
+     * @brief Per-frame descriptor pools, reset along with the command pools of the frame slot
+     * @see voDescriptorAllocator
+     */
+    voDescriptorAllocator m_descriptorAllocator;
+
+    /**
+     * @brief Descriptor set layouts and pipeline layouts, shared by every pipeline describing them the same way
+     * @see voLayoutCache
+     */
+    voLayoutCache m_layoutCache;
+
+    /**
+     * @brief Pipeline cache every pipeline is created with, loaded from and saved to disk
+     * @see voPipelineCache
+     */
+    voPipelineCache m_pipelineCache;
+
+    /**
+     * @brief Pipelines by state, compiled once and shared by the `voPipeline` describing the same state
+     * @see voPipelineRegistry
+     */
+    voPipelineRegistry m_pipelineRegistry;
+
     /**
      * @brief Create a Vulkan command buffer
      *
@@ -234,9 +410,9 @@ class VO_API voDeviceContext
      * @brief Flush a Vulkan command buffer
      *
      * @param commandBuffer The command buffer to flush
-     * @param queue The Vulkan queue to submit the command buffer to
+     * @param queue The queue to submit the command buffer to
      */
-    void FlushCommandBuffer( VkCommandBuffer commandBuffer, VkQueue queue );
+    void FlushCommandBuffer( VkCommandBuffer commandBuffer, voQueue * queue );
 
     /* ------------------------------------- Swap Chain ------------------------------------- */
 
@@ -249,31 +425,47 @@ class VO_API voDeviceContext
     /**
      * @brief Create a SwapChain
      *
+     * @details Then warms up the pipelines of the previous run, see `voPipeline::WarmUp`.
+     *
      * @param width The width of the SwapChain
      * @param height The height of the SwapChain
+     * @param framesInFlight Number of frames recorded ahead of the GPU
      *
      * @return True if the SwapChain was created successfully, false otherwise
      */
-    bool CreateSwapChain( int width, int height );
+    bool CreateSwapChain( int width, int height, uint32_t framesInFlight = 2 );
 
     /**
      * @brief Resize the window
      *
+     * @details Does not block, bursts of resize events are coalesced into a single swapchain rebuild.
+     *
      * @param width The new width of the window
      * @param height The new height of the window
      */
     void ResizeWindow( int width, int height );
 
     /**
-     * @brief Begin a frame
+     * @brief Begin a frame, waiting for the GPU to release the frame slot if needed
      *
-     * @return The index of the current frame
+     * @details Also destroys the objects of the deletion queue the GPU is done with.
+     *
+     * @return The index of the current frame slot, and of its command buffer in `m_vkCommandBuffers`
      */
     uint32_t BeginFrame();
 
     /** @brief End a frame */
     void EndFrame();
 
+    /**
+     * @brief Make the submission of the current frame wait for a point of another queue timeline
+     *
+     * @details Typically the value returned by `voComputeContext::Submit`, with the stages consuming the compute results.
+     *
+     * @param wait The timeline point and the stages of the frame it blocks
+     */
+    void AddFrameWait( const voQueue::wait_t & wait );
+
     /** @brief Begin a render pass */
     void BeginRenderPass();
 
@@ -315,44 +507,57 @@ voDeviceContext::GetPhysicalProperties() const
     return &m_physicalDevices[deviceInfo.index];
 }
 
-FORCE_INLINE bool
-voDeviceContext::CreateSwapChain( int width, int height )
+FORCE_INLINE voQueue *
+voDeviceContext::GetTransferQueue()
 {
-    return swapChain.Create( this, width, height );
+    return queueIds.HasDedicatedTransfer() ? &m_transferQueue : &m_graphicsQueue;
 }
 
-FORCE_INLINE void
-voDeviceContext::ResizeWindow( int width, int height )
+FORCE_INLINE voQueue *
+voDeviceContext::GetComputeQueue()
 {
-    spdlog::info( std::string( 50, '-' ) );
-
-    // Log the window resize request
-    spdlog::info( "Resizing window to ({}, {})", width, height );
-
-    // Update surface capabilities
-    {
-        VkSurfaceCapabilitiesKHR * props = &GetPhysicalProperties()->surfaceCapabilities;
+    return queueIds.HasDedicatedCompute() ? &m_computeQueue : &m_graphicsQueue;
+}
 
-        VK_CHECK( vkGetPhysicalDeviceSurfaceCapabilitiesKHR( deviceInfo.physical, VkSurface, props ),
-                  "Failed to vkGetPhysicalDeviceSurfaceCapabilitiesKHR!" );
+FORCE_INLINE uint32_t
+voDeviceContext::GetConcurrentFamilies( uint32_t families[2] ) const
+{
+    families[0] = static_cast< uint32_t >( queueIds.graphicsFamily );
+    families[1] = static_cast< uint32_t >( queueIds.computeFamily );
 
-        // Log surface capabilities update
-        spdlog::info( "Surface capabilities updated successfully" );
-    }
+    return queueIds.HasDedicatedCompute() ? 2 : 1;
+}
 
-    // Request Swapchain resize
+FORCE_INLINE void
+voDeviceContext::ResizeWindow( int width, int height )
+{
+    // Only records the request, the swapchain is rebuilt once by the next frame
     swapChain.Resize( this, width, height );
-
-    // Log swapchain resize request
-    spdlog::info( "Swapchain resized to ({}, {})", width, height );
-
-    spdlog::info( "" );
 }
 
 FORCE_INLINE uint32_t
 voDeviceContext::BeginFrame()
 {
-    return swapChain.BeginFrame( this );
+    // Streamed uploads are submitted ahead of the frame that may use them
+    m_uploadContext.Pump( this );
+    m_deletionQueue.Collect( this );
+
+    // GLFW and other main thread calls requested by the jobs, when not rendering on a thread of its own
+    if( voJobSystem::GetThreadIndex() == 0 )
+        {
+            m_jobSystem.RunMainThreadJobs();
+        }
+
+    const uint32_t frameIndex = swapChain.BeginFrame( this );
+
+    // The GPU retired the slot, the command buffers recorded by the threads for it are recycled
+    m_commandAllocator.BeginFrame( this, frameIndex );
+    m_descriptorAllocator.BeginFrame( this, frameIndex );
+
+    // Pipelines compiled since the last save are written in the background
+    m_pipelineCache.Update( this );
+
+    return frameIndex;
 }
 
 FORCE_INLINE void
@@ -361,6 +566,12 @@ voDeviceContext::EndFrame()
     swapChain.EndFrame( this );
 }
 
+FORCE_INLINE void
+voDeviceContext::AddFrameWait( const voQueue::wait_t & wait )
+{
+    swapChain.AddWait( wait );
+}
+
 FORCE_INLINE void
 voDeviceContext::BeginRenderPass()
 {
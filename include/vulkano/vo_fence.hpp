@@ -1,35 +1,67 @@
 #ifndef VULKANO_FENCE_H
 #define VULKANO_FENCE_H
 
+#include <mutex>
+#include <vector>
 #include "vo_api.hpp"
 #include "vulkano/vo_common.hpp"
 
 
 class voDeviceContext;
 
+/**
+ * @class voFencePool
+ * @brief Recycles unsignaled Vulkan fences.
+ *
+ * @details Creating and destroying a fence for every submission is wasteful, the pool hands out
+ * fences in the unsignaled state and takes them back once they have been waited on.
+ * It is thread safe, and is owned by the `voDeviceContext`.
+ *
+ * @code
+ * VkFence fence = device->m_fencePool.Acquire( device );
+ *
+ * vkQueueSubmit( queue, 1, &submitInfo, fence );
+ * vkWaitForFences( device->deviceInfo.logical, 1, &fence, VK_TRUE, UINT64_MAX );
+ *
+ * device->m_fencePool.Release( device, fence );
+ * @endcode
+ *
+ * @see `voFence`, `voQueue`
+ */
+class VO_API voFencePool
+{
+public:
+    /** @brief Destroys every fence of the pool, none of them may be in use */
+    void Cleanup( voDeviceContext * device );
+
+    /** @brief Get an unsignaled fence, creating one if the pool is empty */
+    VkFence Acquire( voDeviceContext * device );
+
+    /** @brief Resets a fence that is no longer in use and gives it back to the pool */
+    void Release( voDeviceContext * device, VkFence fence );
+
+private:
+    std::vector< VkFence > m_freeFences {};
+    std::mutex m_mutex;
+};
+
 /**
  * @class voFence
  * @brief A class that encapsulates a Vulkan Fence.
  *
  * @details The voFence class is responsible for managing a Vulkan Fence.
  * A fence is a synchronization primitive that can be used to insert a dependency from a queue to the host.
- * The class provides functionalities for creating a Vulkan fence object, waiting for the fence to become signaled, and getting the Vulkan fence object.
+ * The fence is taken from the fence pool of the device on construction,
+ * and waited on then given back to the pool on destruction.
  *
  * @code
- * voDeviceContext deviceContext;
- * voFence fence(&deviceContext);
- *
- * // Create the Vulkan fence object
- * fence.Create(&deviceContext);
- *
- * // Wait for the fence to become signaled
- * fence.Wait(&deviceContext);
- *
- * // Get the Vulkan fence object
- * VkFence vkFence = fence.GetFence();
+ * {
+ *     voFence fence( &deviceContext );
+ *     vkQueueSubmit( queue, 1, &submitInfo, fence.GetFence() );
+ * } // Waits for the submission to complete
  * @endcode
  *
- * @see `voDeviceContext`
+ * @see `voDeviceContext`, `voFencePool`
  */
 class VO_API voFence
 {
@@ -37,22 +69,17 @@ public:
     explicit voFence( voDeviceContext * device );
     ~voFence();
 
+    voFence( const voFence & )             = delete;
+    voFence & operator=( const voFence & ) = delete;
+
     /** @brief Get the Vulkan fence object */
    FORCE_INLINE VkFence GetFence() const;
 
 private:
-    /**
-     * @brief Create the Vulkan fence object
-     *
-     * @param device A pointer to the voDeviceContext object that the fence will be associated with.
-     */
-    void Create( voDeviceContext * device );
-
     /**
      * @brief Wait for the fence to become signaled
      *
      * @param device A pointer to the voDeviceContext object that the fence is associated with
-     * @return True if the fence was signaled, false otherwise
      */
     void Wait( voDeviceContext * device );
 
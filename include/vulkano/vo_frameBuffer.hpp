@@ -90,8 +90,9 @@ public:
      * @brief Begins the render pass for the framebuffer
      * @param device The Vulkan device context
      * @param cmdBufferIndex The index of the command buffer
+     * @param contents Whether the draws are recorded inline or executed from secondary command buffers
      */
-    void BeginRenderPass( voDeviceContext * device, int cmdBufferIndex );
+    void BeginRenderPass( voDeviceContext * device, int cmdBufferIndex, VkSubpassContents contents = VK_SUBPASS_CONTENTS_INLINE );
 
     /**
      * @brief Ends the render pass for the framebuffer
@@ -100,6 +101,12 @@ public:
      */
     void EndRenderPass( voDeviceContext * device, int cmdBufferIndex );
 
+    /**
+     * @brief Gets the render pass, framebuffer and dynamic state secondary command buffers are begun with
+     * @return The inheritance passed to voCommandAllocator::BeginSecondary
+     */
+    [[nodiscard]] voCommandAllocator::inheritance_t GetInheritance() const;
+
     CreateParms_t parms { 0 };
 
     voImage imageDepth { }; ///< The depth attachment for the framebuffer
@@ -3,6 +3,7 @@
 
 #include <vulkan/vulkan_core.h>
 #include "vo_api.hpp"
+#include "vo_memory.hpp"
 
 class voDeviceContext;
 
@@ -12,6 +13,8 @@ class voDeviceContext;
  *
  * @details The voImage class is responsible for managing a Vulkan Image.
  * An image represents a multidimensional array of data that can be used in various ways by the shader stages.
+ * Its memory is sub-allocated from the render target pool of the device context allocator, unless a dedicated
+ * allocation is requested.
  * The class provides functionalities for creating an image with given parameters, cleaning up the image, 
  * transitioning the image layout, and getting the Vulkan image, image view, and device memory objects.
  *
@@ -25,6 +28,7 @@ class voDeviceContext;
  *
  * // Transition the image layout
  * image.TransitionLayout(&deviceContext);
+ * image.Upload(&deviceContext, pixels, size);
  * image.TransitionLayout(cmdBuffer, newLayout);
  *
  * // Cleanup
@@ -50,6 +54,8 @@ class VO_API voImage
         uint32_t          width;      ///< The width of the image
         uint32_t          height;     ///< The height of the image
         uint32_t          depth;      ///< The depth of the image
+        uint8_t           dedicated : 1 { false }; ///< Give the image its own device memory allocation
+        uint8_t           concurrent : 1 { false }; ///< Shared between the graphics and compute queues without ownership transfers
     };
 
     /**
@@ -67,11 +73,23 @@ class VO_API voImage
     void Cleanup( voDeviceContext * device ) const;
 
     /**
-     * @brief Transitions the image layout.
+     * @brief Transitions the image layout to `VK_IMAGE_LAYOUT_GENERAL`, discarding its content.
+     * @details Recorded in the current batch of the upload context, see `voUploadContext::TransitionImage`.
      * @param device The Vulkan device context.
      */
     void TransitionLayout( voDeviceContext * device );
 
+    /**
+     * @brief Fills the image with texels and transitions it to its final layout.
+     * @details Recorded in the current batch of the upload context, see `voUploadContext::UploadImage`.
+     * The image must have been created with `VK_IMAGE_USAGE_TRANSFER_DST_BIT`.
+     * @param device The Vulkan device context.
+     * @param data Pointer to tightly packed texels.
+     * @param size Size of the data in bytes.
+     * @param finalLayout The layout of the image once filled.
+     */
+    void Upload( voDeviceContext * device, const void * data, VkDeviceSize size, VkImageLayout finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL );
+
     /**
      * @brief Transitions the image layout.
      * @param cmdBuffer The command buffer to use for the transition.
@@ -83,7 +101,7 @@ class VO_API voImage
 
     VkImage        vkImage { VK_NULL_HANDLE };        ///< The Vulkan image object
     VkImageView    vkImageView { VK_NULL_HANDLE };    ///< The Vulkan image view object
-    VkDeviceMemory vkDeviceMemory { VK_NULL_HANDLE }; ///< The Vulkan device memory object associated with the image
+    VmaAllocation  vmaAllocation { VK_NULL_HANDLE };  ///< The allocation backing the image
 
     VkImageLayout vkImageLayout {}; ///< The current layout of the image
 };
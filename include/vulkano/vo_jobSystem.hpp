@@ -0,0 +1,195 @@
+#ifndef VULKANO_JOBSYSTEM_H
+#define VULKANO_JOBSYSTEM_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "vo_api.hpp"
+#include "vo_common.hpp"
+
+/**
+ * @class voJobSystem
+ * @brief Work-stealing thread pool shared by the loaders, culling, command recording and uploads.
+ *
+ * @details Every thread of the system owns a deque of jobs: it pushes and pops its own jobs at the back,
+ * and steals from the front of the other deques once its own is empty, so workers stay busy without a central queue.
+ * A job runs once the jobs it depends on have completed, a handle to a job is a dependency of later jobs or can be waited on.
+ * Waiting threads do not block, they run pending jobs until the handle completes.
+ *
+ * The thread that creates the system is thread 0, the main thread, workers are threads [1, GetNumThreads()).
+ * The index of the calling thread selects its `voCommandAllocator` pools when recording command buffers.
+ * Jobs scheduled with `AFFINITY_MAIN_THREAD` only run on the main thread, when it calls `RunMainThreadJobs`
+ * (every `voDeviceContext::BeginFrame`) or waits: GLFW and other main-thread-only calls go through them.
+ *
+ * @code
+ * voJobSystem & jobs = device->m_jobSystem;
+ *
+ * // Load meshes in parallel, then create the window title once everything is loaded
+ * std::vector< voJobSystem::handle_t > loads;
+ * for( auto & model : models )
+ *     {
+ *         loads.push_back( jobs.Schedule( [&]() { model.Load( path ); } ) );
+ *     }
+ * jobs.Schedule( [&]() { window.setTitle( "Loaded" ); }, loads, voJobSystem::AFFINITY_MAIN_THREAD );
+ *
+ * // Update transforms by chunks of 256 objects, and wait for them
+ * jobs.Wait( jobs.ParallelFor( numObjects, 256, [&]( uint32_t first, uint32_t last ) { UpdateTransforms( first, last ); } ) );
+ * @endcode
+ *
+ * @see `voDeviceContext`, `voCommandAllocator`
+ */
+class VO_API voJobSystem
+{
+  public:
+    voJobSystem()  = default;
+    ~voJobSystem() = default;
+
+    voJobSystem( const voJobSystem & )             = delete;
+    voJobSystem & operator=( const voJobSystem & ) = delete;
+
+    static const uint32_t INVALID_THREAD_INDEX = UINT32_MAX;
+
+    /**
+     * @enum affinity_t
+     * @brief Threads a job is allowed to run on.
+     */
+    enum affinity_t
+    {
+        AFFINITY_ANY,
+        AFFINITY_MAIN_THREAD,
+    };
+
+    struct job_t;
+    using handle_t = std::shared_ptr< job_t >;
+
+    /**
+     * @struct CreateParms_t
+     * @brief Parameters for creating the job system.
+     */
+    struct CreateParms_t
+    {
+        uint32_t numWorkers; ///< Number of worker threads, the main thread not included
+    };
+
+    /**
+     * @brief Starts the worker threads, the calling thread becomes the main thread.
+     * @param parms The parameters for creating the job system.
+     * @return True if creation is successful, false otherwise.
+     */
+    bool Create( const CreateParms_t & parms );
+
+    /**
+     * @brief Runs the remaining jobs and joins the worker threads.
+     */
+    void Cleanup();
+
+    /* -------------------------------------- Jobs --------------------------------------------------------------------- */
+
+    /**
+     * @brief Schedules a job.
+     * @param func The work of the job.
+     * @param dependencies Jobs that have to complete before this one starts, null handles are ignored.
+     * @param affinity Threads the job may run on.
+     * @return The handle of the job.
+     */
+    handle_t Schedule( std::function< void() > && func, const std::vector< handle_t > & dependencies = {}, affinity_t affinity = AFFINITY_ANY );
+
+    /**
+     * @brief Splits an index range in chunks processed in parallel.
+     * @param count Number of indices, [0, count) is processed.
+     * @param grainSize Number of indices of a chunk.
+     * @param func Called with the [first, last) range of every chunk.
+     * @param dependencies Jobs that have to complete before any chunk starts.
+     * @return A handle completing once every chunk has been processed.
+     */
+    handle_t ParallelFor( uint32_t count, uint32_t grainSize, std::function< void( uint32_t, uint32_t ) > && func, const std::vector< handle_t > & dependencies = {} );
+
+    /**
+     * @brief Runs pending jobs until a job has completed.
+     * @param job The job to wait for, a null handle returns immediately.
+     */
+    void Wait( const handle_t & job );
+
+    /** @brief Check if a job has completed */
+    [[nodiscard]] static bool IsComplete( const handle_t & job );
+
+    /**
+     * @brief Runs the jobs scheduled with the main thread affinity, must be called from the main thread.
+     */
+    void RunMainThreadJobs();
+
+    /** @brief Get the number of threads running jobs, the main thread included */
+    [[nodiscard]] uint32_t GetNumThreads() const;
+
+    /** @brief Get the index of the calling thread, or INVALID_THREAD_INDEX for threads outside of the system */
+    [[nodiscard]] static uint32_t GetThreadIndex();
+
+    /**
+     * @struct job_t
+     * @brief A scheduled job, completed once it has run.
+     */
+    struct job_t
+    {
+        std::function< void() > func;
+        affinity_t              affinity { AFFINITY_ANY };
+        std::atomic< uint32_t > numPending { 1 }; ///< Dependencies still running, plus one while scheduling
+        std::atomic< bool >     done { false };
+        std::mutex              mutex;
+        std::vector< handle_t > continuations {}; ///< Jobs waiting for this one
+    };
+
+  private:
+    /**
+     * @struct thread_queue_t
+     * @brief The deque of a thread, the back is used by its owner and the front by thieves.
+     */
+    struct thread_queue_t
+    {
+        std::mutex             mutex;
+        std::deque< handle_t > jobs {};
+    };
+
+    void Enqueue( const handle_t & job );
+    void Release( const handle_t & job );
+    void Execute( const handle_t & job );
+    bool RunOneJob( uint32_t threadIndex );
+    bool RunOneMainThreadJob();
+    void WorkerLoop( uint32_t threadIndex );
+
+    /* -------------------------------------- Handlers ----------------------------------------------------------------- */
+
+    std::vector< std::thread >          m_workers {};
+    std::unique_ptr< thread_queue_t[] > m_queues {}; ///< One per thread, the main thread included
+    uint32_t                            m_numThreads { 0 };
+
+    std::mutex             m_mainMutex;
+    std::deque< handle_t > m_mainJobs {};
+
+    std::mutex              m_sleepMutex;
+    std::condition_variable m_wakeup;
+    std::atomic< uint32_t > m_numQueued { 0 };
+    bool                    m_stop { false };
+};
+
+// ======================================================================================================================
+// ============================================ Inline ==================================================================
+// ======================================================================================================================
+
+FORCE_INLINE bool
+voJobSystem::IsComplete( const handle_t & job )
+{
+    return job == nullptr || job->done.load( std::memory_order_acquire );
+}
+
+FORCE_INLINE uint32_t
+voJobSystem::GetNumThreads() const
+{
+    return m_numThreads;
+}
+
+#endif //VULKANO_JOBSYSTEM_H
@@ -0,0 +1,76 @@
+#ifndef VULKANO_LAYOUTCACHE_H
+#define VULKANO_LAYOUTCACHE_H
+
+#include <map>
+#include <mutex>
+#include <vector>
+#include "vo_api.hpp"
+#include "vo_common.hpp"
+
+class voDeviceContext;
+
+/**
+ * @class voLayoutCache
+ * @brief Descriptor set layouts and pipeline layouts of the device, created once for every distinct description.
+ *
+ * @details Layouts are looked up by their description: `voDescriptors` and `voPipeline` asking for the same bindings,
+ * set layouts and push constant ranges get the same handle. Pipelines sharing a pipeline layout are compatible
+ * for every set, so switching between them keeps the bound descriptor sets and push constants.
+ *
+ * The cache owns its layouts, they live as long as the device and are never destroyed by the objects using them.
+ * Immutable samplers are not part of the description and are not supported.
+ *
+ * @code
+ * std::vector< VkDescriptorSetLayoutBinding > bindings = { { .binding = 0, .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+ *                                                            .descriptorCount = 1, .stageFlags = VK_SHADER_STAGE_VERTEX_BIT } };
+ *
+ * VkDescriptorSetLayout setLayout      = device->m_layoutCache.GetSetLayout( device, bindings );
+ * VkPipelineLayout      pipelineLayout = device->m_layoutCache.GetPipelineLayout( device, { setLayout }, {} );
+ * @endcode
+ *
+ * @see `voShader`, `voDescriptors`, `voPipeline`
+ */
+class VO_API voLayoutCache
+{
+  public:
+    voLayoutCache()  = default;
+    ~voLayoutCache() = default;
+
+    voLayoutCache( const voLayoutCache & )             = delete;
+    voLayoutCache & operator=( const voLayoutCache & ) = delete;
+
+    /**
+     * @brief Gets the descriptor set layout of the bindings, thread safe.
+     * @param device The device context.
+     * @param bindings The bindings of the layout, in any order.
+     * @param flags The creation flags of the layout.
+     * @return The layout, owned by the cache.
+     */
+    VkDescriptorSetLayout GetSetLayout( voDeviceContext * device, const std::vector< VkDescriptorSetLayoutBinding > & bindings,
+                                        VkDescriptorSetLayoutCreateFlags flags = 0 );
+
+    /**
+     * @brief Gets the pipeline layout of the sets and push constant ranges, thread safe.
+     * @param device The device context.
+     * @param setLayouts The set layouts, by set index.
+     * @param pushConstants The push constant ranges.
+     * @return The layout, owned by the cache.
+     */
+    VkPipelineLayout GetPipelineLayout( voDeviceContext * device, const std::vector< VkDescriptorSetLayout > & setLayouts,
+                                        const std::vector< VkPushConstantRange > & pushConstants );
+
+    /**
+     * @brief Destroys every layout, no pipeline or descriptor set may use them anymore.
+     * @param device The device context.
+     */
+    void Cleanup( voDeviceContext * device );
+
+  private:
+    using key_t = std::vector< uint64_t >;
+
+    std::map< key_t, VkDescriptorSetLayout > m_setLayouts {};
+    std::map< key_t, VkPipelineLayout >      m_pipelineLayouts {};
+    std::mutex                               m_mutex;
+};
+
+#endif //VULKANO_LAYOUTCACHE_H
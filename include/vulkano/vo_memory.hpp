@@ -3,7 +3,9 @@
 
 #include <vulkan/vulkan.h>
 #include <mutex>
+#include <string>
 #include <unordered_map>
+#include "vo_api.hpp"
 
 #define VMA_STATIC_VULKAN_FUNCTIONS 0
 #define VMA_DYNAMIC_VULKAN_FUNCTIONS 1
@@ -19,9 +21,65 @@ struct VoMemoryCreateInfo
     bool enableHeapBudget  = false;
 };
 
-class voMemory
+/**
+ * @class voMemory
+ * @brief Device memory allocator built on top of VMA.
+ *
+ * @details A single voMemory is owned by `voDeviceContext` and every buffer and image of the library is sub-allocated
+ * from it, instead of issuing one `vkAllocateMemory` per resource.
+ * Allocations are routed by usage class into custom pools (one per class and memory type), so resources with similar
+ * lifetimes share blocks: long-lived geometry, per-frame transient data (linear algorithm) and render targets.
+ * Large or frequently recreated resources can request a dedicated `VkDeviceMemory` instead.
+ *
+ * @code
+ * voMemory::AllocationParms_t allocParms =
+ * {
+ *     .memoryClass = voMemory::MEMORY_CLASS_GEOMETRY,
+ * };
+ *
+ * VkBuffer      buffer;
+ * VmaAllocation allocation;
+ * device->m_memory->CreateBuffer( bufferInfo, allocParms, buffer, allocation );
+ *
+ * // ...
+ *
+ * device->m_memory->DestroyBuffer( buffer, allocation );
+ * @endcode
+ *
+ * @see `voDeviceContext`, `voBuffer`, `voImage`
+ */
+class VO_API voMemory
 {
   public:
+    /**
+     * @enum MemoryClass_t
+     * @brief Usage classes, each one is served by its own set of pools
+     */
+    enum MemoryClass_t
+    {
+        MEMORY_CLASS_DEFAULT = 0,   ///< General purpose, allocated straight from the default VMA pools
+        MEMORY_CLASS_GEOMETRY,      ///< Long-lived vertex and index data
+        MEMORY_CLASS_FRAME_LINEAR,  ///< Per-frame transient data, served by a linear allocator
+        MEMORY_CLASS_RENDER_TARGET, ///< Attachments and images written by the GPU
+
+        MEMORY_CLASS_NUM
+    };
+
+    /**
+     * @struct AllocationParms_t
+     * @brief Describes where and how a resource should be allocated
+     */
+    struct AllocationParms_t
+    {
+        MemoryClass_t            memoryClass { MEMORY_CLASS_DEFAULT }; ///< Usage class (selects the pool)
+        VmaMemoryUsage           usage { VMA_MEMORY_USAGE_AUTO };      ///< VMA usage hint
+        VmaAllocationCreateFlags flags { 0 };                          ///< Additional VMA allocation flags
+        VkMemoryPropertyFlags    requiredFlags { 0 };                  ///< Memory properties that must be present
+        VkMemoryPropertyFlags    preferredFlags { 0 };                 ///< Memory properties that should be present
+        bool                     dedicated { false };                  ///< Give the resource its own `VkDeviceMemory`
+        const char *             debugName { nullptr };                ///< Optional name, used for leak reports
+    };
+
     // Main interface
     static voMemory * Create( const VoMemoryCreateInfo & createInfo );
     void Destroy();
@@ -34,6 +92,18 @@ class voMemory
         VmaAllocation & allocation,
         VmaAllocationInfo * allocationInfo = nullptr );
 
+    /**
+     * @brief Creates a buffer and sub-allocates its memory from the pool of the requested usage class
+     *
+     * @details Falls back to the default pools when the class pool cannot hold the allocation.
+     */
+    VkResult CreateBuffer(
+        const VkBufferCreateInfo & bufferInfo,
+        const AllocationParms_t & parms,
+        VkBuffer & buffer,
+        VmaAllocation & allocation,
+        VmaAllocationInfo * allocationInfo = nullptr );
+
     // Image allocation
     VkResult CreateImage(
         const VkImageCreateInfo & imageInfo,
@@ -42,12 +112,30 @@ class voMemory
         VmaAllocation & allocation,
         VmaAllocationInfo * allocationInfo = nullptr );
 
+    /**
+     * @brief Creates an image and sub-allocates its memory from the pool of the requested usage class
+     *
+     * @details Falls back to the default pools when the class pool cannot hold the allocation.
+     */
+    VkResult CreateImage(
+        const VkImageCreateInfo & imageInfo,
+        const AllocationParms_t & parms,
+        VkImage & image,
+        VmaAllocation & allocation,
+        VmaAllocationInfo * allocationInfo = nullptr );
+
     // Memory management
     void DestroyBuffer( VkBuffer buffer, VmaAllocation allocation );
     void DestroyImage( VkImage image, VmaAllocation allocation );
     VkResult MapMemory( VmaAllocation allocation, void ** data );
     void UnmapMemory( VmaAllocation allocation );
 
+    /** @brief Flush a host written range of a non-coherent allocation, no-op on coherent memory */
+    VkResult FlushMemory( VmaAllocation allocation, VkDeviceSize offset, VkDeviceSize size );
+
+    /** @brief Get the property flags of the memory type an allocation ended up in */
+    VkMemoryPropertyFlags GetMemoryProperties( VmaAllocation allocation ) const;
+
     // Memory pools
     VkResult CreatePool( const VmaPoolCreateInfo & createInfo, VmaPool & pool );
     void DestroyPool( VmaPool pool );
@@ -74,6 +162,12 @@ class voMemory
   private:
     voMemory() = default;
 
+    /** @brief Translate allocation parameters into a VMA allocation description */
+    static VmaAllocationCreateInfo MakeAllocationInfo( const AllocationParms_t & parms );
+
+    /** @brief Get (or lazily create) the pool serving a usage class for the given memory type */
+    VmaPool GetPool( MemoryClass_t memoryClass, uint32_t memoryTypeIndex );
+
     VmaAllocator m_allocator = nullptr;
     bool m_enableStatsString = false;
     bool m_enableHeapBudget  = false;
@@ -88,6 +182,10 @@ class voMemory
 
     std::mutex m_allocationMutex;
     std::unordered_map< VmaAllocation, AllocationInfo > m_allocations;
+
+    // Usage class pools, keyed by ( class << 32 ) | memoryTypeIndex
+    std::mutex m_poolMutex;
+    std::unordered_map< uint64_t, VmaPool > m_pools;
 };
 
 #endif /** VULKANO_MEMORY_HPP */
@@ -4,11 +4,13 @@
 #include "vo_api.hpp"
 #include "vo_deviceContext.hpp"
 #include "vo_descriptor.hpp"
+#include "vo_pipelineRegistry.hpp"
 #include <vulkan/vulkan_core.h>
 #include <cstring>
 
 class voFrameBuffer;
 class voShader;
+class voBindless;
 
 /**
  * @class voPipeline
@@ -37,7 +39,29 @@ class voShader;
  * pipeline.Cleanup(&deviceContext);
  * @endcode
  *
- * @see `voFrameBuffer`, `voDescriptors`, `voShader`, `voDescriptor`
+ * Pipeline layouts come from the layout cache of the device, pipelines with the same descriptor set layouts and push constants
+ * share theirs and switching between them keeps the bound sets. Only the vertex attributes read by the shader are fetched.
+ * Pipelines with the same shaders and state share one `VkPipeline` through the pipeline registry of the device, compiled once.
+ *
+ * Pipelines created with `async` are compiled by the job system and `Create` returns at once: until the pipeline is ready
+ * `BindPipeline` binds the fallback pipeline, or binds nothing and returns false so the draw is skipped. The compile reads
+ * the shader modules: `voShader::Cleanup` waits for it, the shader may be cleaned up right after `Create`.
+ * `WarmUp` compiles the pipelines recorded in the manifest of the previous run, before they are created.
+ * A pipeline belongs to one thread at a time: binding it picks up the compiled pipeline and is not synchronized, so a pipeline
+ * created on one thread is handed over to the recording thread, by the render list for instance, before it is bound.
+ *
+ * On devices supporting VK_EXT_graphics_pipeline_library with fast linking, graphics pipelines are linked from four parts
+ * compiled apart: the vertex input, the pre-rasterization shaders, the fragment shader and the fragment output. Parts are
+ * cached in the pipeline registry and shared by the pipelines having the same state for them, so a new material only
+ * compiles its shaders. The quickly linked pipeline is used at once, and replaced by a pipeline linked with link time
+ * optimization in the background, picked up by `BindPipeline`.
+ *
+ * Pipelines created with `dynamicState`, on devices supporting VK_EXT_extended_dynamic_state, leave the cull mode,
+ * front face, topology and depth state out of the pipeline, along with depth bias enable when VK_EXT_extended_dynamic_state2
+ * is supported. `BindPipeline` sets the states of the parameters, and `SetRenderState` changes them between draws, so one
+ * compiled pipeline serves every combination. Topologies stay within the class the pipeline was created with (triangles).
+ *
+ * @see `voFrameBuffer`, `voDescriptors`, `voShader`, `voDescriptor`, `voLayoutCache`, `voPipelineRegistry`
  */
 class VO_API voPipeline
 {
@@ -52,6 +76,22 @@ public:
         CULL_MODE_NONE
     };
 
+    /**
+     * @struct render_state_t
+     * @brief The states of a pipeline created with `dynamicState`, set when recording.
+     */
+    struct render_state_t
+    {
+        CullMode_t          cullMode { CULL_MODE_NONE };
+        VkFrontFace         frontFace { VK_FRONT_FACE_COUNTER_CLOCKWISE };
+        VkPrimitiveTopology topology { VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST };
+        VkCompareOp         depthCompareOp { VK_COMPARE_OP_LESS };
+
+        uint8_t depthTest  : 1 { false };
+        uint8_t depthWrite : 1 { false };
+        uint8_t depthBias  : 1 { false }; ///< Needs VK_EXT_extended_dynamic_state2, ignored otherwise
+    };
+
     /**
     * @struct CreateParms_t
     *
@@ -72,10 +112,17 @@ public:
 
         uint8_t depthTest  : 1 { false };
         uint8_t depthWrite : 1 { false };
+        uint8_t depthBias  : 1 { false }; ///< Bias values are set when recording, with `vkCmdSetDepthBias`
 
-        uint32_t pushConstantSize { 0 };
+        uint32_t pushConstantSize { 0 }; ///< Zero takes the push constants reflected from the shader, if any
         VkShaderStageFlagBits pushConstantShaderStages { };
 
+        voBindless * bindless { nullptr }; ///< Adds the global bindless set to the layout, at `voBindless::SET_INDEX`
+
+        uint8_t async : 1 { false };        ///< Compiled by the job system, `IsReady` tells when it can be bound
+        uint8_t dynamicState : 1 { false }; ///< Cull mode, front face, topology and depth state set when recording, if supported
+        voPipeline * fallback { nullptr }; ///< Bound while compiling, with the same descriptor set layouts, and dynamic state if this one has it
+
         FORCE_INLINE void Reset() { memset( this, 0, sizeof( CreateParms_t ) ); }
     };
 
@@ -103,6 +150,25 @@ public:
      */
     VO_API void Cleanup( voDeviceContext * device );
 
+    /**
+     * @brief Compiles in parallel the pipelines recorded in the warm-up manifest by the previous run.
+     *
+     * @details Only pipelines rebuilt from plain data are recorded: named shaders, descriptors described by their bindings,
+     * and for graphics pipelines the render pass of the swapchain. Called by `voDeviceContext::CreateSwapChain`.
+     * The pipelines are shared with the pipelines created later on with the same state, instead of compiled again.
+     *
+     * @param device The Vulkan device context.
+     */
+    VO_API static void WarmUp( voDeviceContext * device );
+
+    /**
+     * @brief Check if the pipeline is compiled, picking it up once its compile job has completed.
+     * @details Updates the pipeline: like `BindPipeline`, only call it from the thread recording with the pipeline.
+     * @return True if the pipeline can be bound.
+     */
+    [[nodiscard]]
+    VO_API bool IsReady();
+
     /* ====================================== Getters ================================================================== */
 
     /**
@@ -115,16 +181,33 @@ public:
     /* ====================================== Bindings ================================================================= */
 
     /**
-     * @brief Binds the pipeline to a command buffer.
+     * @brief Binds the pipeline to a command buffer, or its fallback while it is compiling.
      * @param cmdBuffer The command buffer to bind the pipeline to.
+     * @return False if nothing was bound, the draw is to be skipped.
      */
-     VO_API void BindPipeline( VkCommandBuffer cmdBuffer ) const;
+     VO_API bool BindPipeline( VkCommandBuffer cmdBuffer );
 
     /**
-     * @brief Binds the compute pipeline to a command buffer.
+     * @brief Binds the compute pipeline to a command buffer, or its fallback while it is compiling.
      * @param cmdBuffer The command buffer to bind the compute pipeline to.
+     * @return False if nothing was bound, the dispatch is to be skipped.
      */
-    VO_API void BindPipelineCompute( VkCommandBuffer cmdBuffer ) const;
+    VO_API bool BindPipelineCompute( VkCommandBuffer cmdBuffer );
+
+    /**
+     * @brief Sets the states of a pipeline created with dynamic state, after it has been bound.
+     * @param cmdBuffer The command buffer the pipeline is bound to.
+     * @param state The states of the next draws.
+     */
+    VO_API void SetRenderState( VkCommandBuffer cmdBuffer, const render_state_t & state ) const;
+
+    /** @brief Get the states of the creation parameters, set by `BindPipeline` */
+    [[nodiscard]]
+    VO_API render_state_t GetRenderState() const;
+
+    /** @brief Check if the states of `render_state_t` are set when recording, instead of compiled into the pipeline */
+    [[nodiscard]]
+    VO_API bool HasDynamicState() const;
 
     /**
      * @brief Dispatches compute commands to the command buffer.
@@ -139,8 +222,26 @@ public:
 
     CreateParms_t m_parms { };
 
-    VkPipelineLayout vkPipelineLayout { VK_NULL_HANDLE };
-    VkPipeline       vkPipeline       { VK_NULL_HANDLE };
+    VkPipelineLayout    vkPipelineLayout { VK_NULL_HANDLE };
+    VkPipeline          vkPipeline       { VK_NULL_HANDLE };
+    VkPipelineBindPoint vkBindPoint      { VK_PIPELINE_BIND_POINT_GRAPHICS };
+
+private:
+    /**
+     * @brief Gets the pipeline of the key from the registry, compiled now or by the job system, then optimized if given.
+     */
+    void Acquire( voDeviceContext * device, const voPipelineRegistry::compile_t & compile, const voPipelineRegistry::compile_t & optimize = nullptr,
+                  const std::vector< voJobSystem::handle_t > & dependencies = {} );
+
+    /**
+     * @brief Gets the pipeline to bind: this one once compiled, else the fallback if compiled, else nullptr.
+     */
+    voPipeline * GetBindable();
+
+    voDeviceContext *         m_device     { nullptr };
+    bool                      m_dynamicState { false }; ///< Created with dynamic state, on a device supporting it
+    voPipelineRegistry::key_t m_key        { };  ///< Registry key of the pipeline, empty until created
+    voJobSystem::handle_t     m_compileJob { };  ///< Compile of an asynchronous pipeline, or optimization of a linked one, until picked up
 };
 
 
@@ -151,9 +252,13 @@ public:
 FORCE_INLINE void
 voPipeline::Cleanup( voDeviceContext * device )
 {
-    vkDestroyPipeline( device->deviceInfo.logical, vkPipeline, nullptr );
-    vkDestroyPipelineLayout( device->deviceInfo.logical, vkPipelineLayout, nullptr );
+    // The layout belongs to the layout cache of the device, the pipeline may be shared with other pipelines of the same state
+    if( !m_key.empty() )
+        {
+            device->m_pipelineRegistry.Release( device, m_key );
+        }
 
+    m_key.clear(); m_compileJob = nullptr;
     vkPipeline = VK_NULL_HANDLE; vkPipelineLayout = VK_NULL_HANDLE;
 }
 
@@ -163,16 +268,80 @@ voPipeline::GetFreeDescriptor() const
     return m_parms.descriptors->GetFreeDescriptor();
 }
 
-FORCE_INLINE void
-voPipeline::BindPipeline( VkCommandBuffer cmdBuffer ) const
+FORCE_INLINE bool
+voPipeline::IsReady()
 {
-    vkCmdBindPipeline( cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, vkPipeline );
+    // The compiled pipeline, then the optimized one replacing a quickly linked pipeline. Reloaded under the registry lock
+    // until final: the replaced pipeline is queued for deletion before the optimization job completes
+    if( ( vkPipeline == VK_NULL_HANDLE || m_compileJob != nullptr ) && !m_key.empty() )
+        {
+            vkPipeline = m_device->m_pipelineRegistry.Get( m_key, &m_compileJob );
+        }
+
+    return vkPipeline != VK_NULL_HANDLE;
 }
 
-FORCE_INLINE void
-voPipeline::BindPipelineCompute( VkCommandBuffer cmdBuffer ) const
+FORCE_INLINE voPipeline *
+voPipeline::GetBindable()
+{
+    if( IsReady() )
+        {
+            return this;
+        }
+
+    // Still compiling
+    return m_parms.fallback != nullptr && m_parms.fallback->IsReady() ? m_parms.fallback : nullptr;
+}
+
+FORCE_INLINE bool
+voPipeline::BindPipeline( VkCommandBuffer cmdBuffer )
+{
+    const voPipeline * pipeline = GetBindable();
+    if( pipeline == nullptr )
+        {
+            return false;
+        }
+
+    vkCmdBindPipeline( cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline->vkPipeline );
+
+    // The fallback is drawn with the states of this pipeline
+    if( pipeline->m_dynamicState )
+        {
+            pipeline->SetRenderState( cmdBuffer, GetRenderState() );
+        }
+
+    return true;
+}
+
+FORCE_INLINE bool
+voPipeline::BindPipelineCompute( VkCommandBuffer cmdBuffer )
+{
+    const voPipeline * pipeline = GetBindable();
+    if( pipeline == nullptr )
+        {
+            return false;
+        }
+
+    vkCmdBindPipeline( cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline->vkPipeline );
+    return true;
+}
+
+FORCE_INLINE voPipeline::render_state_t
+voPipeline::GetRenderState() const
+{
+    render_state_t state {};
+    state.cullMode   = m_parms.cullMode;
+    state.depthTest  = m_parms.depthTest;
+    state.depthWrite = m_parms.depthWrite;
+    state.depthBias  = m_parms.depthBias;
+
+    return state;
+}
+
+FORCE_INLINE bool
+voPipeline::HasDynamicState() const
 {
-    vkCmdBindPipeline( cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, vkPipeline );
+    return m_dynamicState;
 }
 
 FORCE_INLINE void
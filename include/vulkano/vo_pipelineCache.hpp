@@ -0,0 +1,97 @@
+#ifndef VULKANO_PIPELINECACHE_H
+#define VULKANO_PIPELINECACHE_H
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include "vo_api.hpp"
+#include "vo_common.hpp"
+#include "vo_jobSystem.hpp"
+
+class voDeviceContext;
+
+/**
+ * @class voPipelineCache
+ * @brief The `VkPipelineCache` every pipeline is created with, kept on disk between runs.
+ *
+ * @details The cache file is loaded when the device is created. It is only used if its header matches the device:
+ * same header version, vendor, device and `pipelineCacheUUID`. Otherwise the driver would ignore it or the data would be
+ * stale, and the cache starts empty. Pipelines compiled by a previous run are then taken from the cache instead of
+ * being compiled again.
+ *
+ * The cache is saved on cleanup, and periodically by a job whenever it has grown since the last save.
+ * Saving writes a temporary file that is then renamed over the cache file, so a crash never leaves a truncated cache.
+ *
+ * @code
+ * VK_CHECK( vkCreateGraphicsPipelines( device->deviceInfo.logical, device->m_pipelineCache.vkPipelineCache, 1, &pipelineInfo, nullptr, &vkPipeline ),
+ *           "Failed to create pipeline" );
+ * @endcode
+ *
+ * @see `voDeviceContext`, `voPipeline`
+ */
+class VO_API voPipelineCache
+{
+  public:
+    voPipelineCache()  = default;
+    ~voPipelineCache() = default;
+
+    voPipelineCache( const voPipelineCache & )             = delete;
+    voPipelineCache & operator=( const voPipelineCache & ) = delete;
+
+    /**
+     * @struct CreateParms_t
+     * @brief Parameters for creating the pipeline cache.
+     */
+    struct CreateParms_t
+    {
+        const char * fileName;     ///< Relative to the application directory
+        uint32_t     saveInterval; ///< Seconds between periodic saves, zero only saves on cleanup
+    };
+
+    /**
+     * @brief Creates the cache, with the data of the cache file when it matches the device.
+     * @param device The device context.
+     * @param parms The parameters for creating the cache.
+     * @return True if creation is successful, false otherwise.
+     */
+    bool Create( voDeviceContext * device, const CreateParms_t & parms );
+
+    /**
+     * @brief Saves and destroys the cache, no job may be saving it anymore.
+     * @param device The device context.
+     */
+    void Cleanup( voDeviceContext * device );
+
+    /**
+     * @brief Writes the cache to its file, thread safe.
+     * @param device The device context.
+     * @return True if the file was written, false otherwise.
+     */
+    bool Save( voDeviceContext * device );
+
+    /**
+     * @brief Schedules a save once the interval has elapsed and the cache has grown, called by `voDeviceContext::BeginFrame`.
+     * @param device The device context.
+     */
+    void Update( voDeviceContext * device );
+
+    /* -------------------------------------- Handlers ----------------------------------------------------------------- */
+
+    VkPipelineCache vkPipelineCache { VK_NULL_HANDLE };
+
+  private:
+    /**
+     * @brief Check if cache data was written by the same driver for the same device.
+     */
+    [[nodiscard]] static bool IsCompatible( voDeviceContext * device, const uint8_t * data, size_t size );
+
+    std::string                           m_fileName {};
+    std::chrono::seconds                  m_saveInterval { 0 };
+    std::chrono::steady_clock::time_point m_lastSave {};
+    std::atomic< size_t >                 m_savedSize { 0 }; ///< Size of the data in the file, the cache only grows
+    voJobSystem::handle_t                 m_saveJob {};
+    std::mutex                            m_saveMutex;
+};
+
+#endif //VULKANO_PIPELINECACHE_H
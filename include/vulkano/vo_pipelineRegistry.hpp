@@ -0,0 +1,232 @@
+#ifndef VULKANO_PIPELINEREGISTRY_H
+#define VULKANO_PIPELINEREGISTRY_H
+
+#include <functional>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+#include "vo_api.hpp"
+#include "vo_common.hpp"
+#include "vo_jobSystem.hpp"
+
+class voDeviceContext;
+
+/**
+ * @class voPipelineRegistry
+ * @brief The pipelines of the device, compiled once for every distinct state and shared by reference count.
+ *
+ * @details `voPipeline` describes everything its `VkPipeline` is built from in a key: the hashes of the shader modules,
+ * the vertex layout, the render pass and subpass, the fixed function state, the dynamic states and the pipeline layout,
+ * which stands for the descriptor set layouts and push constant ranges. Pipelines with the same key share one `VkPipeline`,
+ * which is only compiled the first time. It is destroyed once its last user releases it and the frames in flight are done
+ * with it.
+ *
+ * Pipelines are compiled by the job system. `Acquire` either waits for the compile, the calling thread helping with the jobs,
+ * or returns at once with the job to test, the pipeline being available from `Get` once the job has completed.
+ *
+ * A compile may come with an optimization: the pipeline compiled first is usable at once, while the optimization runs
+ * in the background and replaces it. `Get` then gives the optimization job as well, to pick up the optimized pipeline once it
+ * has completed, and the pipeline compiled first is destroyed once the frames in flight are done with it.
+ * `voPipeline` quickly links the graphics pipeline libraries this way, then links them again with link time optimization.
+ *
+ * The registry also keeps the warm-up manifest: a recipe for every pipeline `voPipeline` was able to describe this run,
+ * saved on cleanup and loaded back on the next run so `voPipeline::WarmUp` compiles them in parallel at startup.
+ * Warmed up pipelines stay in the registry without users, until they are acquired.
+ *
+ * Render passes are told apart by handle, two compatible render passes created apart still compile their own pipelines.
+ * Hits and compiles are counted, and the hit rate is logged on cleanup.
+ *
+ * @code
+ * voPipelineRegistry::key_t key = { VK_PIPELINE_BIND_POINT_COMPUTE, shaderHash, reinterpret_cast< uint64_t >( vkPipelineLayout ) };
+ *
+ * voJobSystem::handle_t job;
+ * device->m_pipelineRegistry.Acquire( device, key, [=]() { return CompilePipeline(); }, &job );
+ * ...
+ * if( voJobSystem::IsComplete( job ) )
+ *     {
+ *         VkPipeline vkPipeline = device->m_pipelineRegistry.Get( key );
+ *     }
+ * ...
+ * device->m_pipelineRegistry.Release( device, key );
+ * @endcode
+ *
+ * @see `voPipeline`, `voPipelineCache`, `voLayoutCache`
+ */
+class VO_API voPipelineRegistry
+{
+  public:
+    voPipelineRegistry()  = default;
+    ~voPipelineRegistry() = default;
+
+    voPipelineRegistry( const voPipelineRegistry & )             = delete;
+    voPipelineRegistry & operator=( const voPipelineRegistry & ) = delete;
+
+    using key_t     = std::vector< uint64_t >;
+    using compile_t = std::function< VkPipeline() >;
+
+    /**
+     * @struct CreateParms_t
+     * @brief Parameters for creating the pipeline registry.
+     */
+    struct CreateParms_t
+    {
+        const char * manifestFileName; ///< Warm-up manifest, relative to the application directory
+    };
+
+    /**
+     * @struct stats_t
+     * @brief How often the registry avoided a compile.
+     */
+    struct stats_t
+    {
+        uint64_t hits { 0 };         ///< Pipelines acquired without compiling
+        uint64_t compiles { 0 };     ///< Pipelines compiled, warm-up included
+        uint32_t numPipelines { 0 }; ///< Pipelines alive or compiling
+
+        /** @brief Share of the acquisitions that did not compile, in [0, 1] */
+        [[nodiscard]] double GetHitRate() const;
+    };
+
+    /**
+     * @brief Loads the warm-up manifest of the previous run.
+     * @param device The device context.
+     * @param parms The parameters for creating the registry.
+     * @return True if creation is successful, false otherwise.
+     */
+    bool Create( voDeviceContext * device, const CreateParms_t & parms );
+
+    /**
+     * @brief Saves the warm-up manifest, destroys the pipelines still referenced and logs the statistics.
+     * @details The job system must be done compiling.
+     * @param device The device context.
+     */
+    void Cleanup( voDeviceContext * device );
+
+    /**
+     * @brief Gets the pipeline of a state, compiled if no pipeline has it yet, thread safe.
+     *
+     * @param device The device context.
+     * @param key Everything the pipeline is built from.
+     * @param compile Compiles the pipeline on a miss, run by the job system: it must own what it reads.
+     * @param job Without a job the call waits for the compile. Otherwise it is set to the compile job, to the optimization job
+     *            while the pipeline compiled first is returned, or to null once the pipeline is final.
+     * @param optimize Compiles the pipeline again in the background once compiled, replacing it. Optional.
+     * @param dependencies Jobs the compile starts after on a miss, such as the `Prepare` jobs of what it links.
+     * @return The shared pipeline, or VK_NULL_HANDLE while it is being compiled. Released by key.
+     */
+    VkPipeline Acquire( voDeviceContext * device, const key_t & key, const compile_t & compile, voJobSystem::handle_t * job = nullptr,
+                        const compile_t & optimize = nullptr, const std::vector< voJobSystem::handle_t > & dependencies = {} );
+
+    /**
+     * @brief Compiles a pipeline without acquiring it, kept until it is acquired or the registry is cleaned up.
+     * @param device The device context.
+     * @param key Everything the pipeline is built from.
+     * @param compile Compiles the pipeline, if it is not compiled already.
+     * @return The compile job, null if the pipeline is already compiled.
+     */
+    voJobSystem::handle_t Prepare( voDeviceContext * device, const key_t & key, const compile_t & compile );
+
+    /** @brief Check if a pipeline is compiled or compiling, thread safe */
+    [[nodiscard]] bool Contains( const key_t & key ) const;
+
+    /**
+     * @brief Gets an acquired pipeline, thread safe.
+     * @param key The key the pipeline was acquired with.
+     * @param job Optional, set to the compile or optimization job until the final pipeline is returned, then to null.
+     * @return The pipeline, or VK_NULL_HANDLE while it is being compiled.
+     */
+    [[nodiscard]] VkPipeline Get( const key_t & key, voJobSystem::handle_t * job = nullptr ) const;
+
+    /**
+     * @brief Drops a reference, the last one destroys the pipeline once the frame being recorded has been executed.
+     * @details A pipeline still compiling is destroyed once compiled.
+     * @param device The device context.
+     * @param key The key the pipeline was acquired with.
+     */
+    void Release( voDeviceContext * device, const key_t & key );
+
+    /**
+     * @brief Adds a recipe to the warm-up manifest saved on cleanup, thread safe.
+     * @param recipe Whatever rebuilds the pipeline on the next run, on a single line.
+     */
+    void Record( const std::string & recipe );
+
+    /** @brief Get the recipes recorded by the previous run */
+    [[nodiscard]] const std::vector< std::string > & GetManifest() const;
+
+    /** @brief Get the statistics of the registry */
+    [[nodiscard]] stats_t GetStats() const;
+
+  private:
+    /**
+     * @struct entry_t
+     * @brief A pipeline, compiled or compiling, and its number of users.
+     */
+    struct entry_t
+    {
+        VkPipeline            vkPipeline { VK_NULL_HANDLE }; ///< Null while compiling
+        voJobSystem::handle_t job {};                        ///< Compile job, then optimization job, until it has completed
+        uint32_t              refCount { 0 };
+        bool                  resident { false };   ///< Warmed up, kept without users until acquired
+        bool                  optimizing { false }; ///< The pipeline compiled first, until the optimized one replaces it
+    };
+
+    /**
+     * @brief Schedules the compile of a new entry, then its optimization if any, the lock must be held.
+     */
+    voJobSystem::handle_t Compile( voDeviceContext * device, const key_t & key, const compile_t & compile, const compile_t & optimize = nullptr,
+                                   const std::vector< voJobSystem::handle_t > & dependencies = {} );
+
+    /**
+     * @brief Schedules the optimization of a compiled entry, the lock must be held.
+     */
+    voJobSystem::handle_t Optimize( voDeviceContext * device, const key_t & key, const compile_t & optimize );
+
+    /**
+     * @brief Destroys an entry without users once the frames in flight are done with it, the lock must be held.
+     */
+    void Erase( voDeviceContext * device, std::map< key_t, entry_t >::iterator entry );
+
+    std::map< key_t, entry_t > m_pipelines {};
+    stats_t                    m_stats {};
+    mutable std::mutex         m_mutex;
+
+    std::string                m_manifestFileName {};
+    std::vector< std::string > m_manifest {}; ///< Loaded from the previous run
+    std::set< std::string >    m_recipes {};  ///< Recorded this run
+};
+
+// ======================================================================================================================
+// ============================================ Inline ==================================================================
+// ======================================================================================================================
+
+FORCE_INLINE double
+voPipelineRegistry::stats_t::GetHitRate() const
+{
+    const uint64_t total = hits + compiles;
+    return total > 0 ? static_cast< double >( hits ) / static_cast< double >( total ) : 0.0;
+}
+
+FORCE_INLINE const std::vector< std::string > &
+voPipelineRegistry::GetManifest() const
+{
+    return m_manifest;
+}
+
+FORCE_INLINE bool
+voPipelineRegistry::Contains( const key_t & key ) const
+{
+    std::lock_guard< std::mutex > lock( m_mutex );
+    return m_pipelines.find( key ) != m_pipelines.end();
+}
+
+FORCE_INLINE voPipelineRegistry::stats_t
+voPipelineRegistry::GetStats() const
+{
+    std::lock_guard< std::mutex > lock( m_mutex );
+    return m_stats;
+}
+
+#endif //VULKANO_PIPELINEREGISTRY_H
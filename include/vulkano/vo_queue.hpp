@@ -0,0 +1,205 @@
+#ifndef VULKANO_QUEUE_H
+#define VULKANO_QUEUE_H
+
+#include <deque>
+#include <mutex>
+#include <vector>
+#include "vo_api.hpp"
+#include "vo_common.hpp"
+
+class voDeviceContext;
+
+/**
+ * @class voQueue
+ * @brief A Vulkan queue whose submissions are tracked by 64-bit timeline points.
+ *
+ * @details Every call to `Submit` returns a monotonically increasing value. The value can be polled with `IsComplete`,
+ * waited on with `Wait`, or handed to a submission on another queue so the GPU waits for it instead of the host.
+ * Anything that must outlive a submission (frame slots, staging memory, resources waiting to be destroyed)
+ * keeps the value of the last submission using it, instead of idling the queue or the device.
+ *
+ * When `timelineSemaphore` is enabled on the device, the values are the payload of a timeline semaphore signaled by each submission.
+ * Otherwise each submission signals a fence taken from the `voFencePool`, and the completed value is derived from the
+ * fences retired in submission order. In that mode cross-queue waits are resolved on the host before submitting.
+ *
+ * Submissions and presentation are serialized by a mutex, as required for a `VkQueue` shared between threads.
+ *
+ * @code
+ * voQueue::submit_t submit =
+ *     {
+ *         .numCommandBuffers = 1,
+ *         .commandBuffers    = &cmdBuffer,
+ *     };
+ *
+ * const uint64_t value = device->m_graphicsQueue.Submit( device, submit );
+ *
+ * // ... later
+ * if( device->m_graphicsQueue.IsComplete( device, value ) )
+ *     {
+ *         // The resources used by the submission can be reused
+ *     }
+ * @endcode
+ *
+ * @see `voDeviceContext`, `voFencePool`
+ */
+class VO_API voQueue
+{
+  public:
+    voQueue()  = default;
+    ~voQueue() = default;
+
+    voQueue( const voQueue & )             = delete;
+    voQueue & operator=( const voQueue & ) = delete;
+
+    /**
+     * @struct wait_t
+     * @brief A point of a queue timeline a submission has to wait for.
+     */
+    struct wait_t
+    {
+        voQueue *            queue { nullptr };
+        uint64_t             value { 0 };
+        VkPipelineStageFlags stages { VK_PIPELINE_STAGE_ALL_COMMANDS_BIT }; ///< Stages of the submission blocked by the wait
+    };
+
+    /**
+     * @struct submit_t
+     * @brief Work and synchronization of a single submission.
+     */
+    struct submit_t
+    {
+        uint32_t                numCommandBuffers { 0 };
+        const VkCommandBuffer * commandBuffers { nullptr };
+
+        uint32_t       numWaits { 0 };
+        const wait_t * waits { nullptr }; ///< Timeline points of this or other queues
+
+        VkSemaphore          waitSemaphore { VK_NULL_HANDLE }; ///< Optional binary semaphore, e.g. swapchain image acquisition
+        VkPipelineStageFlags waitSemaphoreStages { 0 };
+        VkSemaphore          signalSemaphore { VK_NULL_HANDLE }; ///< Optional binary semaphore, e.g. presentation
+    };
+
+    /**
+     * @brief Retrieves the queue and creates the timeline used to track its submissions.
+     *
+     * @param device The device context, its logical device must exist.
+     * @param family The queue family index.
+     * @param index The index of the queue inside the family.
+     * @return True if creation is successful, false otherwise.
+     */
+    bool Create( voDeviceContext * device, uint32_t family, uint32_t index );
+
+    /**
+     * @brief Waits for every submission then releases the timeline.
+     * @param device The device context.
+     */
+    void Cleanup( voDeviceContext * device );
+
+    /**
+     * @brief Submits work to the queue.
+     *
+     * @param device The device context.
+     * @param submit The command buffers and semaphores of the submission.
+     * @return The timeline value signaled once the submission completes.
+     */
+    uint64_t Submit( voDeviceContext * device, const submit_t & submit );
+
+    /**
+     * @brief Presents swapchain images, serialized with the submissions of this queue.
+     * @return The result of `vkQueuePresentKHR`.
+     */
+    VkResult Present( const VkPresentInfoKHR & presentInfo );
+
+    /**
+     * @brief Check, without blocking, whether the GPU reached a timeline value.
+     *
+     * @param device The device context.
+     * @param value A value returned by `Submit`.
+     */
+    bool IsComplete( voDeviceContext * device, uint64_t value );
+
+    /**
+     * @brief Blocks until the GPU reached a timeline value.
+     *
+     * @param device The device context.
+     * @param value A value returned by `Submit`, zero returns immediately.
+     */
+    void Wait( voDeviceContext * device, uint64_t value );
+
+    /** @brief Blocks until every submission of the queue completed */
+    void WaitIdle( voDeviceContext * device );
+
+    /* -------------------------------------- Getters ------------------------------------------------------------------ */
+
+    [[nodiscard]] FORCE_INLINE VkQueue GetQueue() const;
+
+    [[nodiscard]] FORCE_INLINE uint32_t GetFamily() const;
+
+    [[nodiscard]] FORCE_INLINE bool IsTimeline() const;
+
+    /** @brief Get the timeline semaphore, `VK_NULL_HANDLE` when fences are used instead */
+    [[nodiscard]] FORCE_INLINE VkSemaphore GetTimeline() const;
+
+    /** @brief Get the value returned by the last submission */
+    [[nodiscard]] uint64_t GetLastSubmitted();
+
+  private:
+    /**
+     * @struct pending_fence_t
+     * @brief Fence signaled by a submission, when timeline semaphores are not available.
+     */
+    struct pending_fence_t
+    {
+        uint64_t value;
+        VkFence  fence;
+    };
+
+    /** @brief Retires the fences that have been signaled, in submission order. Expects the mutex to be held. */
+    void RetireFences( voDeviceContext * device );
+
+    /* -------------------------------------- Handlers ----------------------------------------------------------------- */
+
+    VkQueue  m_vkQueue { VK_NULL_HANDLE };
+    uint32_t m_family { 0 };
+
+    VkSemaphore m_vkTimeline { VK_NULL_HANDLE };
+
+    uint64_t m_lastSubmitted { 0 }; ///< Value of the most recent submission
+    uint64_t m_completed { 0 };     ///< Highest value known to be reached by the GPU
+
+    std::deque< pending_fence_t > m_pendingFences {}; ///< Fallback tracking, oldest submission first
+    std::vector< VkFence >        m_retiredFences {}; ///< Signaled, returned to the pool once no thread waits on a fence
+    uint32_t                      m_numFenceWaits { 0 };
+
+    std::mutex m_mutex;
+};
+
+// ======================================================================================================================
+// ============================================ Inline ==================================================================
+// ======================================================================================================================
+
+FORCE_INLINE VkQueue
+voQueue::GetQueue() const
+{
+    return m_vkQueue;
+}
+
+FORCE_INLINE uint32_t
+voQueue::GetFamily() const
+{
+    return m_family;
+}
+
+FORCE_INLINE bool
+voQueue::IsTimeline() const
+{
+    return m_vkTimeline != VK_NULL_HANDLE;
+}
+
+FORCE_INLINE VkSemaphore
+voQueue::GetTimeline() const
+{
+    return m_vkTimeline;
+}
+
+#endif //VULKANO_QUEUE_H
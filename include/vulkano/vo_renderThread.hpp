@@ -0,0 +1,213 @@
+#ifndef VULKANO_RENDERTHREAD_H
+#define VULKANO_RENDERTHREAD_H
+
+#include <condition_variable>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "vo_api.hpp"
+#include "vo_common.hpp"
+
+class voDeviceContext;
+class voModel;
+class voPipeline;
+
+/**
+ * @struct voRenderList
+ * @brief Description of a frame, produced by the main thread and consumed by the render thread.
+ *
+ * @details Only plain data: the views, the draw packets and the uniform data they refer to.
+ * The list owns a copy of the uniform data, the record function copies it into the uniform buffers of the frame slot.
+ * Pipelines and models must outlive the frames drawing them.
+ */
+struct VO_API voRenderList
+{
+    /**
+     * @struct draw_t
+     * @brief A draw packet.
+     */
+    struct draw_t
+    {
+        voPipeline * pipeline { nullptr };
+        voModel *    model { nullptr };
+        uint32_t     uniformOffset { 0 }; ///< Offset of the draw uniforms in `uniforms`
+        uint32_t     uniformSize { 0 };
+    };
+
+    /**
+     * @struct view_t
+     * @brief A camera, and the range of draw packets it sees.
+     */
+    struct view_t
+    {
+        uint32_t uniformOffset { 0 }; ///< Offset of the view uniforms in `uniforms`
+        uint32_t uniformSize { 0 };
+        uint32_t firstDraw { 0 };
+        uint32_t numDraws { 0 };
+    };
+
+    std::vector< view_t >  views {};
+    std::vector< draw_t >  draws {};
+    std::vector< uint8_t > uniforms {};
+
+    /** @brief Empties the list, keeping its memory for the next frame */
+    void Clear();
+
+    /**
+     * @brief Appends uniform data to the list.
+     * @param data The uniform data, copied.
+     * @param size Size of the data in bytes.
+     * @return Offset of the data in `uniforms`, aligned to 16 bytes.
+     */
+    uint32_t PushUniforms( const void * data, uint32_t size );
+};
+
+/**
+ * @class voRenderThread
+ * @brief Records, submits and presents the frames on a thread of its own.
+ *
+ * @details The main thread fills a `voRenderList` and hands it over with `Submit`, the render thread then begins a frame,
+ * records the list through the record function, ends the frame and presents it. Two lists are used in turn,
+ * so the simulation of frame N+1 overlaps the recording of frame N, and acquire or present stalls no longer block
+ * input handling. `BeginList` only blocks when the main thread is a whole frame ahead of the render thread.
+ *
+ * While the render thread runs, frames are only begun and ended by it: the main thread requests resizes through `Resize`
+ * and keeps creating resources, the upload context and the deletion queue being shared between threads.
+ * Jobs with the main thread affinity are run by `Submit`.
+ *
+ * @code
+ * renderThread.Create( device, { .record = [&]( voDeviceContext * device, uint32_t frameIndex, const voRenderList & list )
+ *                                {
+ *                                    device->BeginRenderPass();
+ *                                    for( const voRenderList::draw_t & draw : list.draws )
+ *                                        {
+ *                                            draw.pipeline->BindPipeline( device->m_vkCommandBuffers[frameIndex] );
+ *                                            draw.model->DrawIndexed( device->m_vkCommandBuffers[frameIndex] );
+ *                                        }
+ *                                    device->EndRenderPass();
+ *                                } } );
+ *
+ * while( !window.ShouldClose() )
+ *     {
+ *         voRenderList & list = renderThread.BeginList();
+ *         list.draws.push_back( { &pipeline, &model } );
+ *         renderThread.Submit();
+ *     }
+ *
+ * renderThread.Cleanup();
+ * @endcode
+ *
+ * @see `voDeviceContext`, `voSwapChain`
+ */
+class VO_API voRenderThread
+{
+  public:
+    voRenderThread()  = default;
+    ~voRenderThread() = default;
+
+    voRenderThread( const voRenderThread & )             = delete;
+    voRenderThread & operator=( const voRenderThread & ) = delete;
+
+    /** @brief Records a list into the command buffer of the frame slot, inside BeginFrame and EndFrame */
+    using record_t = std::function< void( voDeviceContext *, uint32_t, const voRenderList & ) >;
+
+    /**
+     * @struct CreateParms_t
+     * @brief Parameters for creating the render thread.
+     */
+    struct CreateParms_t
+    {
+        record_t record;
+    };
+
+    /**
+     * @brief Starts the render thread.
+     * @param device The device context, its frames are begun and ended by the render thread from now on.
+     * @param parms The parameters for creating the render thread.
+     * @return True if creation is successful, false otherwise.
+     */
+    bool Create( voDeviceContext * device, const CreateParms_t & parms );
+
+    /**
+     * @brief Renders the submitted list, if any, and joins the render thread.
+     */
+    void Cleanup();
+
+    /**
+     * @brief Gets the list to fill for the next frame, emptied.
+     * @details Blocks while the render thread is still recording that list.
+     */
+    voRenderList & BeginList();
+
+    /**
+     * @brief Hands the list over to the render thread.
+     */
+    void Submit();
+
+    /**
+     * @brief Requests the swapchain to be resized, before the next frame recorded by the render thread.
+     * @param width The new width of the window.
+     * @param height The new height of the window.
+     */
+    void Resize( int width, int height );
+
+    /** @brief Check if the render thread is running */
+    [[nodiscard]] bool IsRunning() const;
+
+  private:
+    static const int NO_LIST = -1;
+
+    void ThreadLoop();
+
+    /* -------------------------------------- Handlers ----------------------------------------------------------------- */
+
+    voDeviceContext * m_device { nullptr };
+    record_t          m_record {};
+    std::thread       m_thread {};
+
+    voRenderList m_lists[2] {};
+    int          m_writeIndex { 0 };         ///< List being filled by the main thread
+    int          m_pendingIndex { NO_LIST }; ///< List submitted, not picked by the render thread yet
+    int          m_renderIndex { NO_LIST };  ///< List being recorded by the render thread
+
+    int  m_width { 0 };
+    int  m_height { 0 };
+    bool m_resized { false };
+    bool m_stop { false };
+
+    std::mutex              m_mutex;
+    std::condition_variable m_cond;
+};
+
+// ======================================================================================================================
+// ============================================ Inline ==================================================================
+// ======================================================================================================================
+
+FORCE_INLINE void
+voRenderList::Clear()
+{
+    views.clear();
+    draws.clear();
+    uniforms.clear();
+}
+
+FORCE_INLINE uint32_t
+voRenderList::PushUniforms( const void * data, uint32_t size )
+{
+    const auto offset = static_cast< uint32_t >( ( uniforms.size() + 15 ) & ~size_t( 15 ) );
+
+    uniforms.resize( offset + size );
+    memcpy( uniforms.data() + offset, data, size );
+
+    return offset;
+}
+
+FORCE_INLINE bool
+voRenderThread::IsRunning() const
+{
+    return m_thread.joinable();
+}
+
+#endif //VULKANO_RENDERTHREAD_H
@@ -4,6 +4,7 @@
 #include "vulkano/vo_deviceContext.hpp"
 #include "vulkano/vo_model.hpp"
 #include "vulkano/vo_pipeline.hpp"
+#include "vulkano/vo_renderThread.hpp"
 #include "vulkano/vo_shader.hpp"
 #include "vulkano/vo_window.hpp"
 
@@ -17,6 +18,7 @@ class Renderer
         int width;
         int height;
         const char * title;
+        bool renderThread { false }; ///< Record, submit and present on a thread of its own
     };
 
     explicit Renderer( const Config & config, bool enableLayers = false );
@@ -42,6 +44,9 @@ class Renderer
     voDeviceContext m_deviceContext;
     voShader m_shader;
     voPipeline m_pipeline;
+    voRenderThread m_renderThread;
+    voRenderList * m_renderList { nullptr };
 
     bool CreatePipeline();
+    void RecordList( uint32_t frameIndex, const voRenderList & list );
 };
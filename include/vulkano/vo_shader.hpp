@@ -1,9 +1,13 @@
 #ifndef VULKANO_SHADER_H
 #define VULKANO_SHADER_H
 
+#include <mutex>
+#include <string>
 #include <unordered_map>
+#include <vector>
 #include "vo_api.hpp"
 #include "vo_common.hpp"
+#include "vo_jobSystem.hpp"
 
 class voDeviceContext;
 
@@ -26,6 +30,15 @@ class voDeviceContext;
  * // Cleanup
  * shader.Cleanup(&deviceContext);
  * @endcode
+ *
+ * Loading also reflects the SPIR-V of every stage: the descriptor bindings, the push constant range and the vertex inputs
+ * the shaders declare are gathered in `reflection`, so descriptor set layouts and pipeline layouts no longer need to be
+ * counted by hand.
+ *
+ * Pipelines created with `async` compile from the shader modules on the job system after `voPipeline::Create` returns.
+ * `Cleanup` waits for these compiles before destroying the modules, so the shader can be cleaned up right after.
+ *
+ * @see `voDescriptors`, `voPipeline`, `voLayoutCache`
  */
 class VO_API voShader
 {
@@ -54,6 +67,48 @@ class VO_API voShader
     {
         VkShaderStageFlagBits stage;
         VkShaderModule module;
+        uint64_t hash { 0 }; ///< Of the SPIR-V code, identifies the module in pipeline keys
+    };
+
+    /**
+     * @struct binding_t
+     * @brief A descriptor declared by the shaders, merged across the stages using it.
+     */
+    struct binding_t
+    {
+        uint32_t           set { 0 };
+        uint32_t           binding { 0 };
+        VkDescriptorType   descriptorType { VK_DESCRIPTOR_TYPE_MAX_ENUM };
+        uint32_t           descriptorCount { 1 }; ///< Size of the array, zero for runtime sized arrays
+        VkShaderStageFlags stageFlags { 0 };
+    };
+
+    /**
+     * @struct vertexInput_t
+     * @brief An input of the vertex stage.
+     */
+    struct vertexInput_t
+    {
+        uint32_t location { 0 };
+        VkFormat format { VK_FORMAT_UNDEFINED };
+    };
+
+    /**
+     * @struct reflection_t
+     * @brief What the shaders expect from the pipeline layout and the vertex input.
+     */
+    struct reflection_t
+    {
+        std::vector< binding_t >     bindings {};      ///< Sorted by set, then by binding
+        VkPushConstantRange          pushConstants {}; ///< Covers the push constants of every stage, zero sized when there are none
+        std::vector< vertexInput_t > vertexInputs {};  ///< Sorted by location
+
+        /**
+         * @brief Gets the bindings of a set.
+         * @param set The index of the set.
+         * @return The bindings of the set, sorted by binding.
+         */
+        [[nodiscard]] std::vector< binding_t > GetSetBindings( uint32_t set ) const;
     };
 
   public:
@@ -71,12 +126,19 @@ class VO_API voShader
     bool Load( voDeviceContext * device, const char * name );
 
     /**
-     * @brief Cleans up the shader
+     * @brief Cleans up the shader, once the compiles reading its modules have run
      *
      * @param device The Vulkan device context
      */
     void Cleanup( voDeviceContext * device );
 
+    /**
+     * @brief Keeps the modules until a compile job reading them has run, thread safe
+     *
+     * @param job The compile job, a null handle is ignored
+     */
+    void AddCompile( const voJobSystem::handle_t & job );
+
   private:
     /**
      * @brief Creates a Vulkan shader module
@@ -89,8 +151,45 @@ class VO_API voShader
      */
     static VkShaderModule CreateShaderModule( VkDevice vkDevice, const char * code, int size );
 
+    /**
+     * @brief Adds the bindings, push constants and vertex inputs of a SPIR-V module to the reflection
+     *
+     * @param code The SPIR-V words
+     * @param numWords The number of words
+     * @param stage The stage of the module
+     * @param reflection The reflection to merge into
+     *
+     * @return False if the code is not valid SPIR-V
+     */
+    static bool Reflect( const uint32_t * code, size_t numWords, VkShaderStageFlagBits stage, reflection_t & reflection );
+
   public:
+    std::string                                      name {}; ///< Name the shader was loaded with
     std::unordered_map< ShaderStage_t, voModules_t > modules {};
+    reflection_t                                     reflection {};
+
+  private:
+    std::mutex                           m_compilesMutex;
+    std::vector< voJobSystem::handle_t > m_compiles {}; ///< Jobs that may still read the modules
 };
 
+// ======================================================================================================================
+// ============================================ Inline ==================================================================
+// ======================================================================================================================
+
+FORCE_INLINE std::vector< voShader::binding_t >
+voShader::reflection_t::GetSetBindings( uint32_t set ) const
+{
+    std::vector< binding_t > setBindings {};
+    for( const binding_t & binding : bindings )
+        {
+            if( binding.set == set )
+                {
+                    setBindings.push_back( binding );
+                }
+        }
+
+    return setBindings;
+}
+
 #endif //VULKANO_SHADER_H
@@ -2,7 +2,10 @@
 #define VULKANO_SWAPCHAIN_H
 
 #include "vo_api.hpp"
+#include "vo_commandAllocator.hpp"
 #include "vo_common.hpp"
+#include "vo_memory.hpp"
+#include "vo_queue.hpp"
 
 class voDeviceContext;
 
@@ -15,18 +18,23 @@ class voDeviceContext;
  * It's necessary for rendering images to the screen.
  * The class provides functionalities for creating, resizing, and cleaning up the Swapchain, as well as beginning and ending frames and render passes.
  *
+ * Several frames can be in flight at once. Each frame slot owns an image-available semaphore and a command buffer,
+ * and remembers the graphics queue timeline value of its last submission,
+ * so the CPU records the next frame while the GPU is still executing the previous ones.
+ * `BeginFrame` only blocks when the slot it is about to reuse has not been retired by the GPU yet.
+ *
  * @code
  * voDeviceContext deviceContext;
  * voSwapChain swapChain;
  *
- * // Create the swap chain
- * if ( !swapChain.Create( &deviceContext, windowWidth, windowHeight ) ) {
+ * // Create the swap chain, with two frames in flight
+ * if ( !swapChain.Create( &deviceContext, windowWidth, windowHeight, 2 ) ) {
  *     std::cerr << "Failed to create swap chain." << std::endl;
  *     return;
  * }
  *
  * // Begin frame
- * uint32_t imageIndex = swapChain.BeginFrame( &deviceContext );
+ * uint32_t frameIndex = swapChain.BeginFrame( &deviceContext );
  *
  *    // Begin render pass
  *    swapChain.BeginRenderPass( &deviceContext );
@@ -54,6 +62,20 @@ class VO_API voSwapChain
         VkImageView view { VK_NULL_HANDLE };
     };
 
+    /**
+     * @struct frame_t
+     * @brief Synchronization state of a frame slot.
+     *
+     * @details The command buffer of a slot is `voDeviceContext::m_vkCommandBuffers[slot]`.
+     */
+    struct VO_API frame_t
+    {
+        uint64_t submitValue { 0 };                               ///< Graphics queue timeline value of the last submission
+        VkSemaphore imageAvailableSemaphore { VK_NULL_HANDLE };   ///< Signaled once the acquired image can be rendered to
+    };
+
+    static const uint32_t MAX_FRAMES_IN_FLIGHT = 3;
+
     /* -------------------------------------- Swapchain Lifecycle ------------------------------------------------------- */
     /**
      * @brief Constructs a new swap chain object.
@@ -61,12 +83,13 @@ class VO_API voSwapChain
      * @param device A pointer to the device context.
      * @param width The width of the window.
      * @param height The height of the window.
+     * @param framesInFlight Number of frames the CPU may record ahead of the GPU, clamped to [1, MAX_FRAMES_IN_FLIGHT].
      *
      * @return True if the swap chain was created successfully, false otherwise.
      *
      * @see Cleanup()
      */
-    bool Create( voDeviceContext * device, int width, int height );
+    bool Create( voDeviceContext * device, int width, int height, uint32_t framesInFlight = 2 );
 
     /**
      * @brief Destroys the swap chain object and releases all associated resources.
@@ -78,7 +101,12 @@ class VO_API voSwapChain
     void Cleanup( voDeviceContext * device );
 
     /**
-     * @brief Resizes the swap chain to the given width and height.
+     * @brief Requests the swap chain to be resized to the given width and height.
+     *
+     * @details Does not block: successive requests are coalesced and the swap chain is rebuilt once by the next `BeginFrame`.
+     * The previous swapchain is retired, and its images, views, depth buffer and framebuffers are released through
+     * the deletion queue once the frames still using them have been executed.
+     * The render pass is kept, so pipelines built against it stay valid (viewport and scissor are dynamic).
      *
      * @param device A pointer to the device context.
      * @param width The new width of the window.
@@ -90,14 +118,18 @@ class VO_API voSwapChain
     /**
      * @brief Begins a new frame by acquiring the next available image from the swap chain.
      *
+     * @details Waits until the GPU has retired the previous use of the frame slot, then starts recording its command buffer.
+     *
      * @param device A pointer to the device context.
      *
-     * @return The index of the acquired image.
+     * @return The index of the frame slot, which is also the index of its command buffer.
      */
     uint32_t BeginFrame( voDeviceContext * device );
 
     /**
-     * @brief Ends the current frame by presenting the current image to the screen.
+     * @brief Ends the current frame by submitting its command buffer and presenting the current image to the screen.
+     *
+     * @details It does not wait for the GPU, the slot submission is waited on the next time the slot is used.
      *
      * @param device A pointer to the device context.
      *
@@ -105,15 +137,28 @@ class VO_API voSwapChain
      */
     void EndFrame( voDeviceContext * device );
 
+    /**
+     * @brief Makes the submission of the current frame wait for a point of a queue timeline.
+     *
+     * @details The waits are consumed by the next `EndFrame`, e.g. compute results read by the frame.
+     *
+     * @param wait The timeline point and the stages of the frame it blocks.
+     */
+    void AddWait( const voQueue::wait_t & wait );
+
     /* -------------------------------------- Render Pass Lifecycle ------------------------------------------------------ */
     /**
      * @brief Begins a new render pass.
      *
+     * @details With `VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS`, the draws are recorded into secondary command buffers
+     * begun with `GetInheritance`, which set the viewport and scissor themselves.
+     *
      * @param device A pointer to the device context.
+     * @param contents Whether the draws are recorded inline or executed from secondary command buffers.
      *
-     * @see EndRenderPass()
+     * @see EndRenderPass(), voCommandAllocator
      */
-    void BeginRenderPass( voDeviceContext * device );
+    void BeginRenderPass( voDeviceContext * device, VkSubpassContents contents = VK_SUBPASS_CONTENTS_INLINE );
 
     /**
      * @brief Ends the current render pass.
@@ -137,15 +182,23 @@ class VO_API voSwapChain
 
     [[nodiscard]] FORCE_INLINE uint32_t GetColorImagesSize() const;
 
+    [[nodiscard]] FORCE_INLINE uint32_t GetFramesInFlight() const;
+
+    [[nodiscard]] FORCE_INLINE uint32_t GetFrameIndex() const;
+
+    /** @brief Get the render pass and framebuffer of the acquired image, to record secondary command buffers */
+    [[nodiscard]] FORCE_INLINE voCommandAllocator::inheritance_t GetInheritance() const;
+
   private:
     /* -------------------------------------- Swapchain Properties ------------------------------------------------------- */
     uint32_t m_width { 0 };
     uint32_t m_height { 0 };
-    uint8_t m_resized : 1 { false }; ///< Flag indicating whether a resize has been requested
+    uint8_t m_resized : 1 { false }; ///< Flag indicating whether a rebuild has been requested
 
     VkSwapchainKHR m_vkSwapChain { VK_NULL_HANDLE };
     VkExtent2D m_vkExtent {};
     uint32_t m_currentImageIndex { 0 };
+    uint32_t m_frameIndex { 0 }; ///< Frame slot being recorded
 
     /* -------------------------------------- Color Image Properties ----------------------------------------------------- */
     VkFormat m_vkColorImageFormat {};
@@ -155,21 +208,39 @@ class VO_API voSwapChain
     VkFormat m_vkDepthFormat {};
     VkImage m_vkDepthImage { VK_NULL_HANDLE };
     VkImageView m_vkDepthImageView { VK_NULL_HANDLE };
-    VkDeviceMemory m_vkDepthImageMemory { VK_NULL_HANDLE };
+    VmaAllocation m_vmaDepthAllocation { VK_NULL_HANDLE };
 
     /* -------------------------------------- Framebuffer and Render Pass Properties ------------------------------------- */
     std::vector< VkFramebuffer > m_framebuffers {};
     VkRenderPass m_vkRenderPass { VK_NULL_HANDLE };
 
     /* -------------------------------------- Synchronization Properties -------------------------------------------------- */
-    VkSemaphore m_vkRenderFinishedSemaphore { VK_NULL_HANDLE };
-    VkSemaphore m_vkImageAvailableSemaphore { VK_NULL_HANDLE };
+    std::vector< frame_t > m_frames {};                           ///< One entry per frame in flight
+    std::vector< VkSemaphore > m_vkRenderFinishedSemaphores {};   ///< One per swapchain image, waited on by the presentation
+    std::vector< voQueue::wait_t > m_frameWaits {};               ///< Cross-queue waits of the next submission
 
   private:
+    /**
+     * @brief Rebuilds the swapchain and the resources depending on its extent, for the last requested size.
+     *
+     * @param device Pointer to the device context.
+     */
+    void Recreate( voDeviceContext * device );
+
     /* -------------------------------------- Create Functions --------------------------------------------------------- */
     /**
-     * @brief Initializes semaphores for synchronizing operations within or across command queues.
-     * 
+     * @brief Initializes the semaphore of every frame slot.
+     *
+     * @param device Pointer to the device context.
+     * @param framesInFlight Number of frame slots.
+     */
+    void CreateFrames( voDeviceContext * device, uint32_t framesInFlight );
+
+    /**
+     * @brief Initializes one render finished semaphore per swapchain image.
+     *
+     * @details They are kept across resizes as long as the number of images does not change.
+     *
      * @param device Pointer to the device context.
      */
     void CreateSemaphores( voDeviceContext * device );
@@ -294,6 +365,28 @@ voSwapChain::GetColorImagesSize() const
     return static_cast< uint32_t >( m_buffers.size() );
 }
 
+FORCE_INLINE uint32_t
+voSwapChain::GetFramesInFlight() const
+{
+    return static_cast< uint32_t >( m_frames.size() );
+}
+
+FORCE_INLINE uint32_t
+voSwapChain::GetFrameIndex() const
+{
+    return m_frameIndex;
+}
+
+FORCE_INLINE voCommandAllocator::inheritance_t
+voSwapChain::GetInheritance() const
+{
+    return {
+        .renderPass  = m_vkRenderPass,
+        .framebuffer = m_framebuffers[m_currentImageIndex],
+        .extent      = { m_width, m_height },
+    };
+}
+
 FORCE_INLINE void
 voSwapChain::SetExtent( VkSurfaceCapabilitiesKHR & InSurfaceCapabilities, int width, int height )
 {
@@ -0,0 +1,230 @@
+#ifndef VULKANO_UNIFORMALLOCATOR_H
+#define VULKANO_UNIFORMALLOCATOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include "vo_api.hpp"
+#include "vo_buffer.hpp"
+#include "vo_common.hpp"
+
+// ======================================================================================================================
+// ============================================ std140 ==================================================================
+// ======================================================================================================================
+
+/**
+ * @struct std140_traits_t
+ * @brief Compile-time size and base alignment of a type under the std140 layout rules.
+ *
+ * @details Scalars, vectors (`float[N]`) and column-major matrices (`float[C][R]`) are covered,
+ * which maps directly onto the cglm types (`vec2`, `vec3`, `vec4`, `mat4`, ...).
+ * Structs declare their members as `std140_t`, see `std140_block_t`, and are aligned like a vec4.
+ */
+template< typename T >
+struct std140_traits_t
+{
+    static constexpr size_t size      = T::std140_t::size;
+    static constexpr size_t alignment = 16;
+};
+
+#define STD140_SCALAR( T )                             \
+    template<>                                         \
+    struct std140_traits_t< T >                        \
+    {                                                  \
+        static constexpr size_t size      = sizeof( T ); \
+        static constexpr size_t alignment = sizeof( T ); \
+    }
+
+STD140_SCALAR( float );
+STD140_SCALAR( int32_t );
+STD140_SCALAR( uint32_t );
+
+#undef STD140_SCALAR
+
+/** @brief Vectors, a vec3 is aligned like a vec4 */
+template< size_t N >
+struct std140_traits_t< float[N] >
+{
+    static_assert( N >= 2 && N <= 4, "std140 vectors have 2 to 4 components" );
+
+    static constexpr size_t size      = sizeof( float ) * N;
+    static constexpr size_t alignment = N == 2 ? 8 : 16;
+};
+
+/** @brief Matrices are arrays of column vectors, each column is rounded up to a vec4 */
+template< size_t C, size_t R >
+struct std140_traits_t< float[C][R] >
+{
+    static constexpr size_t size      = 16 * C;
+    static constexpr size_t alignment = 16;
+};
+
+/**
+ * @brief Size of a uniform block made of the given members, in declaration order.
+ */
+template< typename... Members >
+constexpr size_t
+Std140BlockSize()
+{
+    size_t offset = 0;
+    ( ( offset = ( offset + std140_traits_t< Members >::alignment - 1 ) / std140_traits_t< Members >::alignment * std140_traits_t< Members >::alignment
+                 + std140_traits_t< Members >::size ),
+      ... );
+
+    // The block itself is rounded up to the alignment of a vec4
+    return ( offset + 15 ) / 16 * 16;
+}
+
+/**
+ * @struct std140_block_t
+ * @brief The members of a uniform block, in declaration order, declared by its struct as `std140_t`.
+ *
+ * @details `voUniformAllocator::Allocate` checks the struct against the size of the block, a struct missing padding
+ * or the declaration fails to compile.
+ *
+ * @code
+ * struct camera_t
+ * {
+ *     using std140_t = std140_block_t< mat4, mat4 >;
+ *
+ *     mat4 matView;
+ *     mat4 matProj;
+ * };
+ * @endcode
+ */
+template< typename... Members >
+struct std140_block_t
+{
+    static constexpr size_t size = Std140BlockSize< Members... >();
+};
+
+// ======================================================================================================================
+// ============================================ Uniform Allocator =======================================================
+// ======================================================================================================================
+
+/**
+ * @class voUniformAllocator
+ * @brief Frame-scoped bump allocator for uniform data.
+ *
+ * @details A single persistently mapped uniform buffer is split in one region per frame in flight.
+ * Every frame starts writing at the beginning of its own region, and each allocation is a pointer bump
+ * rounded to `minUniformBufferOffsetAlignment`, so uniforms can be written straight into the buffer
+ * and bound with the returned offset. No manual offset bookkeeping or padding members are needed.
+ *
+ * @code
+ * const uint32_t frameIndex = device->BeginFrame();
+ * uniforms.BeginFrame( frameIndex );
+ *
+ * auto camera = uniforms.Allocate< camera_t >();
+ * glm_mat4_copy( matView, camera.ptr->matView );
+ *
+ * descriptor.BindBuffer( uniforms.GetBuffer(), camera.offset, sizeof( camera_t ), 0 );
+ *
+ * uniforms.EndFrame( device );
+ * @endcode
+ *
+ * @see `voBuffer`, `voDeviceContext`
+ */
+class VO_API voUniformAllocator
+{
+  public:
+    voUniformAllocator()  = default;
+    ~voUniformAllocator() = default;
+
+    /**
+     * @struct CreateParms_t
+     * @brief Parameters for creating the allocator.
+     */
+    struct CreateParms_t
+    {
+        VkDeviceSize frameSize; ///< Bytes available to each frame
+        uint32_t     numFrames; ///< Number of regions, one per frame in flight
+    };
+
+    /**
+     * @struct allocation_t
+     * @brief Result of an allocation: where to write on the CPU and where to bind on the GPU.
+     */
+    template< typename T >
+    struct allocation_t
+    {
+        T *      ptr { nullptr }; ///< CPU pointer inside the mapped buffer
+        uint32_t offset { 0 };    ///< Byte offset inside the uniform buffer
+    };
+
+    /**
+     * @brief Creates the backing uniform buffer.
+     * @param device The device context.
+     * @param parms The parameters for creating the allocator.
+     * @return True if creation is successful, false otherwise.
+     */
+    bool Create( voDeviceContext * device, const CreateParms_t & parms );
+
+    /** @brief Releases the backing buffer */
+    void Cleanup( voDeviceContext * device );
+
+    /**
+     * @brief Selects the region of a frame slot and rewinds it.
+     * @param frameIndex The frame slot returned by `voDeviceContext::BeginFrame`, once the GPU is done with it.
+     */
+    void BeginFrame( uint32_t frameIndex );
+
+    /** @brief Flushes the bytes written during the frame (only needed on non-coherent memory) */
+    void EndFrame( voDeviceContext * device );
+
+    /**
+     * @brief Allocates uniform space for one `T`, a scalar, vector, matrix or struct declaring its `std140_block_t`.
+     * @return The CPU pointer and the buffer offset, or a null pointer when the frame region is exhausted.
+     */
+    template< typename T >
+    allocation_t< T > Allocate();
+
+    /**
+     * @brief Allocates raw uniform space.
+     * @param size Size in bytes.
+     * @return The CPU pointer and the buffer offset, or a null pointer when the frame region is exhausted.
+     */
+    allocation_t< void > Allocate( VkDeviceSize size );
+
+    /** @brief Get the uniform buffer every allocation lives in */
+    [[nodiscard]] voBuffer * GetBuffer();
+
+    /** @brief Get the number of bytes allocated in the current frame */
+    [[nodiscard]] VkDeviceSize GetUsedSize() const;
+
+  private:
+    voBuffer m_buffer {};
+
+    VkDeviceSize m_alignment { 256 };  ///< minUniformBufferOffsetAlignment of the device
+    VkDeviceSize m_frameSize { 0 };
+    uint32_t     m_numFrames { 0 };
+    uint32_t     m_frame { 0 };        ///< Region in use
+    VkDeviceSize m_head { 0 };         ///< Next free byte, relative to the region
+};
+
+// ======================================================================================================================
+// ============================================ Inline ==================================================================
+// ======================================================================================================================
+
+template< typename T >
+FORCE_INLINE voUniformAllocator::allocation_t< T >
+voUniformAllocator::Allocate()
+{
+    static_assert( sizeof( T ) == std140_traits_t< T >::size, "The struct does not match its std140 layout" );
+
+    const allocation_t< void > allocation = Allocate( sizeof( T ) );
+    return { static_cast< T * >( allocation.ptr ), allocation.offset };
+}
+
+FORCE_INLINE voBuffer *
+voUniformAllocator::GetBuffer()
+{
+    return &m_buffer;
+}
+
+FORCE_INLINE VkDeviceSize
+voUniformAllocator::GetUsedSize() const
+{
+    return m_head;
+}
+
+#endif //VULKANO_UNIFORMALLOCATOR_H
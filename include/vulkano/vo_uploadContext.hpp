@@ -0,0 +1,430 @@
+#ifndef VULKANO_UPLOADCONTEXT_H
+#define VULKANO_UPLOADCONTEXT_H
+
+#include <algorithm>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <vector>
+#include "vo_api.hpp"
+#include "vo_common.hpp"
+#include "vo_memory.hpp"
+
+class voDeviceContext;
+class voQueue;
+
+/**
+ * @class voUploadContext
+ * @brief Moves data from the host into device local memory through a staging ring.
+ *
+ * @details The upload context owns a single persistently mapped staging buffer that is used as a ring.
+ * Every upload copies its data into the ring and records a `VkBufferCopy` towards the destination buffer.
+ * Pending copies are recorded into one command buffer and submitted at once when the outermost batch ends,
+ * when the ring runs out of space, or when `Flush` is called explicitly.
+ * Uploads larger than the ring are streamed in ring sized chunks.
+ *
+ * Copies into fresh destinations run on the transfer queue of the device. When it belongs to a dedicated family,
+ * the destination buffers are released by the transfer queue and acquired by the graphics queue,
+ * which waits on the transfer timeline on the GPU.
+ * Copies into buffers the GPU may still be reading stay on the graphics queue, after a write-after-read barrier.
+ * On devices exposing a single family, every copy and the visibility barrier are recorded on the graphics queue.
+ *
+ * Submissions never block the host: a region of the ring is reused once the timeline value of the submission
+ * reading it has been reached, and the graphics queue orders every later submission after the uploads.
+ *
+ * Setup work goes through the same batches: image uploads, layout transitions and any one-off command recorded with `Record`
+ * are collected from every caller into the graphics command buffer of the batch, instead of a submission and a host wait each.
+ * Every batch is identified by a token, which can be polled, waited on, or given a callback run once the batch completed.
+ *
+ * A single upload outside of any batch is flushed immediately.
+ * The context can be used from several threads, a batch opened by one thread also defers the uploads of the others.
+ * Large streaming uploads can instead be queued with `Enqueue`, `Pump` then submits at most the per-frame budget
+ * of them, so big asset loads are spread over several frames instead of showing up as a single spike.
+ *
+ * @code
+ * device->m_uploadContext.BeginBatch();
+ *
+ * vertexBuffer.Create( device, vertexParms, vertices.data() );
+ * indexBuffer.Create( device, indexParms, indices.data() );
+ *
+ * // Both copies go out in a single submission
+ * device->m_uploadContext.EndBatch( device );
+ *
+ * // Hundreds of textures, one submission
+ * device->m_uploadContext.BeginBatch();
+ * for( auto & texture : textures )
+ *     {
+ *         texture.image.Upload( device, texture.pixels.data(), texture.pixels.size() );
+ *     }
+ * const voUploadContext::token_t token = device->m_uploadContext.EndBatch( device );
+ *
+ * device->m_uploadContext.OnComplete( token, [&]() { scene.isLoaded = true; } );
+ * @endcode
+ *
+ * @see `voDeviceContext`, `voBuffer`, `voMemory`, `voQueue`
+ */
+class VO_API voUploadContext
+{
+  public:
+    voUploadContext()  = default;
+    ~voUploadContext() = default;
+
+    /** @brief Identifies a batch, 0 is always complete */
+    using token_t = uint64_t;
+
+    using callback_t = std::function< void() >;
+
+    /**
+     * @struct CreateParms_t
+     * @brief Parameters for creating the upload context.
+     */
+    struct CreateParms_t
+    {
+        VkDeviceSize stagingSize; ///< Size of the staging ring in bytes
+        VkDeviceSize frameBudget; ///< Bytes of queued uploads submitted by each `Pump`
+    };
+
+    /**
+     * @brief Creates the staging ring and the command pools used for transfers.
+     * @param device The device context.
+     * @param parms The parameters for creating the upload context.
+     * @return True if creation is successful, false otherwise.
+     */
+    bool Create( voDeviceContext * device, const CreateParms_t & parms );
+
+    /**
+     * @brief Flushes pending copies, waits for every upload and releases every resource of the context.
+     * @param device The device context.
+     */
+    void Cleanup( voDeviceContext * device );
+
+    /* -------------------------------------- Batching ----------------------------------------------------------------- */
+
+    /** @brief Opens a batch, uploads are deferred until the outermost batch ends. Batches can be nested. */
+    void BeginBatch();
+
+    /**
+     * @brief Closes a batch, submitting every pending copy once the outermost batch is closed.
+     * @param device The device context.
+     * @return The token of the batch the work of the closed batch belongs to.
+     */
+    token_t EndBatch( voDeviceContext * device );
+
+    /**
+     * @brief Records and submits every pending copy, without waiting for the transfer to complete.
+     * @param device The device context.
+     * @return The token of the submitted batch, or of the last one when nothing was pending.
+     */
+    token_t Flush( voDeviceContext * device );
+
+    /* -------------------------------------- Uploads ------------------------------------------------------------------ */
+
+    /**
+     * @brief Copies data into a region of a device buffer.
+     *
+     * @details The data is copied into the staging ring before returning, so it can be released right away.
+     * Fresh destinations are copied on the transfer queue, and when it has its own family,
+     * ownership of the whole destination buffer is handed over to the graphics queue.
+     *
+     * @param device The device context.
+     * @param dstBuffer The destination buffer, it must have been created with `VK_BUFFER_USAGE_TRANSFER_DST_BIT`.
+     * @param dstOffset Offset in bytes inside the destination buffer.
+     * @param data Pointer to the data to upload.
+     * @param size Size of the data in bytes.
+     * @param dstInUse False when nothing has been submitted using the destination yet, e.g. a buffer that was just created.
+     */
+    void UploadBuffer( voDeviceContext * device, VkBuffer dstBuffer, VkDeviceSize dstOffset, const void * data, VkDeviceSize size, bool dstInUse = true );
+
+    /**
+     * @brief Copies data into the first mip level and layer of an image, then transitions it to its final layout.
+     *
+     * @details The previous content is discarded. The copy and the transitions are recorded on the graphics queue.
+     *
+     * @param device The device context.
+     * @param dstImage The destination image, it must have been created with `VK_IMAGE_USAGE_TRANSFER_DST_BIT`.
+     * @param aspect The aspect of the image to fill.
+     * @param extent Size of the image in texels.
+     * @param data Pointer to tightly packed texels.
+     * @param size Size of the data in bytes, it must fit in the staging ring.
+     * @param finalLayout Layout of the image once the upload completed.
+     */
+    void UploadImage( voDeviceContext * device, VkImage dstImage, VkImageAspectFlags aspect, VkExtent3D extent, const void * data, VkDeviceSize size, VkImageLayout finalLayout );
+
+    /**
+     * @brief Transitions the layout of every mip level and layer of an image.
+     * @param device The device context.
+     * @param image The image.
+     * @param aspect The aspects of the image.
+     * @param oldLayout The current layout, `VK_IMAGE_LAYOUT_UNDEFINED` discards the content.
+     * @param newLayout The layout the image is transitioned to.
+     */
+    void TransitionImage( voDeviceContext * device, VkImage image, VkImageAspectFlags aspect, VkImageLayout oldLayout, VkImageLayout newLayout );
+
+    /**
+     * @brief Records one-off commands into the graphics command buffer of the batch.
+     *
+     * @details Recorded after the copies and transitions of the batch. The function runs on the calling thread before returning.
+     *
+     * @param device The device context.
+     * @param func Records the commands.
+     */
+    void Record( voDeviceContext * device, const std::function< void( VkCommandBuffer ) > & func );
+
+    /**
+     * @brief Queues an upload that is streamed by `Pump` within the per-frame budget.
+     *
+     * @details The data is copied, it can be released right away. The destination must be a fresh buffer,
+     * and must not be used before the upload is submitted, see `HasQueuedUploads`.
+     */
+    void Enqueue( VkBuffer dstBuffer, VkDeviceSize dstOffset, const void * data, VkDeviceSize size );
+
+    /**
+     * @brief Submits queued uploads up to the per-frame budget and reclaims the staging memory of completed uploads.
+     *
+     * @details Called by the device context at the beginning of every frame.
+     *
+     * @param device The device context.
+     */
+    void Pump( voDeviceContext * device );
+
+    /* -------------------------------------- Tokens ------------------------------------------------------------------- */
+
+    /** @brief Get the token of the batch being collected, the one the next submission will carry */
+    [[nodiscard]] token_t GetToken() const;
+
+    /**
+     * @brief Check if a batch has been executed, without blocking.
+     * @param device The device context.
+     * @param token A token returned by `GetToken`, `Flush` or `EndBatch`.
+     */
+    [[nodiscard]] bool IsComplete( voDeviceContext * device, token_t token );
+
+    /**
+     * @brief Submits the batch if still being collected and waits for it to be executed.
+     * @param device The device context.
+     * @param token A token returned by `GetToken`, `Flush` or `EndBatch`.
+     */
+    void Wait( voDeviceContext * device, token_t token );
+
+    /**
+     * @brief Runs a callback once a batch has been executed.
+     *
+     * @details Callbacks run from `Pump`, on the thread beginning the frames, so they may upload or destroy resources.
+     *
+     * @param token A token returned by `GetToken`, `Flush` or `EndBatch`.
+     * @param callback The function to run.
+     */
+    void OnComplete( token_t token, callback_t && callback );
+
+    /** @brief Check if copies or setup commands are waiting to be submitted */
+    [[nodiscard]] bool HasPendingCopies() const;
+
+    /** @brief Check if uploads queued with `Enqueue` are waiting for a `Pump` */
+    [[nodiscard]] bool HasQueuedUploads() const;
+
+  private:
+    /**
+     * @struct pending_copy_t
+     * @brief A copy from the staging ring into a destination buffer.
+     */
+    struct pending_copy_t
+    {
+        VkBuffer     dstBuffer;
+        VkBufferCopy region;
+        bool         dstInUse; ///< Recorded on the graphics queue
+    };
+
+    /**
+     * @struct pending_image_t
+     * @brief A layout transition of an image, along with a copy from the staging ring.
+     */
+    struct pending_image_t
+    {
+        VkImage                 image;
+        VkImageSubresourceRange range;
+        VkImageLayout           oldLayout;
+        VkImageLayout           newLayout;
+        VkBufferImageCopy       region;
+        bool                    hasCopy; ///< Goes through `VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL`
+    };
+
+    /**
+     * @struct completion_t
+     * @brief A callback waiting for a batch.
+     */
+    struct completion_t
+    {
+        token_t    token;
+        callback_t callback;
+    };
+
+    /**
+     * @struct queued_upload_t
+     * @brief An upload waiting for `Pump`, with its own copy of the data.
+     */
+    struct queued_upload_t
+    {
+        VkBuffer               dstBuffer;
+        VkDeviceSize           dstOffset;
+        VkDeviceSize           consumed; ///< Bytes already submitted
+        std::vector< uint8_t > data;
+    };
+
+    /**
+     * @struct in_flight_t
+     * @brief A submitted batch, its staging memory and command buffers are reused once `value` is reached.
+     */
+    struct in_flight_t
+    {
+        VkDeviceSize    stagingBegin;
+        VkDeviceSize    stagingEnd;
+        uint64_t        value;       ///< Graphics queue timeline value of the batch
+        token_t         token;
+        VkCommandBuffer transferCmd; ///< Copies on the dedicated transfer family
+        VkCommandBuffer graphicsCmd; ///< Ownership acquisitions, copies into buffers in use and images
+        VkCommandBuffer setupCmd;    ///< Commands of `Record`, submitted after the graphics command buffer
+    };
+
+    /**
+     * @brief Reserves space in the staging ring, waiting for in flight batches still reading it.
+     * @param device The device context.
+     * @param size Requested size in bytes.
+     * @return Offset of the reservation inside the ring.
+     */
+    VkDeviceSize Reserve( voDeviceContext * device, VkDeviceSize size );
+
+    /**
+     * @brief Releases the batches that completed on the GPU.
+     * @param device The device context.
+     * @param wait Blocks until the oldest batch completes.
+     */
+    void Retire( voDeviceContext * device, bool wait );
+
+    /**
+     * @brief Records the pending image transitions and copies.
+     * @param cmdBuffer The graphics command buffer of the batch.
+     */
+    void RecordImages( VkCommandBuffer cmdBuffer ) const;
+
+    /**
+     * @brief Runs the callbacks of the retired batches.
+     * @param device The device context.
+     */
+    void RunCallbacks( voDeviceContext * device );
+
+    /** @brief Check if pending copies read the staging ring */
+    [[nodiscard]] bool HasStagedCopies() const;
+
+    /** @brief Allocates a primary command buffer and begins recording it */
+    VkCommandBuffer BeginCommandBuffer( voDeviceContext * device, VkCommandPool pool );
+
+    /**
+     * @brief Records copies sorted by destination, one command per destination buffer.
+     * @param cmdBuffer The command buffer to record into.
+     * @param copies The copies to record.
+     * @param numCopies Number of copies.
+     * @param dstBuffers Receives every destination buffer, once.
+     */
+    void RecordCopies( VkCommandBuffer cmdBuffer, const pending_copy_t * copies, size_t numCopies, std::vector< VkBuffer > & dstBuffers ) const;
+
+    /** @brief Get the pool of the command buffers submitted to the graphics queue */
+    [[nodiscard]] VkCommandPool GetGraphicsPool() const;
+
+    /** @brief Check if the transfer queue belongs to another family than the graphics queue */
+    [[nodiscard]] bool IsOwnershipTransfer() const;
+
+    /* -------------------------------------- Handlers ----------------------------------------------------------------- */
+
+    VkBuffer      m_vkStagingBuffer { VK_NULL_HANDLE };   ///< The staging ring
+    VmaAllocation m_vmaStagingAllocation { VK_NULL_HANDLE };
+    uint8_t *     m_stagingPtr { nullptr };               ///< Persistently mapped pointer to the ring
+    VkDeviceSize  m_stagingSize { 0 };
+    VkDeviceSize  m_stagingHead { 0 };                    ///< Next free byte in the ring
+    VkDeviceSize  m_batchBegin { 0 };                     ///< First byte used by the pending copies
+    VkDeviceSize  m_copyAlignment { 4 };                  ///< Alignment of every reservation
+    VkDeviceSize  m_frameBudget { 0 };
+
+    voQueue *     m_transferQueue { nullptr };
+    voQueue *     m_graphicsQueue { nullptr };
+    VkCommandPool m_vkCommandPool { VK_NULL_HANDLE };     ///< Transfer family
+    VkCommandPool m_vkGraphicsPool { VK_NULL_HANDLE };    ///< Graphics family, only with a dedicated transfer family
+
+    std::vector< pending_copy_t >  m_pendingCopies {};
+    std::vector< pending_image_t > m_pendingImages {};
+    VkCommandBuffer                m_setupCmd { VK_NULL_HANDLE }; ///< Records of the batch, begun by the first `Record`
+    std::vector< completion_t >    m_completions {};
+    token_t                        m_submittedToken { 0 };
+    token_t                        m_retiredToken { 0 };
+    std::deque< queued_upload_t > m_queuedUploads {};
+    std::deque< in_flight_t >     m_inFlight {};          ///< Oldest submission first
+
+    int m_batchDepth { 0 };
+
+    mutable std::recursive_mutex m_mutex; ///< Uploads come from loaders and the render thread, callbacks may upload again
+};
+
+// ======================================================================================================================
+// ============================================ Inline ==================================================================
+// ======================================================================================================================
+
+FORCE_INLINE void
+voUploadContext::BeginBatch()
+{
+    std::lock_guard< std::recursive_mutex > lock( m_mutex );
+    ++m_batchDepth;
+}
+
+FORCE_INLINE voUploadContext::token_t
+voUploadContext::EndBatch( voDeviceContext * device )
+{
+    std::lock_guard< std::recursive_mutex > lock( m_mutex );
+    voAssert( m_batchDepth > 0 );
+
+    if( --m_batchDepth == 0 )
+        {
+            return Flush( device );
+        }
+
+    return GetToken();
+}
+
+FORCE_INLINE bool
+voUploadContext::HasPendingCopies() const
+{
+    std::lock_guard< std::recursive_mutex > lock( m_mutex );
+    return !m_pendingCopies.empty() || !m_pendingImages.empty() || m_setupCmd != VK_NULL_HANDLE;
+}
+
+FORCE_INLINE bool
+voUploadContext::HasStagedCopies() const
+{
+    return !m_pendingCopies.empty() || std::any_of( m_pendingImages.begin(), m_pendingImages.end(), []( const pending_image_t & image ) { return image.hasCopy; } );
+}
+
+FORCE_INLINE voUploadContext::token_t
+voUploadContext::GetToken() const
+{
+    std::lock_guard< std::recursive_mutex > lock( m_mutex );
+    return m_submittedToken + 1;
+}
+
+FORCE_INLINE bool
+voUploadContext::HasQueuedUploads() const
+{
+    std::lock_guard< std::recursive_mutex > lock( m_mutex );
+    return !m_queuedUploads.empty();
+}
+
+FORCE_INLINE bool
+voUploadContext::IsOwnershipTransfer() const
+{
+    return m_transferQueue != m_graphicsQueue;
+}
+
+FORCE_INLINE VkCommandPool
+voUploadContext::GetGraphicsPool() const
+{
+    return IsOwnershipTransfer() ? m_vkGraphicsPool : m_vkCommandPool;
+}
+
+#endif //VULKANO_UPLOADCONTEXT_H
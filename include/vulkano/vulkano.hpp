@@ -4,16 +4,28 @@
 #include "vo_common.hpp"
 
 #include "vo_memory.hpp"
+#include "vo_uploadContext.hpp"
 
 #include "vo_buffer.hpp"
+#include "vo_uniformAllocator.hpp"
 #include "vo_descriptor.hpp"
+#include "vo_descriptorAllocator.hpp"
+#include "vo_bindless.hpp"
 #include "vo_frameBuffer.hpp"
 #include "vo_image.hpp"
 
 #include "vo_deviceContext.hpp"
 #include "vo_swapChain.hpp"
 #include "vo_fence.hpp"
+#include "vo_queue.hpp"
+#include "vo_computeContext.hpp"
+#include "vo_commandAllocator.hpp"
+#include "vo_deletionQueue.hpp"
+#include "vo_jobSystem.hpp"
 #include "vo_pipeline.hpp"
+#include "vo_layoutCache.hpp"
+#include "vo_pipelineCache.hpp"
+#include "vo_pipelineRegistry.hpp"
 
 #include "vo_shader.hpp"
 #include "vo_samplers.hpp"
@@ -21,6 +33,7 @@
 
 #include "vo_window.hpp"
 
+#include "vo_renderThread.hpp"
 #include "vo_renderer.hpp"
 
 #endif // VULKANO_H
@@ -0,0 +1,257 @@
+#include "vulkano/vo_bindless.hpp"
+#include <array>
+#include "vulkano/vo_buffer.hpp"
+#include "vulkano/vo_deviceContext.hpp"
+#include "vulkano/vo_pipeline.hpp"
+
+bool
+voBindless::Create( voDeviceContext * device, const CreateParms_t & parms )
+{
+    if( !device->enabledFeatures.descriptorIndexing )
+        {
+            spdlog::warn( "Descriptor indexing is not supported, bindless mode unavailable" );
+            return false;
+        }
+
+    m_slots[RESOURCE_IMAGE]          = { .capacity = parms.maxImages };
+    m_slots[RESOURCE_SAMPLER]        = { .capacity = parms.maxSamplers };
+    m_slots[RESOURCE_STORAGE_BUFFER] = { .capacity = parms.maxStorageBuffers };
+
+    const std::array< VkDescriptorType, RESOURCE_COUNT > types =
+        {
+            VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
+            VK_DESCRIPTOR_TYPE_SAMPLER,
+            VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+        };
+
+    /* ---------------------------------------- Layout ------------------------------------------------------------------ */
+    {
+        std::array< VkDescriptorSetLayoutBinding, RESOURCE_COUNT > bindings {};
+        std::array< VkDescriptorBindingFlags, RESOURCE_COUNT >     bindingFlags {};
+
+        for( uint32_t i = 0; i < RESOURCE_COUNT; i++ )
+            {
+                bindings[i] =
+                    {
+                        .binding         = i,
+                        .descriptorType  = types[i],
+                        .descriptorCount = m_slots[i].capacity,
+                        .stageFlags      = VK_SHADER_STAGE_ALL,
+                    };
+
+                // Slots are written while the set is bound, and the shaders only read the slots they are given
+                bindingFlags[i] = VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT |
+                                  VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT;
+            }
+
+        VkDescriptorSetLayoutBindingFlagsCreateInfo flagsInfo =
+            {
+                .sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO,
+                .bindingCount  = RESOURCE_COUNT,
+                .pBindingFlags = bindingFlags.data(),
+            };
+
+        VkDescriptorSetLayoutCreateInfo layoutInfo =
+            {
+                .sType        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+                .pNext        = &flagsInfo,
+                .flags        = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT,
+                .bindingCount = RESOURCE_COUNT,
+                .pBindings    = bindings.data(),
+            };
+
+        VK_CHECK( vkCreateDescriptorSetLayout( device->deviceInfo.logical, &layoutInfo, nullptr, &vkDescriptorSetLayout ),
+                  "Failed to create bindless descriptor set layout" );
+
+        vkEmptySetLayout = device->m_layoutCache.GetSetLayout( device, {} );
+    }
+
+    /* ---------------------------------------- Pool and Set ------------------------------------------------------------ */
+    {
+        std::array< VkDescriptorPoolSize, RESOURCE_COUNT > poolSizes {};
+        for( uint32_t i = 0; i < RESOURCE_COUNT; i++ )
+            {
+                poolSizes[i] = { .type = types[i], .descriptorCount = m_slots[i].capacity };
+            }
+
+        VkDescriptorPoolCreateInfo poolInfo =
+            {
+                .sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+                .flags         = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT,
+                .maxSets       = 1,
+                .poolSizeCount = RESOURCE_COUNT,
+                .pPoolSizes    = poolSizes.data(),
+            };
+
+        VK_CHECK( vkCreateDescriptorPool( device->deviceInfo.logical, &poolInfo, nullptr, &vkDescriptorPool ),
+                  "Failed to create bindless descriptor pool" );
+
+        VkDescriptorSetAllocateInfo allocInfo =
+            {
+                .sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+                .descriptorPool     = vkDescriptorPool,
+                .descriptorSetCount = 1,
+                .pSetLayouts        = &vkDescriptorSetLayout,
+            };
+
+        VK_CHECK( vkAllocateDescriptorSets( device->deviceInfo.logical, &allocInfo, &vkDescriptorSet ),
+                  "Failed to allocate bindless descriptor set" );
+    }
+
+    spdlog::info( "Bindless set: {} images, {} samplers, {} storage buffers", parms.maxImages, parms.maxSamplers, parms.maxStorageBuffers );
+
+    return true;
+}
+
+void
+voBindless::Cleanup( voDeviceContext * device )
+{
+    // The set goes along with its pool
+    vkDestroyDescriptorPool( device->deviceInfo.logical, vkDescriptorPool, nullptr );
+    vkDestroyDescriptorSetLayout( device->deviceInfo.logical, vkDescriptorSetLayout, nullptr );
+
+    vkDescriptorPool      = VK_NULL_HANDLE;
+    vkDescriptorSetLayout = VK_NULL_HANDLE;
+    vkEmptySetLayout      = VK_NULL_HANDLE;
+    vkDescriptorSet       = VK_NULL_HANDLE;
+
+    std::lock_guard< std::mutex > lock( m_mutex );
+    for( slots_t & slots : m_slots )
+        {
+            slots = {};
+        }
+}
+
+uint32_t
+voBindless::AddImage( voDeviceContext * device, VkImageView imageView, VkImageLayout imageLayout )
+{
+    const uint32_t index = AllocateSlot( RESOURCE_IMAGE );
+    if( index == INVALID_INDEX )
+        {
+            return INVALID_INDEX;
+        }
+
+    VkDescriptorImageInfo imageInfo =
+        {
+            .imageView   = imageView,
+            .imageLayout = imageLayout,
+        };
+
+    VkWriteDescriptorSet write =
+        {
+            .sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .dstSet          = vkDescriptorSet,
+            .dstBinding      = RESOURCE_IMAGE,
+            .dstArrayElement = index,
+            .descriptorCount = 1,
+            .descriptorType  = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
+            .pImageInfo      = &imageInfo,
+        };
+
+    vkUpdateDescriptorSets( device->deviceInfo.logical, 1, &write, 0, nullptr );
+
+    return index;
+}
+
+uint32_t
+voBindless::AddSampler( voDeviceContext * device, VkSampler sampler )
+{
+    const uint32_t index = AllocateSlot( RESOURCE_SAMPLER );
+    if( index == INVALID_INDEX )
+        {
+            return INVALID_INDEX;
+        }
+
+    VkDescriptorImageInfo imageInfo =
+        {
+            .sampler = sampler,
+        };
+
+    VkWriteDescriptorSet write =
+        {
+            .sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .dstSet          = vkDescriptorSet,
+            .dstBinding      = RESOURCE_SAMPLER,
+            .dstArrayElement = index,
+            .descriptorCount = 1,
+            .descriptorType  = VK_DESCRIPTOR_TYPE_SAMPLER,
+            .pImageInfo      = &imageInfo,
+        };
+
+    vkUpdateDescriptorSets( device->deviceInfo.logical, 1, &write, 0, nullptr );
+
+    return index;
+}
+
+uint32_t
+voBindless::AddStorageBuffer( voDeviceContext * device, voBuffer * storageBuffer, VkDeviceSize offset, VkDeviceSize size )
+{
+    const uint32_t index = AllocateSlot( RESOURCE_STORAGE_BUFFER );
+    if( index == INVALID_INDEX )
+        {
+            return INVALID_INDEX;
+        }
+
+    VkDescriptorBufferInfo bufferInfo =
+        {
+            .buffer = storageBuffer->vkBuffer,
+            .offset = offset,
+            .range  = size,
+        };
+
+    VkWriteDescriptorSet write =
+        {
+            .sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .dstSet          = vkDescriptorSet,
+            .dstBinding      = RESOURCE_STORAGE_BUFFER,
+            .dstArrayElement = index,
+            .descriptorCount = 1,
+            .descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .pBufferInfo     = &bufferInfo,
+        };
+
+    vkUpdateDescriptorSets( device->deviceInfo.logical, 1, &write, 0, nullptr );
+
+    return index;
+}
+
+void
+voBindless::Remove( voDeviceContext * device, resource_t resource, uint32_t index )
+{
+    voAssert( resource < RESOURCE_COUNT && index < m_slots[resource].capacity && "Invalid bindless index" );
+
+    // The frames in flight may still read the slot, it is not written again before they are done
+    device->m_deletionQueue.Destroy( [this, resource, index]( voDeviceContext * )
+                                     {
+                                         std::lock_guard< std::mutex > lock( m_mutex );
+                                         m_slots[resource].freeList.push_back( index );
+                                     } );
+}
+
+void
+voBindless::BindDescriptor( VkCommandBuffer vkCommandBuffer, voPipeline * pso ) const
+{
+    vkCmdBindDescriptorSets( vkCommandBuffer, pso->vkBindPoint, pso->vkPipelineLayout, SET_INDEX, 1, &vkDescriptorSet, 0, nullptr );
+}
+
+uint32_t
+voBindless::AllocateSlot( resource_t resource )
+{
+    std::lock_guard< std::mutex > lock( m_mutex );
+    slots_t &                     slots = m_slots[resource];
+
+    if( !slots.freeList.empty() )
+        {
+            const uint32_t index = slots.freeList.back();
+            slots.freeList.pop_back();
+            return index;
+        }
+
+    if( slots.numUsed == slots.capacity )
+        {
+            spdlog::error( "Bindless array {} is full, {} slots", static_cast< int >( resource ), slots.capacity );
+            return INVALID_INDEX;
+        }
+
+    return slots.numUsed++;
+}
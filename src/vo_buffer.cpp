@@ -1,29 +1,46 @@
 #include "vulkano/vo_buffer.hpp"
 #include <cstring>
 
+/**
+ * Writes host visible memory in place, the range must not be in use by the device.
+ */
+static void
+WriteInPlace( voDeviceContext * device, const voBuffer & buffer, VkDeviceSize offset, const void * data, VkDeviceSize size )
+{
+    // Persistent buffers return their mapped pointer, without mapping again
+    auto * memory = static_cast< uint8_t * >( buffer.MapBuffer( device ) );
+    memcpy( memory + offset, data, size );
+    buffer.UnmapBuffer( device );
+
+    if ( !buffer.IsHostCoherent() )
+    {
+        device->m_memory->FlushMemory( buffer.vmaAllocation, offset, size );
+    }
+}
+
 bool
-voBuffer::Allocate(voDeviceContext * device, const void * data, int size, VkBufferUsageFlagBits usageFlags )
+voBuffer::Create( voDeviceContext * device, const CreateParms_t & parms, const void * data )
 {
-    vkBufferSize = size;
+    vkBufferSize = parms.size;
 
-    /* ----------------------------------------- Create Buffer ---------------------------------------------------------- */
+    /* ----------------------------------------- Create Buffer and Allocate Memory -------------------------------------- */
     {
         VkBufferCreateInfo bufferInfo =
         {
             .sType       = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
             .size        = vkBufferSize,                         // Size of buffer (size of 1 vertex * number of vertices)
-            .usage       = usageFlags,                           // Multiple types of buffer possible
+            .usage       = parms.usageFlags,                     // Multiple types of buffer possible
             .sharingMode = VK_SHARING_MODE_EXCLUSIVE,            // Similar to Swap Chain images. Can share buffers (?)
         };
 
-        VK_CHECK( vkCreateBuffer( device->deviceInfo.logical, &bufferInfo, nullptr, &vkBuffer ),
-                  "Failed to create buffer" );
-    }
-
-    /* ----------------------------------------- Get Buffer Memory Requirements ----------------------------------------- */
-    {
-        VkMemoryRequirements memRequirements;
-        vkGetBufferMemoryRequirements( device->deviceInfo.logical, vkBuffer, &memRequirements );
+        // Buffers written by async compute and read by graphics (or the other way around) are shared by both families
+        uint32_t families[2];
+        if ( parms.concurrent && device->GetConcurrentFamilies( families ) > 1 )
+        {
+            bufferInfo.sharingMode           = VK_SHARING_MODE_CONCURRENT;
+            bufferInfo.queueFamilyIndexCount = 2;
+            bufferInfo.pQueueFamilyIndices   = families;
+        }
 
        /**
         * 1. VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT: Allocated memory is accessible by the host CPU.
@@ -32,32 +49,123 @@ voBuffer::Allocate(voDeviceContext * device, const void * data, int size, VkBuff
         * 2. VK_MEMORY_PROPERTY_HOST_COHERENT_BIT: Ensures simultaneous access to this memory by the host and the device.
         *    It also eliminates the need for explicit flushing or invalidating to synchronize the host and device views of the memory.
         *
-        * In summary, we're allocating memory that the host can directly interact with and doesn't require manual synchronization.
+        * The memory itself is sub-allocated by voMemory from a block shared with other resources of the same class.
         */
-        vkMemoryPropertyFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
-
-        VkMemoryAllocateInfo allocInfo =
+        voMemory::AllocationParms_t allocParms =
         {
-            .sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
-            .allocationSize  = memRequirements.size,
-            .memoryTypeIndex = device->FindMemoryTypeIndex( memRequirements.memoryTypeBits, vkMemoryPropertyFlags ),
+            .memoryClass   = parms.memoryClass,
+            .flags         = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT,
+            .requiredFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+            .dedicated     = parms.dedicated == 1,
         };
 
-        VK_CHECK( vkAllocateMemory( device->deviceInfo.logical, &allocInfo, nullptr, &vkBufferMemory ),
-                  "Failed to allocate buffer memory" );
+       /**
+        * Device local buffers prefer DEVICE_LOCAL memory and still ask for host access.
+        * VMA hands out host visible device local memory when the device exposes it (ReBAR, integrated GPUs),
+        * otherwise plain device local memory, which is then filled through a transfer.
+        */
+        if ( parms.deviceLocal )
+        {
+            bufferInfo.usage        |= VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+            allocParms.usage         = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE;
+            allocParms.flags        |= VMA_ALLOCATION_CREATE_HOST_ACCESS_ALLOW_TRANSFER_INSTEAD_BIT;
+            allocParms.requiredFlags = 0;
+        }
+
+       /**
+        * Persistent buffers are mapped once by the allocator and never unmapped.
+        * Coherency is not required since writes are flushed explicitly, which opens up cached memory types.
+        */
+        if ( parms.persistent )
+        {
+            allocParms.flags        |= VMA_ALLOCATION_CREATE_MAPPED_BIT;
+            allocParms.requiredFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+
+            if ( parms.cached )
+            {
+                allocParms.flags          = ( allocParms.flags & ~VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT ) | VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT;
+                allocParms.preferredFlags = VK_MEMORY_PROPERTY_HOST_CACHED_BIT;
+            }
+        }
+
+        VmaAllocationInfo allocationInfo {};
+        VK_CHECK( device->m_memory->CreateBuffer( bufferInfo, allocParms, vkBuffer, vmaAllocation, &allocationInfo ),
+                  "Failed to create buffer" );
+
+        vkMemoryPropertyFlags = device->m_memory->GetMemoryProperties( vmaAllocation );
+        vkUsageFlags          = bufferInfo.usage;
+        mappedData            = parms.persistent ? allocationInfo.pMappedData : nullptr;
     }
 
-    /* ----------------------------------------- Allocate Memory to Buffer ----------------------------------------- */
+    /* ----------------------------------------- Upload Initial Data ---------------------------------------------------- */
     {
-        if ( data != NULL )
+        if ( data != NULL && IsHostVisible() )
         {
-            void * memory = MapBuffer( device );
-            memcpy( memory, data, size );
-            UnmapBuffer( device );
+            // Nothing reads the buffer yet
+            WriteInPlace( device, *this, 0, data, vkBufferSize );
+        }
+        else if ( data != NULL )
+        {
+            // Nothing reads the buffer yet, the copy can run on the transfer queue.
+            // Concurrent buffers are not owned by a single family, they are filled on the graphics queue instead.
+            device->m_uploadContext.UploadBuffer( device, vkBuffer, 0, data, vkBufferSize, parms.concurrent == 1 );
         }
-
-        vkBindBufferMemory( device->deviceInfo.logical, vkBuffer, vkBufferMemory, 0 );
     }
 
     return true;
 }
+
+bool
+voBuffer::Allocate( voDeviceContext * device, const void * data, VkDeviceSize size, VkBufferUsageFlags usageFlags )
+{
+    CreateParms_t parms =
+    {
+        .size        = size,
+        .usageFlags  = usageFlags,
+        .memoryClass = voMemory::MEMORY_CLASS_DEFAULT,
+    };
+
+    if ( usageFlags & ( VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT ) )
+    {
+        parms.memoryClass = voMemory::MEMORY_CLASS_GEOMETRY;
+        parms.deviceLocal = true;
+    }
+
+    return Create( device, parms, data );
+}
+
+void
+voBuffer::Update( voDeviceContext * device, VkDeviceSize offset, const void * data, VkDeviceSize size )
+{
+    voAssert( offset + size <= vkBufferSize );
+
+    if ( size == 0 )
+    {
+        return;
+    }
+
+    // Frames in flight may still read the range, the staged copy is ordered after them (ReBAR and UMA included)
+    if ( vkUsageFlags & VK_BUFFER_USAGE_TRANSFER_DST_BIT )
+    {
+        device->m_uploadContext.UploadBuffer( device, vkBuffer, offset, data, size );
+        return;
+    }
+
+    voAssert( IsHostVisible() && "Buffer neither host visible nor a transfer destination" );
+    WriteInPlace( device, *this, offset, data, size );
+}
+
+void
+voBuffer::FlushDirty( voDeviceContext * device )
+{
+    if ( dirtyBegin >= dirtyEnd )
+    {
+        return;
+    }
+
+    // VMA rounds the range out to nonCoherentAtomSize
+    device->m_memory->FlushMemory( vmaAllocation, dirtyBegin, dirtyEnd - dirtyBegin );
+
+    dirtyBegin = VK_WHOLE_SIZE;
+    dirtyEnd   = 0;
+}
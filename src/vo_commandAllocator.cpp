@@ -0,0 +1,174 @@
+#include "vulkano/vo_commandAllocator.hpp"
+#include <algorithm>
+#include "vulkano/vo_deviceContext.hpp"
+
+bool
+voCommandAllocator::Create( voDeviceContext * device, const CreateParms_t & parms )
+{
+    m_numThreads = std::max( parms.numThreads, 1U );
+    m_frameIndex = 0;
+
+    m_pools.resize( static_cast< size_t >( m_numThreads ) * std::max( parms.numFrames, 1U ) );
+
+    // Pools are reset as a whole every frame, command buffers are not reset one by one
+    VkCommandPoolCreateInfo poolInfo =
+        {
+            .sType            = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+            .flags            = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+            .queueFamilyIndex = parms.queueFamily,
+        };
+
+    for( pool_t & pool : m_pools )
+        {
+            VK_CHECK( vkCreateCommandPool( device->deviceInfo.logical, &poolInfo, nullptr, &pool.vkCommandPool ),
+                      "Failed to create thread command pool" );
+        }
+
+    return true;
+}
+
+void
+voCommandAllocator::Cleanup( voDeviceContext * device )
+{
+    // Command buffers are released along with their pool
+    for( pool_t & pool : m_pools )
+        {
+            vkDestroyCommandPool( device->deviceInfo.logical, pool.vkCommandPool, nullptr );
+        }
+
+    m_pools.clear();
+    m_numThreads = 0;
+}
+
+void
+voCommandAllocator::BeginFrame( voDeviceContext * device, uint32_t frameIndex )
+{
+    voAssert( ( frameIndex + 1 ) * m_numThreads <= m_pools.size() && "Not enough command pools for the frames in flight" );
+
+    m_frameIndex = frameIndex;
+
+    for( uint32_t thread = 0; thread < m_numThreads; thread++ )
+        {
+            pool_t & pool = m_pools[frameIndex * m_numThreads + thread];
+
+            if( pool.numUsed[0] + pool.numUsed[1] == 0 )
+                {
+                    continue;
+                }
+
+            VK_CHECK( vkResetCommandPool( device->deviceInfo.logical, pool.vkCommandPool, 0 ),
+                      "Failed to reset thread command pool" );
+
+            pool.numUsed[0] = 0;
+            pool.numUsed[1] = 0;
+        }
+}
+
+VkCommandBuffer
+voCommandAllocator::Allocate( voDeviceContext * device, uint32_t threadIndex, VkCommandBufferLevel level )
+{
+    voAssert( threadIndex < m_numThreads && "Thread index out of range" );
+
+    pool_t &                         pool       = m_pools[m_frameIndex * m_numThreads + threadIndex];
+    const size_t                     levelIndex = ( level == VK_COMMAND_BUFFER_LEVEL_PRIMARY ) ? 0 : 1;
+    std::vector< VkCommandBuffer > & cmdBuffers = pool.cmdBuffers[levelIndex];
+
+    // The pool grows to the busiest frame, then its command buffers are recycled
+    if( pool.numUsed[levelIndex] == cmdBuffers.size() )
+        {
+            VkCommandBufferAllocateInfo allocInfo =
+                {
+                    .sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+                    .commandPool        = pool.vkCommandPool,
+                    .level              = level,
+                    .commandBufferCount = 1,
+                };
+
+            VkCommandBuffer cmdBuffer;
+            VK_CHECK( vkAllocateCommandBuffers( device->deviceInfo.logical, &allocInfo, &cmdBuffer ),
+                      "Failed to allocate thread command buffer" );
+
+            cmdBuffers.push_back( cmdBuffer );
+        }
+
+    return cmdBuffers[pool.numUsed[levelIndex]++];
+}
+
+VkCommandBuffer
+voCommandAllocator::BeginSecondary( voDeviceContext * device, uint32_t threadIndex, const inheritance_t & inheritance )
+{
+    VkCommandBuffer cmdBuffer = Allocate( device, threadIndex, VK_COMMAND_BUFFER_LEVEL_SECONDARY );
+
+    VkCommandBufferInheritanceInfo inheritanceInfo =
+        {
+            .sType       = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO,
+            .renderPass  = inheritance.renderPass,
+            .subpass     = inheritance.subpass,
+            .framebuffer = inheritance.framebuffer,
+        };
+
+    VkCommandBufferBeginInfo beginInfo =
+        {
+            .sType            = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+            .flags            = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT,
+            .pInheritanceInfo = &inheritanceInfo,
+        };
+
+    VK_CHECK( vkBeginCommandBuffer( cmdBuffer, &beginInfo ),
+              "Failed to begin secondary command buffer" );
+
+    /* ------------------------------------------------ Dynamic State ---------------------------------------------------- */
+    {
+        VkViewport viewport =
+            {
+                .x        = 0.0F,
+                .y        = 0.0F,
+                .width    = static_cast< float >( inheritance.extent.width ),
+                .height   = static_cast< float >( inheritance.extent.height ),
+                .minDepth = 0.0F,
+                .maxDepth = 1.0F,
+            };
+        vkCmdSetViewport( cmdBuffer, 0, 1, &viewport );
+
+        VkRect2D scissor =
+            {
+                .offset = { 0, 0 },
+                .extent = inheritance.extent,
+            };
+        vkCmdSetScissor( cmdBuffer, 0, 1, &scissor );
+
+        if( inheritance.depthBiasConstant != 0.0F || inheritance.depthBiasSlope != 0.0F )
+            {
+                vkCmdSetDepthBias( cmdBuffer, inheritance.depthBiasConstant, 0.0F, inheritance.depthBiasSlope );
+            }
+    }
+
+    return cmdBuffer;
+}
+
+void
+voCommandAllocator::EndSecondary( VkCommandBuffer cmdBuffer )
+{
+    VK_CHECK( vkEndCommandBuffer( cmdBuffer ),
+              "Failed to end secondary command buffer" );
+}
+
+void
+voCommandAllocator::Execute( VkCommandBuffer primary, size_t numCmdBuffers, const VkCommandBuffer * cmdBuffers )
+{
+    std::vector< VkCommandBuffer > secondaries;
+    secondaries.reserve( numCmdBuffers );
+
+    for( size_t i = 0; i < numCmdBuffers; i++ )
+        {
+            if( cmdBuffers[i] != VK_NULL_HANDLE )
+                {
+                    secondaries.push_back( cmdBuffers[i] );
+                }
+        }
+
+    if( !secondaries.empty() )
+        {
+            vkCmdExecuteCommands( primary, static_cast< uint32_t >( secondaries.size() ), secondaries.data() );
+        }
+}
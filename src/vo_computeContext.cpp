@@ -0,0 +1,120 @@
+#include "vulkano/vo_computeContext.hpp"
+#include <algorithm>
+#include "vulkano/vo_deviceContext.hpp"
+
+bool
+voComputeContext::Create( voDeviceContext * device, const CreateParms_t & parms )
+{
+    m_queue   = device->GetComputeQueue();
+    m_isAsync = device->queueIds.HasDedicatedCompute();
+    m_current = 0;
+
+    /* ------------------------------------------------ Command Pool ---------------------------------------------------- */
+    {
+        VkCommandPoolCreateInfo poolInfo =
+            {
+                .sType            = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+                .flags            = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,
+                .queueFamilyIndex = m_queue->GetFamily(),
+            };
+
+        VK_CHECK( vkCreateCommandPool( device->deviceInfo.logical, &poolInfo, nullptr, &m_vkCommandPool ),
+                  "Failed to create compute command pool" );
+    }
+
+    /* ------------------------------------------------ Command Buffers ------------------------------------------------- */
+    {
+        std::vector< VkCommandBuffer > cmdBuffers( std::max( parms.numCommandBuffers, 1U ) );
+
+        VkCommandBufferAllocateInfo allocInfo =
+            {
+                .sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+                .commandPool        = m_vkCommandPool,
+                .level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+                .commandBufferCount = static_cast< uint32_t >( cmdBuffers.size() ),
+            };
+
+        VK_CHECK( vkAllocateCommandBuffers( device->deviceInfo.logical, &allocInfo, cmdBuffers.data() ),
+                  "Failed to allocate compute command buffers" );
+
+        m_passes.clear();
+        for( VkCommandBuffer cmdBuffer : cmdBuffers )
+            {
+                m_passes.push_back( { cmdBuffer, 0 } );
+            }
+    }
+
+    return true;
+}
+
+void
+voComputeContext::Cleanup( voDeviceContext * device )
+{
+    if( m_vkCommandPool == VK_NULL_HANDLE )
+        {
+            return;
+        }
+
+    voAssert( !m_isRecording );
+
+    for( const pass_t & pass : m_passes )
+        {
+            m_queue->Wait( device, pass.value );
+        }
+
+    // Command buffers are released along with their pool
+    vkDestroyCommandPool( device->deviceInfo.logical, m_vkCommandPool, nullptr );
+
+    m_vkCommandPool = VK_NULL_HANDLE;
+    m_passes.clear();
+}
+
+VkCommandBuffer
+voComputeContext::Begin( voDeviceContext * device )
+{
+    voAssert( !m_isRecording && "Compute pass already being recorded" );
+
+    pass_t & pass = m_passes[m_current];
+
+    // The ring wrapped around, the command buffer may still be executing
+    m_queue->Wait( device, pass.value );
+
+    VkCommandBufferBeginInfo beginInfo =
+        {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+            .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+        };
+
+    VK_CHECK( vkResetCommandBuffer( pass.cmdBuffer, 0 ),
+              "Failed to reset compute command buffer" );
+    VK_CHECK( vkBeginCommandBuffer( pass.cmdBuffer, &beginInfo ),
+              "Failed to begin compute command buffer" );
+
+    m_isRecording = true;
+    return pass.cmdBuffer;
+}
+
+uint64_t
+voComputeContext::Submit( voDeviceContext * device, uint32_t numWaits, const voQueue::wait_t * waits )
+{
+    voAssert( m_isRecording && "No compute pass being recorded" );
+
+    pass_t & pass = m_passes[m_current];
+
+    VK_CHECK( vkEndCommandBuffer( pass.cmdBuffer ),
+              "Failed to end compute command buffer" );
+
+    voQueue::submit_t submit =
+        {
+            .numCommandBuffers = 1,
+            .commandBuffers    = &pass.cmdBuffer,
+            .numWaits          = numWaits,
+            .waits             = waits,
+        };
+
+    pass.value    = m_queue->Submit( device, submit );
+    m_current     = ( m_current + 1 ) % static_cast< uint32_t >( m_passes.size() );
+    m_isRecording = false;
+
+    return pass.value;
+}
@@ -0,0 +1,92 @@
+#include "vulkano/vo_deletionQueue.hpp"
+#include <algorithm>
+#include <iterator>
+#include "vulkano/vo_deviceContext.hpp"
+
+void
+voDeletionQueue::Destroy( deleter_t && deleter )
+{
+    Destroy( nullptr, 0, std::move( deleter ) );
+}
+
+void
+voDeletionQueue::Destroy( voQueue * queue, uint64_t value, deleter_t && deleter )
+{
+    std::lock_guard< std::mutex > lock( m_mutex );
+    m_entries.push_back( { queue, value, std::move( deleter ) } );
+}
+
+void
+voDeletionQueue::Stamp( voQueue * queue, uint64_t value )
+{
+    std::lock_guard< std::mutex > lock( m_mutex );
+
+    for( entry_t & entry : m_entries )
+        {
+            if( entry.queue == nullptr )
+                {
+                    entry.queue = queue;
+                    entry.value = value;
+                }
+        }
+}
+
+void
+voDeletionQueue::Collect( voDeviceContext * device )
+{
+    std::vector< entry_t > completed;
+
+    {
+        std::lock_guard< std::mutex > lock( m_mutex );
+
+        // Entries are keyed on several queues, they are not ordered
+        const auto isPending = [&]( const entry_t & entry ) { return entry.queue == nullptr || !entry.queue->IsComplete( device, entry.value ); };
+        const auto end       = std::stable_partition( m_entries.begin(), m_entries.end(), isPending );
+
+        std::move( end, m_entries.end(), std::back_inserter( completed ) );
+        m_entries.erase( end, m_entries.end() );
+    }
+
+    // Deleters run outside of the lock, they may release other objects
+    for( entry_t & entry : completed )
+        {
+            entry.deleter( device );
+        }
+}
+
+void
+voDeletionQueue::Flush( voDeviceContext * device )
+{
+    // Deleters may queue other objects, the last reference of a pipeline for instance, flushed until none is left
+    while( true )
+        {
+            std::vector< entry_t > entries;
+
+            {
+                std::lock_guard< std::mutex > lock( m_mutex );
+                entries.swap( m_entries );
+            }
+
+            if( entries.empty() )
+                {
+                    return;
+                }
+
+            for( entry_t & entry : entries )
+                {
+                    if( entry.queue != nullptr )
+                        {
+                            entry.queue->Wait( device, entry.value );
+                        }
+
+                    entry.deleter( device );
+                }
+        }
+}
+
+size_t
+voDeletionQueue::GetNumEntries()
+{
+    std::lock_guard< std::mutex > lock( m_mutex );
+    return m_entries.size();
+}
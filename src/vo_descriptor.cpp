@@ -1,9 +1,47 @@
 #include "vulkano/vo_descriptor.hpp"
 #include "vulkano/vo_pipeline.hpp"
 #include "vulkano/vo_buffer.hpp"
+#include "vulkano/vo_shader.hpp"
 #include "vo_utilities.hpp"
+#include <algorithm>
 #include <vector>
 #include <cassert>
+#include <cstddef>
+
+#ifndef DESCRIPTOR_CACHE_SIZE
+#    define DESCRIPTOR_CACHE_SIZE 1024
+#endif /** DESCRIPTOR_CACHE_SIZE */
+
+#ifndef DESCRIPTOR_CACHE_POOL_SETS
+#    define DESCRIPTOR_CACHE_POOL_SETS 256
+#endif /** DESCRIPTOR_CACHE_POOL_SETS */
+
+/**
+ * FNV-1a over the words of a cache key, finalized so the low bits depend on every word.
+ */
+static uint64_t
+HashKey( const uint64_t * key, uint32_t numWords )
+{
+    uint64_t hash = 14695981039346656037ULL;
+
+    for ( uint32_t i = 0; i < numWords; ++i )
+    {
+        hash ^= key[ i ];
+        hash *= 1099511628211ULL;
+    }
+
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+
+    return hash;
+}
+
+/**
+ * Every created `voDescriptors`, searched for the sets holding a resource about to be destroyed.
+ */
+static std::mutex                     s_liveMutex;
+static std::vector< voDescriptors * > s_liveDescriptors;
 
 
 // ======================================================================================================================
@@ -13,96 +51,150 @@
 
 voDescriptor::voDescriptor()
     : m_parent( NULL )
-    , m_id( -1 )
     , m_numImages( 0 )
     , m_numBuffers( 0 )
+    , m_numStorageBuffers( 0 )
+    , m_numStorageImages( 0 )
+{
+    memset( &m_bindings, 0, sizeof( bindings_t ) );
+}
+
+/**
+ * True for the descriptors read from a buffer info, false for the ones read from an image info.
+ */
+static bool
+IsBufferDescriptor( VkDescriptorType type )
 {
-    memset( m_bufferInfo, 0, sizeof( VkDescriptorBufferInfo ) * MAX_BUFFERS );
-    memset( m_imageInfo, 0, sizeof( VkDescriptorImageInfo ) * MAX_IMAGEINFO );
+    return type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER || type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC ||
+           type == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER || type == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
+}
+
+/**
+ * Updates a buffer info, returns true if it changed.
+ */
+static bool
+SetBufferInfo( VkDescriptorBufferInfo & info, VkBuffer buffer, VkDeviceSize offset, VkDeviceSize size )
+{
+    if ( info.buffer == buffer && info.offset == offset && info.range == size )
+    {
+        return false;
+    }
+
+    info =
+    {
+        .buffer = buffer,
+        .offset = offset,
+        .range  = size,
+    };
+
+    return true;
 }
 
 void
 voDescriptor::BindImage( VkImageLayout imageLayout, VkImageView imageView, VkSampler sampler, int slot )
 {
     assert( slot < MAX_IMAGEINFO );
-    assert( m_numImages < MAX_IMAGEINFO );
 
-    m_imageInfo[ slot ] =
+    m_bindings.images[ slot ] =
     {
         .sampler     = sampler,
         .imageView   = imageView,
         .imageLayout = imageLayout,
     };
 
-    ++m_numImages;
+    m_numImages = std::max( m_numImages, slot + 1 );
+    m_dirty     = true;
 }
 
 void
 voDescriptor::BindBuffer( voBuffer * uniformBuffer, VkDeviceSize offset, VkDeviceSize size, int slot )
 {
     assert( slot < MAX_BUFFERS );
-    assert( m_numBuffers < MAX_BUFFERS );
 
-    m_bufferInfo[ slot ] =
+    // Dynamic slots are written at offset zero, their offset is given at bind time
+    const bool isDynamic = m_parent != nullptr && ( m_parent->m_parms.dynamicUniforms & ( 1U << slot ) ) != 0;
+    if ( isDynamic )
     {
-        .buffer = uniformBuffer->vkBuffer,
-        .offset = offset,
-        .range  = size,
-    };
+        m_dynamicOffsets[ slot ] = static_cast< uint32_t >( offset );
+    }
+
+    if ( SetBufferInfo( m_bindings.buffers[ slot ], uniformBuffer->vkBuffer, isDynamic ? 0 : offset, size ) )
+    {
+        m_dirty = true;
+    }
 
-    ++m_numBuffers;
+    m_numBuffers = std::max( m_numBuffers, slot + 1 );
 }
 
 void
-voDescriptor::BindDescriptor( voDeviceContext * device, VkCommandBuffer vkCommandBuffer, voPipeline * pso )
+voDescriptor::BindStorageBuffer( voBuffer * storageBuffer, VkDeviceSize offset, VkDeviceSize size, int slot )
 {
-    const uint32_t numDescriptors = m_numImages + m_numBuffers;
+    assert( slot < MAX_BUFFERS );
+
+    const bool isDynamic = m_parent != nullptr && ( m_parent->m_parms.dynamicStorageBuffers & ( 1U << slot ) ) != 0;
+    if ( isDynamic )
+    {
+        m_dynamicStorageOffsets[ slot ] = static_cast< uint32_t >( offset );
+    }
 
-    // Describe the connection between a binding and a buffer.
-    // How a buffer is going to connect to a descriptor set.
+    if ( SetBufferInfo( m_bindings.storageBuffers[ slot ], storageBuffer->vkBuffer, isDynamic ? 0 : offset, size ) )
+    {
+        m_dirty = true;
+    }
 
-    /* ----------------------------------------- Allocate descriptors ----------------------------------------- */
-    const uint32_t allocationSize = sizeof( VkWriteDescriptorSet ) * numDescriptors;
-    VkWriteDescriptorSet * descriptorWrites = reinterpret_cast< VkWriteDescriptorSet * >( alloca( allocationSize ) );
-    memset( descriptorWrites, 0, allocationSize );
+    m_numStorageBuffers = std::max( m_numStorageBuffers, slot + 1 );
+}
+
+void
+voDescriptor::BindStorageImage( VkImageView imageView, int slot )
+{
+    assert( slot < MAX_IMAGEINFO );
 
-    /* ----------------------------------------- Descriptor Write Information ---------------------------------- */
+    // Storage images are accessed without a sampler, in the general layout
+    m_bindings.storageImages[ slot ] =
     {
-        uint32_t idx = 0;
+        .sampler     = VK_NULL_HANDLE,
+        .imageView   = imageView,
+        .imageLayout = VK_IMAGE_LAYOUT_GENERAL,
+    };
 
-        for ( size_t i = 0; i < m_numBuffers; ++i, ++idx )
-        {
-            descriptorWrites[ idx ] =
-            {
-                .sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-                .dstSet          = m_parent->vkDescriptorSets[ m_id ], // Descriptor set target
-                .dstBinding      = idx,                                // Binding to update (matches with binding on layout/shader)
-                .dstArrayElement = 0,                                  // Index in array to update
-                .descriptorCount = 1,                                  // Amount to update
-                .descriptorType  = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,  // Type of descriptor
-                .pBufferInfo     = &m_bufferInfo[ i ],                 // Information about buffer data to bind
-            };
-        }
+    m_numStorageImages = std::max( m_numStorageImages, slot + 1 );
+    m_dirty            = true;
+}
+
+void
+voDescriptor::BindDescriptor( voDeviceContext * device, VkCommandBuffer vkCommandBuffer, voPipeline * pso )
+{
+    // No set at all, the resources are recorded along with the draw
+    if ( m_parent->m_pushDescriptors )
+    {
+        m_parent->PushDescriptor( vkCommandBuffer, pso, m_bindings );
+        return;
+    }
+
+    if ( m_parent->m_parms.transient )
+    {
+        // Written on every bind into a set of the frame, the sets of earlier frames are reset with their pools
+        m_vkDescriptorSet = device->m_descriptorAllocator.Allocate( device, m_parent->vkDescriptorSetLayout, m_parent->m_setUsage );
 
-        for ( size_t i = 0; i < m_numImages; ++i, ++idx )
+        // The template reads the whole set from the bindings
+        if ( m_parent->vkUpdateTemplate != VK_NULL_HANDLE )
         {
-            descriptorWrites[ idx ] =
-            {
-                .sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-                .dstSet          = m_parent->vkDescriptorSets[ m_id ],
-                .dstBinding      = idx,
-                .dstArrayElement = 0,
-                .descriptorCount = 1,
-                .descriptorType  = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-                .pImageInfo      = &m_imageInfo[ i ],
-            };
+            vkUpdateDescriptorSetWithTemplate( device->deviceInfo.logical, m_vkDescriptorSet, m_parent->vkUpdateTemplate, &m_bindings );
         }
     }
+    else if ( m_dirty || m_vkDescriptorSet == VK_NULL_HANDLE || m_cacheGeneration != m_parent->m_cacheGeneration.load( std::memory_order_acquire ) )
+    {
+        // Only the dynamic offsets moved otherwise, the set picked last time still holds the resources unless it was evicted
+        m_cacheGeneration = m_parent->m_cacheGeneration.load( std::memory_order_acquire );
+        m_vkDescriptorSet = m_parent->GetCachedSet( device, m_bindings );
+        m_dirty           = false;
+    }
 
-    /* ----------------------------------------- Update & Bind ------------------------------------------------- */
+    uint32_t       dynamicOffsets[ MAX_BUFFERS * 2 ];
+    const uint32_t numDynamicOffsets = m_parent->GetDynamicOffsets( *this, dynamicOffsets );
 
-    vkUpdateDescriptorSets( device->deviceInfo.logical, numDescriptors, descriptorWrites, 0, nullptr );
-    vkCmdBindDescriptorSets( vkCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pso->vkPipelineLayout, 0, 1, &m_parent->vkDescriptorSets[ m_id ], 0, nullptr );
+    vkCmdBindDescriptorSets( vkCommandBuffer, pso->vkBindPoint, pso->vkPipelineLayout, 0, 1, &m_vkDescriptorSet, numDynamicOffsets, dynamicOffsets );
 }
 
 
@@ -115,110 +207,479 @@ void voDescriptors::Create(voDeviceContext *device, const voDescriptors::CreateP
 {
     m_parms = parms;
 
-    const uint32_t numUniforms = parms.numUniformsFragment + parms.numUniformsVertex;
-
-    /* ---------------------------------------- Descriptor Pool --------------------------------------------------------- */
     {
-        std::vector< VkDescriptorPoolSize > poolSizes { };
+        std::lock_guard< std::mutex > lock( s_liveMutex );
+        if ( std::find( s_liveDescriptors.begin(), s_liveDescriptors.end(), this ) == s_liveDescriptors.end() )
+        {
+            s_liveDescriptors.push_back( this );
+        }
+    }
+
+    /* ----------------------------------------- Bindings ----------------------------------------------------------- */
+    std::vector< VkDescriptorSetLayoutBinding > bindings { };
 
-        if ( numUniforms > 0 )
+    if ( parms.shader != nullptr )
+    {
+        // Declared by the shaders, descriptors are bound at set 0
+        for ( const voShader::binding_t & reflected : parms.shader->reflection.GetSetBindings( 0 ) )
         {
-            VkDescriptorPoolSize poolSize =
-            {
-                .type             = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
-                .descriptorCount  = numUniforms * MAX_DESCRIPTOR_SETS,
-            };
-            poolSizes.push_back( poolSize );
+            bindings.push_back( {
+                .binding         = reflected.binding,
+                .descriptorType  = reflected.descriptorType,
+                .descriptorCount = reflected.descriptorCount,
+                .stageFlags      = reflected.stageFlags,
+            } );
         }
+    }
+    else
+    {
+        // Laid out one after the other, vertex and fragment uniforms share the uniform buffer slots
+        const auto addBindings = [&]( uint32_t count, VkDescriptorType type, VkShaderStageFlags stageFlags )
+        {
+            for ( uint32_t i = 0; i < count; ++i )
+            {
+                bindings.push_back( {
+                    .binding         = static_cast< uint32_t >( bindings.size() ),
+                    .descriptorType  = type,
+                    .descriptorCount = 1,
+                    .stageFlags      = stageFlags,
+                } );
+            }
+        };
+
+        addBindings( parms.numUniformsVertex, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_VERTEX_BIT );
+        addBindings( parms.numUniformsFragment, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_FRAGMENT_BIT );
+        addBindings( parms.numImageSamplers, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT );
+        addBindings( parms.numStorageBuffers, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT );
+        addBindings( parms.numStorageImages, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT );
+    }
+
+    // Transient bindings go straight into the command buffer when the device can push them
+    m_pushDescriptors = parms.transient && device->enabledFeatures.pushDescriptor && bindings.size() <= MAX_PUSH_DESCRIPTORS;
+
+    if ( m_pushDescriptors )
+    {
+        // Push descriptor layouts have no dynamic buffers, the offsets are pushed as they are
+        m_parms.dynamicUniforms       = 0;
+        m_parms.dynamicStorageBuffers = 0;
+    }
 
-        if ( parms.numImageSamplers > 0 )
+    /* ----------------------------------------- Create Descriptor Set Layout ----------------------------------------- */
+    {
+        m_layoutBindings.clear();
+        m_templateEntries.clear();
+
+        // Every binding is read by the update template from the next free slots of its kind in the bindings of the descriptor
+        uint32_t numUniforms       = 0;
+        uint32_t numImages         = 0;
+        uint32_t numStorageBuffers = 0;
+        uint32_t numStorageImages  = 0;
+
+        for ( VkDescriptorSetLayoutBinding binding : bindings )
         {
-            VkDescriptorPoolSize poolSize =
+            uint32_t * slot        = nullptr;
+            uint32_t   maxSlots    = 0;
+            uint32_t   dynamicMask = 0;
+            size_t     offset      = 0;
+            size_t     stride      = 0;
+
+            switch ( binding.descriptorType )
+            {
+                case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
+                    slot        = &numUniforms;
+                    maxSlots    = voDescriptor::MAX_BUFFERS;
+                    dynamicMask = m_parms.dynamicUniforms;
+                    offset      = offsetof( voDescriptor::bindings_t, buffers );
+                    stride      = sizeof( VkDescriptorBufferInfo );
+                    break;
+
+                case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
+                    slot        = &numStorageBuffers;
+                    maxSlots    = voDescriptor::MAX_BUFFERS;
+                    dynamicMask = m_parms.dynamicStorageBuffers;
+                    offset      = offsetof( voDescriptor::bindings_t, storageBuffers );
+                    stride      = sizeof( VkDescriptorBufferInfo );
+                    break;
+
+                case VK_DESCRIPTOR_TYPE_SAMPLER:
+                case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:
+                case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:
+                    slot     = &numImages;
+                    maxSlots = voDescriptor::MAX_IMAGEINFO;
+                    offset   = offsetof( voDescriptor::bindings_t, images );
+                    stride   = sizeof( VkDescriptorImageInfo );
+                    break;
+
+                case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
+                    slot     = &numStorageImages;
+                    maxSlots = voDescriptor::MAX_IMAGEINFO;
+                    offset   = offsetof( voDescriptor::bindings_t, storageImages );
+                    stride   = sizeof( VkDescriptorImageInfo );
+                    break;
+
+                default:
+                    break;
+            }
+
+            if ( parms.stageFlags != 0 )
+            {
+                binding.stageFlags = parms.stageFlags;
+            }
+
+            if ( binding.descriptorCount == 0 )
+            {
+                spdlog::error( "Runtime sized descriptor array at binding {}, bound as a single descriptor", binding.binding );
+                binding.descriptorCount = 1;
+            }
+
+            // Still in the layout so it matches the shaders, but never written
+            if ( slot == nullptr || *slot + binding.descriptorCount > maxSlots )
+            {
+                spdlog::error( "Descriptor binding {} of type {} cannot be bound by voDescriptor", binding.binding, static_cast< int >( binding.descriptorType ) );
+                m_layoutBindings.push_back( binding );
+                continue;
+            }
+
+            // Dynamic slots are single buffers
+            if ( binding.descriptorCount == 1 && ( dynamicMask & ( 1U << *slot ) ) != 0 )
+            {
+                binding.descriptorType = binding.descriptorType == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC
+                                                                                                     : VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
+            }
+
+            VkDescriptorUpdateTemplateEntry templateEntry =
             {
-                .type              = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-                .descriptorCount   = parms.numImageSamplers * MAX_DESCRIPTOR_SETS
+                .dstBinding      = binding.binding,
+                .dstArrayElement = 0,
+                .descriptorCount = binding.descriptorCount,
+                .descriptorType  = binding.descriptorType,
+                .offset          = offset + *slot * stride,
+                .stride          = stride,
             };
-            poolSizes.push_back( poolSize );
+
+            *slot += binding.descriptorCount;
+
+            m_layoutBindings.push_back( binding );
+            m_templateEntries.push_back( templateEntry );
         }
 
-        VkDescriptorPoolCreateInfo poolInfo =
+        // Shared with every layout describing the same bindings
+        vkDescriptorSetLayout = device->m_layoutCache.GetSetLayout( device, m_layoutBindings, GetLayoutFlags() );
+    }
+
+    /* ----------------------------------------- Create Update Template ----------------------------------------------- */
+    if ( !m_templateEntries.empty() && !m_pushDescriptors )
+    {
+        VkDescriptorUpdateTemplateCreateInfo templateInfo =
         {
-            .sType          = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
-            .flags          = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT,
-            .maxSets        = MAX_DESCRIPTOR_SETS + 1,
-            .poolSizeCount  = static_cast< uint32_t >( poolSizes.size() ),
-            .pPoolSizes     = poolSizes.data(),
+            .sType                      = VK_STRUCTURE_TYPE_DESCRIPTOR_UPDATE_TEMPLATE_CREATE_INFO,
+            .descriptorUpdateEntryCount = static_cast< uint32_t >( m_templateEntries.size() ),
+            .pDescriptorUpdateEntries   = m_templateEntries.data(),
+            .templateType               = VK_DESCRIPTOR_UPDATE_TEMPLATE_TYPE_DESCRIPTOR_SET,
+            .descriptorSetLayout        = vkDescriptorSetLayout,
         };
 
-        VK_CHECK( vkCreateDescriptorPool( device->deviceInfo.logical, &poolInfo, nullptr, &vkDescriptorPool ),
-                  "Failed to create descriptor pool" );
+        VK_CHECK( vkCreateDescriptorUpdateTemplate( device->deviceInfo.logical, &templateInfo, nullptr, &vkUpdateTemplate ),
+                  "Failed to create descriptor update template" );
     }
 
-    /* ----------------------------------------- Create Descriptor Set Layout ----------------------------------------- */
+    /* ---------------------------------------- Set Usage --------------------------------------------------------------- */
+    m_setUsage         = {};
+    m_setUsage.numSets = 1;
+    for ( const VkDescriptorSetLayoutBinding & binding : m_layoutBindings )
+    {
+        m_setUsage.Add( binding.descriptorType, binding.descriptorCount );
+    }
+
+    /* ---------------------------------------- Descriptor Pool --------------------------------------------------------- */
+    // Sets are cached or allocated per frame, the pool is only for the sets allocated outside, like the UI ones
+    if ( parms.maxExternalSets > 0 )
+    {
+        vkDescriptorPool = CreatePool( device, parms.maxExternalSets );
+    }
+}
+
+void
+voDescriptors::Cleanup( voDeviceContext * device )
+{
+    {
+        std::lock_guard< std::mutex > lock( s_liveMutex );
+        std::erase( s_liveDescriptors, this );
+    }
+
+    // The layout belongs to the layout cache of the device
+    vkDescriptorSetLayout = VK_NULL_HANDLE;
+
+    vkDestroyDescriptorPool( device->deviceInfo.logical, vkDescriptorPool, nullptr );
+    vkDescriptorPool = VK_NULL_HANDLE;
+
+    if ( vkUpdateTemplate != VK_NULL_HANDLE )
     {
-        VkDescriptorSetLayoutBinding * uniformBindings = static_cast< VkDescriptorSetLayoutBinding * >( alloca( sizeof( VkDescriptorSetLayoutBinding ) * ( numUniforms ) ) );
-        memset( uniformBindings, 0, sizeof( VkDescriptorSetLayoutBinding ) * ( numUniforms ) );
+        vkDestroyDescriptorUpdateTemplate( device->deviceInfo.logical, vkUpdateTemplate, nullptr );
+        vkUpdateTemplate = VK_NULL_HANDLE;
+    }
 
-        uint32_t id { 0 };
+    // Cached sets may still be in flight, and evicted ones are freed from their pool by the deletion queue
+    std::lock_guard< std::mutex > lock( m_cacheMutex );
 
-        for ( uint32_t i = 0; i < parms.numUniformsVertex; ++i, ++id )
+    device->m_deletionQueue.Destroy( [pools = std::move( m_cachePools )]( voDeviceContext * device )
+    {
+        for ( VkDescriptorPool pool : pools )
         {
-            VkDescriptorSetLayoutBinding uniformBinding =
-            {
-                .binding            = id,  // Binding point in shader
-                .descriptorType     = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
-                .descriptorCount    = 1,
-                .stageFlags         = VK_SHADER_STAGE_VERTEX_BIT,
-                .pImmutableSamplers = VK_NULL_HANDLE,
-            };
-            uniformBindings[ id ] = uniformBinding;
+            vkDestroyDescriptorPool( device->deviceInfo.logical, pool, nullptr );
         }
+    } );
+
+    m_cachePools.clear();
+    m_cache.clear();
+    m_cacheLookup.clear();
+    m_cacheGeneration.fetch_add( 1, std::memory_order_release );
+}
+
+VkDescriptorSet
+voDescriptors::GetCachedSet( voDeviceContext * device, const voDescriptor::bindings_t & bindings )
+{
+    uint64_t       key[ MAX_KEY_WORDS ];
+    const uint32_t numWords = PackKey( bindings, key );
+    const uint64_t hash     = HashKey( key, numWords );
+
+    std::lock_guard< std::mutex > lock( m_cacheMutex );
+
+    /* ----------------------------------------- Lookup ------------------------------------------------------------ */
+    auto found = m_cacheLookup.find( hash );
+    if ( found != m_cacheLookup.end() )
+    {
+        const std::list< cache_entry_t >::iterator entry = found->second;
+
+        if ( entry->key.size() == numWords && memcmp( entry->key.data(), key, numWords * sizeof( uint64_t ) ) == 0 )
+        {
+            m_cache.splice( m_cache.begin(), m_cache, entry );
+            return entry->vkDescriptorSet;
+        }
+
+        // Hash collision, the other resources lose their set
+        EvictEntry( device, entry );
+    }
+
+    /* ----------------------------------------- Evict ------------------------------------------------------------- */
+    if ( m_cache.size() >= DESCRIPTOR_CACHE_SIZE )
+    {
+        EvictEntry( device, std::prev( m_cache.end() ) );
+    }
+
+    /* ----------------------------------------- Write ------------------------------------------------------------- */
+    cache_entry_t entry =
+    {
+        .hash = hash,
+        .key  = std::vector< uint64_t >( key, key + numWords ),
+    };
+    entry.vkDescriptorSet = AllocateCachedSet( device, entry.pool );
+
+    if ( vkUpdateTemplate != VK_NULL_HANDLE )
+    {
+        vkUpdateDescriptorSetWithTemplate( device->deviceInfo.logical, entry.vkDescriptorSet, vkUpdateTemplate, &bindings );
+    }
+
+    m_cache.push_front( std::move( entry ) );
+    m_cacheLookup[ hash ] = m_cache.begin();
+
+    return m_cache.front().vkDescriptorSet;
+}
+
+void
+voDescriptors::Forget( voDeviceContext * device, uint64_t handle )
+{
+    if ( handle == 0 )
+    {
+        return;
+    }
+
+    std::lock_guard< std::mutex > liveLock( s_liveMutex );
+
+    for ( voDescriptors * descriptors : s_liveDescriptors )
+    {
+        std::lock_guard< std::mutex > lock( descriptors->m_cacheMutex );
 
-        for ( uint32_t i = 0; i < parms.numUniformsFragment; ++i, ++id )
+        // An offset or range equal to the handle only costs writing the set again
+        for ( auto entry = descriptors->m_cache.begin(); entry != descriptors->m_cache.end(); )
         {
-            VkDescriptorSetLayoutBinding imageSamplerBinding =
+            const auto next = std::next( entry );
+            if ( std::find( entry->key.begin(), entry->key.end(), handle ) != entry->key.end() )
             {
-                .binding            = id,
-                .descriptorType     = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-                .descriptorCount    = 1,
-                .stageFlags         = VK_SHADER_STAGE_FRAGMENT_BIT,
-                .pImmutableSamplers = VK_NULL_HANDLE,
-            };
-            uniformBindings[ id ] = imageSamplerBinding;
+                descriptors->EvictEntry( device, entry );
+            }
+            entry = next;
         }
+    }
+}
 
-        VkDescriptorSetLayoutCreateInfo layoutInfo =
+void
+voDescriptors::PushDescriptor( VkCommandBuffer vkCommandBuffer, voPipeline * pso, const voDescriptor::bindings_t & bindings ) const
+{
+    VkWriteDescriptorSet descriptorWrites[ MAX_PUSH_DESCRIPTORS ];
+
+    // Same slots as the update template would read
+    const uint8_t * base = reinterpret_cast< const uint8_t * >( &bindings );
+
+    for ( size_t i = 0; i < m_templateEntries.size(); ++i )
+    {
+        const VkDescriptorUpdateTemplateEntry & entry    = m_templateEntries[ i ];
+        const bool                              isBuffer = IsBufferDescriptor( entry.descriptorType );
+
+        descriptorWrites[ i ] =
         {
-            .sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
-            .bindingCount  = numUniforms,
-            .pBindings     = uniformBindings,
+            .sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .dstBinding      = entry.dstBinding,
+            .dstArrayElement = 0,
+            .descriptorCount = entry.descriptorCount,
+            .descriptorType  = entry.descriptorType,
+            .pImageInfo      = isBuffer ? nullptr : reinterpret_cast< const VkDescriptorImageInfo * >( base + entry.offset ),
+            .pBufferInfo     = isBuffer ? reinterpret_cast< const VkDescriptorBufferInfo * >( base + entry.offset ) : nullptr,
         };
+    }
 
-        VK_CHECK( vkCreateDescriptorSetLayout( device->deviceInfo.logical, &layoutInfo, nullptr, &vkDescriptorSetLayout ),
-                  "Failed to create descriptor set layout" );
+    function_set_t::vkCmdPushDescriptorSetKHR( vkCommandBuffer, pso->vkBindPoint, pso->vkPipelineLayout, 0,
+                                               static_cast< uint32_t >( m_templateEntries.size() ), descriptorWrites );
+}
+
+void
+voDescriptors::EvictEntry( voDeviceContext * device, std::list< cache_entry_t >::iterator entry )
+{
+    // The frame being recorded may still bind the set
+    device->m_deletionQueue.Destroy( [pool = m_cachePools[ entry->pool ], set = entry->vkDescriptorSet]( voDeviceContext * device )
+    {
+        vkFreeDescriptorSets( device->deviceInfo.logical, pool, 1, &set );
+    } );
+
+    m_cacheLookup.erase( entry->hash );
+    m_cache.erase( entry );
+
+    // Descriptors holding a set pick it again from the cache
+    m_cacheGeneration.fetch_add( 1, std::memory_order_release );
+}
+
+VkDescriptorSet
+voDescriptors::AllocateCachedSet( voDeviceContext * device, uint32_t & pool )
+{
+    VkDescriptorSetAllocateInfo allocInfo =
+    {
+        .sType               = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+        .descriptorSetCount  = 1,
+        .pSetLayouts         = &vkDescriptorSetLayout,
+    };
+
+    VkDescriptorSet vkDescriptorSet = VK_NULL_HANDLE;
+
+    // Newest pool first, older pools only get room back once their evicted sets are freed
+    for ( size_t i = m_cachePools.size(); i > 0; --i )
+    {
+        allocInfo.descriptorPool = m_cachePools[ i - 1 ];
+
+        if ( vkAllocateDescriptorSets( device->deviceInfo.logical, &allocInfo, &vkDescriptorSet ) == VK_SUCCESS )
+        {
+            pool = static_cast< uint32_t >( i - 1 );
+            return vkDescriptorSet;
+        }
+    }
+
+    m_cachePools.push_back( CreatePool( device, DESCRIPTOR_CACHE_POOL_SETS ) );
+    allocInfo.descriptorPool = m_cachePools.back();
+
+    VK_CHECK( vkAllocateDescriptorSets( device->deviceInfo.logical, &allocInfo, &vkDescriptorSet ),
+              "Failed to allocate cached descriptor set" );
+
+    pool = static_cast< uint32_t >( m_cachePools.size() - 1 );
+    return vkDescriptorSet;
+}
+
+VkDescriptorPool
+voDescriptors::CreatePool( voDeviceContext * device, uint32_t maxSets ) const
+{
+    std::vector< VkDescriptorPoolSize > poolSizes { };
+
+    const auto addPoolSize = [&]( VkDescriptorType type, uint32_t count )
+    {
+        auto poolSize = std::find_if( poolSizes.begin(), poolSizes.end(), [&]( const VkDescriptorPoolSize & size ) { return size.type == type; } );
+        if ( poolSize == poolSizes.end() )
+        {
+            poolSizes.push_back( { .type = type, .descriptorCount = 0 } );
+            poolSize = std::prev( poolSizes.end() );
+        }
+
+        poolSize->descriptorCount += count * maxSets;
+    };
+
+    for ( const VkDescriptorSetLayoutBinding & binding : m_layoutBindings )
+    {
+        addPoolSize( binding.descriptorType, binding.descriptorCount );
     }
 
-    /* ----------------------------------------- Create descriptor sets ----------------------------------------- */
+    VkDescriptorPoolCreateInfo poolInfo =
     {
-        std::vector< VkDescriptorSetLayout > layouts { MAX_DESCRIPTOR_SETS, vkDescriptorSetLayout };
+        .sType          = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+        .flags          = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT,
+        .maxSets        = maxSets,
+        .poolSizeCount  = static_cast< uint32_t >( poolSizes.size() ),
+        .pPoolSizes     = poolSizes.data(),
+    };
+
+    VkDescriptorPool vkPool = VK_NULL_HANDLE;
+    VK_CHECK( vkCreateDescriptorPool( device->deviceInfo.logical, &poolInfo, nullptr, &vkPool ),
+              "Failed to create descriptor pool" );
 
-        VkDescriptorSetAllocateInfo allocInfo =
+    return vkPool;
+}
+
+uint32_t
+voDescriptors::PackKey( const voDescriptor::bindings_t & bindings, uint64_t * key ) const
+{
+    // Field by field, the padding of the infos is never read
+    uint32_t       numWords = 0;
+    const uint8_t * base    = reinterpret_cast< const uint8_t * >( &bindings );
+
+    for ( const VkDescriptorUpdateTemplateEntry & entry : m_templateEntries )
+    {
+        for ( uint32_t i = 0; i < entry.descriptorCount; ++i )
         {
-            .sType               = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
-            .descriptorPool      = vkDescriptorPool,
-            .descriptorSetCount  = MAX_DESCRIPTOR_SETS,
-            .pSetLayouts         = layouts.data(),
-        };
+            const uint8_t * info = base + entry.offset + i * entry.stride;
 
-        VK_CHECK( vkAllocateDescriptorSets( device->deviceInfo.logical, &allocInfo, vkDescriptorSets ),
-                  "Failed to allocate descriptor sets" );
+            if ( IsBufferDescriptor( entry.descriptorType ) )
+            {
+                const VkDescriptorBufferInfo * bufferInfo = reinterpret_cast< const VkDescriptorBufferInfo * >( info );
+                key[ numWords++ ] = reinterpret_cast< uint64_t >( bufferInfo->buffer );
+                key[ numWords++ ] = bufferInfo->offset;
+                key[ numWords++ ] = bufferInfo->range;
+            }
+            else
+            {
+                const VkDescriptorImageInfo * imageInfo = reinterpret_cast< const VkDescriptorImageInfo * >( info );
+                key[ numWords++ ] = reinterpret_cast< uint64_t >( imageInfo->sampler );
+                key[ numWords++ ] = reinterpret_cast< uint64_t >( imageInfo->imageView );
+                key[ numWords++ ] = imageInfo->imageLayout;
+            }
+        }
     }
+
+    return numWords;
 }
 
-void
-voDescriptors::Cleanup( voDeviceContext * device )
+uint32_t
+voDescriptors::GetDynamicOffsets( const voDescriptor & descriptor, uint32_t * offsets ) const
 {
-    vkFreeDescriptorSets( device->deviceInfo.logical, vkDescriptorPool, MAX_DESCRIPTOR_SETS, vkDescriptorSets );
-    vkDestroyDescriptorSetLayout( device->deviceInfo.logical, vkDescriptorSetLayout, nullptr );
-    vkDestroyDescriptorPool( device->deviceInfo.logical, vkDescriptorPool, nullptr );
+    // Ordered by binding, as the template entries are
+    uint32_t numOffsets = 0;
+
+    for ( const VkDescriptorUpdateTemplateEntry & entry : m_templateEntries )
+    {
+        if ( entry.descriptorType == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC )
+        {
+            offsets[ numOffsets++ ] = descriptor.m_dynamicOffsets[ ( entry.offset - offsetof( voDescriptor::bindings_t, buffers ) ) / entry.stride ];
+        }
+        else if ( entry.descriptorType == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC )
+        {
+            offsets[ numOffsets++ ] = descriptor.m_dynamicStorageOffsets[ ( entry.offset - offsetof( voDescriptor::bindings_t, storageBuffers ) ) / entry.stride ];
+        }
+    }
+
+    return numOffsets;
 }
@@ -0,0 +1,143 @@
+#include "vulkano/vo_descriptorAllocator.hpp"
+#include "vulkano/vo_deviceContext.hpp"
+
+bool
+voDescriptorAllocator::Create( voDeviceContext *, const CreateParms_t & parms )
+{
+    m_frames.resize( std::max( parms.numFrames, 1U ) );
+    m_frameIndex = 0;
+
+    // Descriptor counts are learnt, they only start from the sets of the first frame
+    m_poolSize         = {};
+    m_poolSize.numSets = parms.initialSets;
+
+    return true;
+}
+
+void
+voDescriptorAllocator::Cleanup( voDeviceContext * device )
+{
+    // Sets are released along with their pool
+    for( frame_t & frame : m_frames )
+        {
+            for( VkDescriptorPool pool : frame.pools )
+                {
+                    vkDestroyDescriptorPool( device->deviceInfo.logical, pool, nullptr );
+                }
+        }
+
+    m_frames.clear();
+}
+
+void
+voDescriptorAllocator::BeginFrame( voDeviceContext * device, uint32_t frameIndex )
+{
+    voAssert( frameIndex < m_frames.size() && "Not enough descriptor pools for the frames in flight" );
+
+    std::lock_guard< std::mutex > lock( m_mutex );
+
+    m_frameIndex    = frameIndex;
+    frame_t & frame = m_frames[frameIndex];
+
+    if( frame.pools.size() > 1 )
+        {
+            // The slot outgrew its pool, a single pool sized for its peak replaces the chain, with half of it as headroom
+            usage_t peak = frame.used;
+            peak.numSets += peak.numSets / 2;
+            for( uint32_t & numDescriptors : peak.numDescriptors )
+                {
+                    numDescriptors += numDescriptors / 2;
+                }
+            m_poolSize.Max( peak );
+
+            for( VkDescriptorPool pool : frame.pools )
+                {
+                    vkDestroyDescriptorPool( device->deviceInfo.logical, pool, nullptr );
+                }
+            frame.pools.clear();
+
+            spdlog::info( "Descriptor pools grown to {} sets", m_poolSize.numSets );
+        }
+    else if( frame.pools.size() == 1 && frame.used.numSets > 0 )
+        {
+            VK_CHECK( vkResetDescriptorPool( device->deviceInfo.logical, frame.pools[0], 0 ),
+                      "Failed to reset frame descriptor pool" );
+        }
+
+    frame.current = 0;
+    frame.used    = {};
+}
+
+VkDescriptorSet
+voDescriptorAllocator::Allocate( voDeviceContext * device, VkDescriptorSetLayout layout, const usage_t & usage )
+{
+    std::lock_guard< std::mutex > lock( m_mutex );
+
+    frame_t & frame = m_frames[m_frameIndex];
+    frame.used.Add( usage );
+
+    VkDescriptorSetAllocateInfo allocInfo =
+        {
+            .sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+            .descriptorSetCount = 1,
+            .pSetLayouts        = &layout,
+        };
+
+    while( true )
+        {
+            const bool isNewPool = frame.current == frame.pools.size();
+            if( isNewPool )
+                {
+                    // At least what the frame used so far, the chain grows geometrically within a frame
+                    usage_t size = m_poolSize;
+                    size.Max( frame.used );
+                    frame.pools.push_back( CreatePool( device, size ) );
+                }
+
+            allocInfo.descriptorPool = frame.pools[frame.current];
+
+            VkDescriptorSet vkDescriptorSet = VK_NULL_HANDLE;
+            const VkResult  result          = vkAllocateDescriptorSets( device->deviceInfo.logical, &allocInfo, &vkDescriptorSet );
+
+            if( result == VK_SUCCESS )
+                {
+                    return vkDescriptorSet;
+                }
+
+            // A fresh pool holds at least one set, anything else than a full pool is an error
+            if( isNewPool || ( result != VK_ERROR_OUT_OF_POOL_MEMORY && result != VK_ERROR_FRAGMENTED_POOL ) )
+                {
+                    VK_CHECK( result, "Failed to allocate frame descriptor set" );
+                }
+
+            frame.current++;
+        }
+}
+
+VkDescriptorPool
+voDescriptorAllocator::CreatePool( voDeviceContext * device, const usage_t & size ) const
+{
+    std::vector< VkDescriptorPoolSize > poolSizes {};
+    for( uint32_t i = 0; i < NUM_DESCRIPTOR_TYPES; i++ )
+        {
+            if( size.numDescriptors[i] > 0 )
+                {
+                    poolSizes.push_back( { .type = static_cast< VkDescriptorType >( i ), .descriptorCount = size.numDescriptors[i] } );
+                }
+        }
+
+    // No FREE_DESCRIPTOR_SET_BIT, the pool is only ever reset as a whole
+    VkDescriptorPoolCreateInfo poolInfo =
+        {
+            .sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+            .maxSets       = std::max( size.numSets, 1U ),
+            .poolSizeCount = static_cast< uint32_t >( poolSizes.size() ),
+            .pPoolSizes    = poolSizes.data(),
+        };
+
+    VkDescriptorPool vkPool = VK_NULL_HANDLE;
+    VK_CHECK( vkCreateDescriptorPool( device->deviceInfo.logical, &poolInfo, nullptr, &vkPool ),
+              "Failed to create frame descriptor pool" );
+
+    return vkPool;
+}
@@ -1,11 +1,46 @@
 #include "vulkano/vo_deviceContext.hpp"
+#include <algorithm>
 #include <cassert>
 #include <cstring>
 #include <iostream>
 #include <stdexcept>
+#include <thread>
 #include "vo_utilities.hpp"
 #include "vulkano/vo_common.hpp"
 #include "vulkano/vo_fence.hpp"
+#include "vulkano/vo_pipeline.hpp"
+
+#ifndef STAGING_RING_SIZE
+#    define STAGING_RING_SIZE ( 32ULL * 1024 * 1024 )
+#endif /** STAGING_RING_SIZE */
+
+#ifndef UPLOAD_FRAME_BUDGET
+#    define UPLOAD_FRAME_BUDGET ( 8ULL * 1024 * 1024 )
+#endif /** UPLOAD_FRAME_BUDGET */
+
+#ifndef MAX_JOB_THREADS
+#    define MAX_JOB_THREADS 16
+#endif /** MAX_JOB_THREADS */
+
+#ifndef COMPUTE_COMMAND_BUFFERS
+#    define COMPUTE_COMMAND_BUFFERS 8
+#endif /** COMPUTE_COMMAND_BUFFERS */
+
+#ifndef FRAME_DESCRIPTOR_SETS
+#    define FRAME_DESCRIPTOR_SETS 256
+#endif /** FRAME_DESCRIPTOR_SETS */
+
+#ifndef PIPELINE_CACHE_FILE
+#    define PIPELINE_CACHE_FILE "pipelines.cache"
+#endif /** PIPELINE_CACHE_FILE */
+
+#ifndef PIPELINE_CACHE_SAVE_INTERVAL
+#    define PIPELINE_CACHE_SAVE_INTERVAL 60
+#endif /** PIPELINE_CACHE_SAVE_INTERVAL */
+
+#ifndef PIPELINE_MANIFEST_FILE
+#    define PIPELINE_MANIFEST_FILE "pipelines.manifest"
+#endif /** PIPELINE_MANIFEST_FILE */
 
 // ======================================================================================================================
 // ============================================ Function Set ============================================================
@@ -13,6 +48,14 @@
 
 PFN_vkCreateDebugReportCallbackEXT function_set_t::vkCreateDebugReportCallbackEXT;
 PFN_vkDestroyDebugReportCallbackEXT function_set_t::vkDestroyDebugReportCallbackEXT;
+PFN_vkCmdPushDescriptorSetKHR function_set_t::vkCmdPushDescriptorSetKHR;
+PFN_vkCmdSetCullModeEXT function_set_t::vkCmdSetCullModeEXT;
+PFN_vkCmdSetFrontFaceEXT function_set_t::vkCmdSetFrontFaceEXT;
+PFN_vkCmdSetPrimitiveTopologyEXT function_set_t::vkCmdSetPrimitiveTopologyEXT;
+PFN_vkCmdSetDepthTestEnableEXT function_set_t::vkCmdSetDepthTestEnableEXT;
+PFN_vkCmdSetDepthWriteEnableEXT function_set_t::vkCmdSetDepthWriteEnableEXT;
+PFN_vkCmdSetDepthCompareOpEXT function_set_t::vkCmdSetDepthCompareOpEXT;
+PFN_vkCmdSetDepthBiasEnableEXT function_set_t::vkCmdSetDepthBiasEnableEXT;
 
 void
 function_set_t::Link( VkInstance instance )
@@ -23,6 +66,28 @@ function_set_t::Link( VkInstance instance )
         (PFN_vkDestroyDebugReportCallbackEXT)vkGetInstanceProcAddr( instance, "vkDestroyDebugReportCallbackEXT" );
 }
 
+void
+function_set_t::LinkDevice( VkDevice device )
+{
+    function_set_t::vkCmdPushDescriptorSetKHR =
+        (PFN_vkCmdPushDescriptorSetKHR)vkGetDeviceProcAddr( device, "vkCmdPushDescriptorSetKHR" );
+
+    function_set_t::vkCmdSetCullModeEXT =
+        (PFN_vkCmdSetCullModeEXT)vkGetDeviceProcAddr( device, "vkCmdSetCullModeEXT" );
+    function_set_t::vkCmdSetFrontFaceEXT =
+        (PFN_vkCmdSetFrontFaceEXT)vkGetDeviceProcAddr( device, "vkCmdSetFrontFaceEXT" );
+    function_set_t::vkCmdSetPrimitiveTopologyEXT =
+        (PFN_vkCmdSetPrimitiveTopologyEXT)vkGetDeviceProcAddr( device, "vkCmdSetPrimitiveTopologyEXT" );
+    function_set_t::vkCmdSetDepthTestEnableEXT =
+        (PFN_vkCmdSetDepthTestEnableEXT)vkGetDeviceProcAddr( device, "vkCmdSetDepthTestEnableEXT" );
+    function_set_t::vkCmdSetDepthWriteEnableEXT =
+        (PFN_vkCmdSetDepthWriteEnableEXT)vkGetDeviceProcAddr( device, "vkCmdSetDepthWriteEnableEXT" );
+    function_set_t::vkCmdSetDepthCompareOpEXT =
+        (PFN_vkCmdSetDepthCompareOpEXT)vkGetDeviceProcAddr( device, "vkCmdSetDepthCompareOpEXT" );
+    function_set_t::vkCmdSetDepthBiasEnableEXT =
+        (PFN_vkCmdSetDepthBiasEnableEXT)vkGetDeviceProcAddr( device, "vkCmdSetDepthBiasEnableEXT" );
+}
+
 // ======================================================================================================================
 // ============================================ Physical Device Properties ==============================================
 // ======================================================================================================================
@@ -36,6 +101,21 @@ physical_device_properties_t::SetProperties( VkPhysicalDevice device, VkSurfaceK
     vkGetPhysicalDeviceMemoryProperties( physicalDevice, &memoryProperties );
     vkGetPhysicalDeviceFeatures( physicalDevice, &features );
 
+    /* ---------------------------------------- Vulkan 1.2 Features ----------------------------------------------------- */
+    if( deviceProperties.apiVersion >= VK_API_VERSION_1_2 )
+        {
+            features12 = { .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_12_FEATURES };
+
+            VkPhysicalDeviceFeatures2 features2 =
+                {
+                    .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+                    .pNext = &features12,
+                };
+
+            vkGetPhysicalDeviceFeatures2( physicalDevice, &features2 );
+            features12.pNext = nullptr;
+        }
+
     /* ---------------------------------------- VkSurfaceCapabilitiesKHR ------------------------------------------------ */
     {
         VK_CHECK( vkGetPhysicalDeviceSurfaceCapabilitiesKHR( physicalDevice, vkSurface, &surfaceCapabilities ),
@@ -100,6 +180,51 @@ physical_device_properties_t::SetProperties( VkPhysicalDevice device, VkSurfaceK
             }
     }
 
+    /* ---------------------------------------- Extension Features ------------------------------------------------------ */
+    if( deviceProperties.apiVersion >= VK_API_VERSION_1_1 )
+        {
+            const char * dynamicStateExtension  = VK_EXT_EXTENDED_DYNAMIC_STATE_EXTENSION_NAME;
+            const char * dynamicState2Extension = VK_EXT_EXTENDED_DYNAMIC_STATE_2_EXTENSION_NAME;
+            const char * libraryExtensions[]    = { VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME, VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME };
+
+            featuresDynamicState      = { .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_FEATURES_EXT };
+            featuresDynamicState2     = { .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_2_FEATURES_EXT };
+            featuresPipelineLibrary   = { .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT };
+            propertiesPipelineLibrary = { .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_PROPERTIES_EXT };
+
+            // Only the structures of supported extensions may be chained
+            VkPhysicalDeviceFeatures2 features2 = { .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2 };
+            if( HasExtensionsSupport( &dynamicStateExtension, 1 ) )
+                {
+                    featuresDynamicState.pNext = features2.pNext;
+                    features2.pNext            = &featuresDynamicState;
+                }
+            if( HasExtensionsSupport( &dynamicState2Extension, 1 ) )
+                {
+                    featuresDynamicState2.pNext = features2.pNext;
+                    features2.pNext             = &featuresDynamicState2;
+                }
+
+            if( HasExtensionsSupport( libraryExtensions, 2 ) )
+                {
+                    featuresPipelineLibrary.pNext = features2.pNext;
+                    features2.pNext               = &featuresPipelineLibrary;
+
+                    VkPhysicalDeviceProperties2 properties2 =
+                        {
+                            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2,
+                            .pNext = &propertiesPipelineLibrary,
+                        };
+                    vkGetPhysicalDeviceProperties2( physicalDevice, &properties2 );
+                    propertiesPipelineLibrary.pNext = nullptr;
+                }
+
+            vkGetPhysicalDeviceFeatures2( physicalDevice, &features2 );
+            featuresDynamicState.pNext    = nullptr;
+            featuresDynamicState2.pNext   = nullptr;
+            featuresPipelineLibrary.pNext = nullptr;
+        }
+
     return true;
 }
 
@@ -250,11 +375,40 @@ voDeviceContext::CreateInstance( bool enableLayers, const std::vector< const cha
 void
 voDeviceContext::Cleanup()
 {
+    // Jobs may still be using the device
+    m_jobSystem.Cleanup();
+
+    // Saved for the next run, once the jobs are done compiling and saving
+    m_pipelineCache.Cleanup( this );
+
     swapChain.Cleanup( this );
 
+    // Release what the last frames were still using
+    m_deletionQueue.Flush( this );
+
     // Destroy Command Buffers
     vkFreeCommandBuffers( deviceInfo.logical, m_vkCommandPool, (uint32_t)m_vkCommandBuffers.size(), m_vkCommandBuffers.data() );
     vkDestroyCommandPool( deviceInfo.logical, m_vkCommandPool, nullptr );
+    m_commandAllocator.Cleanup( this );
+    m_descriptorAllocator.Cleanup( this );
+    m_pipelineRegistry.Cleanup( this );
+    m_layoutCache.Cleanup( this );
+
+    m_computeContext.Cleanup( this );
+    m_uploadContext.Cleanup( this );
+
+    m_computeQueue.Cleanup( this );
+    m_transferQueue.Cleanup( this );
+    m_graphicsQueue.Cleanup( this );
+    m_fencePool.Cleanup( this );
+
+    // Release the allocator once every buffer and image has been destroyed
+    if( m_memory )
+        {
+            m_memory->Destroy();
+            delete m_memory;
+            m_memory = nullptr;
+        }
 
     vkDestroyDevice( deviceInfo.logical, nullptr );
 
@@ -267,12 +421,64 @@ voDeviceContext::Cleanup()
     vkDestroyInstance( instance, nullptr );
 }
 
+bool
+voDeviceContext::CreateSwapChain( int width, int height, uint32_t framesInFlight )
+{
+    if( !swapChain.Create( this, width, height, framesInFlight ) )
+        {
+            return false;
+        }
+
+    // Graphics pipelines of the manifest are recorded against the render pass of the swapchain
+    voPipeline::WarmUp( this );
+
+    return true;
+}
+
 bool
 voDeviceContext::CreateDevice()
 {
     CreatePhysicalDevice();
     CreateLogicalDevice();
 
+    /* ---------------------------------------- Job System -------------------------------------------------------------- */
+    {
+        // The calling thread is the main thread, one worker per remaining core
+        voJobSystem::CreateParms_t jobParms =
+            {
+                .numWorkers = std::clamp( std::thread::hardware_concurrency(), 1U, static_cast< uint32_t >( MAX_JOB_THREADS ) ) - 1,
+            };
+
+        if( !m_jobSystem.Create( jobParms ) )
+            {
+                throw std::runtime_error( "Failed to create job system" );
+            }
+    }
+
+    /* ---------------------------------------- Pipeline Cache and Registry --------------------------------------------- */
+    {
+        voPipelineCache::CreateParms_t cacheParms =
+            {
+                .fileName     = PIPELINE_CACHE_FILE,
+                .saveInterval = PIPELINE_CACHE_SAVE_INTERVAL,
+            };
+
+        if( !m_pipelineCache.Create( this, cacheParms ) )
+            {
+                throw std::runtime_error( "Failed to create pipeline cache" );
+            }
+
+        voPipelineRegistry::CreateParms_t registryParms =
+            {
+                .manifestFileName = PIPELINE_MANIFEST_FILE,
+            };
+
+        if( !m_pipelineRegistry.Create( this, registryParms ) )
+            {
+                throw std::runtime_error( "Failed to create pipeline registry" );
+            }
+    }
+
     return true;
 }
 
@@ -392,9 +598,55 @@ voDeviceContext::CreatePhysicalDevice()
                     continue;
                 }
 
+            /* ---------------------------------------- Get compute queue family -------------------------------------------- */
+
+            // Async compute runs on a family without graphics, so it can overlap the graphics queue
+            int computeID = -1;
+            for( int j = 0; j < deviceProperties.queueFamilyProperties.size(); ++j )
+                {
+                    const VkQueueFamilyProperties & props = deviceProperties.queueFamilyProperties[j];
+
+                    if( props.queueCount > 0 && ( props.queueFlags & VK_QUEUE_COMPUTE_BIT ) && !( props.queueFlags & VK_QUEUE_GRAPHICS_BIT ) )
+                        {
+                            computeID = j;
+                            break;
+                        }
+                }
+
+            /* ---------------------------------------- Get transfer queue family ------------------------------------------- */
+
+            // Prefer a transfer only family (usually a DMA engine), then any family without graphics
+            int transferID = -1;
+            for( int pass = 0; pass < 2 && transferID < 0; ++pass )
+                {
+                    for( int j = 0; j < deviceProperties.queueFamilyProperties.size(); ++j )
+                        {
+                            const VkQueueFamilyProperties & props = deviceProperties.queueFamilyProperties[j];
+
+                            if( props.queueCount == 0 || ( props.queueFlags & VK_QUEUE_GRAPHICS_BIT ) )
+                                {
+                                    continue;
+                                }
+
+                            // A family with a single queue is left to async compute
+                            if( j == computeID && props.queueCount < 2 )
+                                {
+                                    continue;
+                                }
+
+                            // Compute families support transfers even without the flag
+                            const VkQueueFlags excluded = pass == 0 ? VK_QUEUE_COMPUTE_BIT : 0;
+                            if( ( props.queueFlags & ( VK_QUEUE_TRANSFER_BIT | VK_QUEUE_COMPUTE_BIT ) ) && !( props.queueFlags & excluded ) )
+                                {
+                                    transferID = j;
+                                    break;
+                                }
+                        }
+                }
+
             /* ---------------------------------------- Get first device ---------------------------------------------------- */
 
-            queueIds            = { graphicsID, presentID };
+            queueIds            = { graphicsID, presentID, transferID, computeID };
             deviceInfo.physical = deviceProperties.physicalDevice;
             deviceInfo.index    = i;
 
@@ -430,45 +682,242 @@ voDeviceContext::CreateLogicalDevice()
             validationLayers = m_validationLayers;
         }
 
-    float queuePriority = 1.0F;
-    VkDeviceQueueCreateInfo queueCreateInfos[2] =
+    // One queue per distinct family
+    const float queuePriorities[2] = { 1.0F, 1.0F };
+    std::vector< VkDeviceQueueCreateInfo > queueCreateInfos;
+    for( int32_t family : { queueIds.graphicsFamily, queueIds.presentationFamily, queueIds.transferFamily, queueIds.computeFamily } )
         {
-            {
-             .sType            = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
-             .queueFamilyIndex = static_cast< uint32_t >( queueIds.graphicsFamily ),
-             .queueCount       = 1,
-             .pQueuePriorities = &queuePriority,
-             },
-            {
-             .sType            = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
-             .queueFamilyIndex = static_cast< uint32_t >( queueIds.presentationFamily ),
-             .queueCount       = 1,
-             .pQueuePriorities = &queuePriority,
-             }
-    };
+            const bool isCreated = std::any_of( queueCreateInfos.begin(), queueCreateInfos.end(),
+                                                [&]( const VkDeviceQueueCreateInfo & info ) { return info.queueFamilyIndex == static_cast< uint32_t >( family ); } );
+            if( family < 0 || isCreated )
+                {
+                    continue;
+                }
+
+            queueCreateInfos.push_back(
+                {
+                    .sType            = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
+                    .queueFamilyIndex = static_cast< uint32_t >( family ),
+                    .queueCount       = 1,
+                    .pQueuePriorities = queuePriorities,
+                } );
+        }
+
+    // Transfer and compute get a queue each when they share a family
+    if( queueIds.HasDedicatedCompute() && queueIds.computeFamily == queueIds.transferFamily )
+        {
+            for( VkDeviceQueueCreateInfo & info : queueCreateInfos )
+                {
+                    info.queueCount = info.queueFamilyIndex == static_cast< uint32_t >( queueIds.computeFamily ) ? 2 : info.queueCount;
+                }
+        }
 
     VkPhysicalDeviceFeatures deviceFeatures =
         {
             .samplerAnisotropy = VK_TRUE,
         };
 
+    // Optional features, only enabled when supported
+    const physical_device_properties_t * physicalProperties = GetPhysicalProperties();
+
+    const VkPhysicalDeviceVulkan12Features & supported12 = physicalProperties->features12;
+
+    // Everything the bindless set relies on, enabled together or not at all
+    const bool hasDescriptorIndexing = supported12.descriptorIndexing && supported12.runtimeDescriptorArray &&
+                                       supported12.descriptorBindingPartiallyBound && supported12.descriptorBindingUpdateUnusedWhilePending &&
+                                       supported12.descriptorBindingSampledImageUpdateAfterBind && supported12.descriptorBindingStorageBufferUpdateAfterBind &&
+                                       supported12.shaderSampledImageArrayNonUniformIndexing && supported12.shaderStorageBufferArrayNonUniformIndexing;
+
+    VkPhysicalDeviceVulkan12Features features12 =
+        {
+            .sType             = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_12_FEATURES,
+            .timelineSemaphore = supported12.timelineSemaphore,
+        };
+
+    if( hasDescriptorIndexing )
+        {
+            features12.descriptorIndexing                            = VK_TRUE;
+            features12.runtimeDescriptorArray                        = VK_TRUE;
+            features12.descriptorBindingPartiallyBound               = VK_TRUE;
+            features12.descriptorBindingUpdateUnusedWhilePending     = VK_TRUE;
+            features12.descriptorBindingSampledImageUpdateAfterBind  = VK_TRUE;
+            features12.descriptorBindingStorageBufferUpdateAfterBind = VK_TRUE;
+            features12.shaderSampledImageArrayNonUniformIndexing     = VK_TRUE;
+            features12.shaderStorageBufferArrayNonUniformIndexing    = VK_TRUE;
+        }
+
+    const bool hasVulkan12 = physicalProperties->deviceProperties.apiVersion >= VK_API_VERSION_1_2;
+
+    // Optional extensions, after the required ones
+    std::vector< const char * > extensions = m_deviceExtensions;
+
+    const char * pushDescriptorExtension = VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME;
+    const bool   hasPushDescriptor       = physicalProperties->HasExtensionsSupport( &pushDescriptorExtension, 1 );
+    if( hasPushDescriptor )
+        {
+            extensions.push_back( pushDescriptorExtension );
+        }
+
+    // Feature structures of the device, chained in front of the Vulkan 1.2 ones
+    void * featuresChain = hasVulkan12 ? &features12 : nullptr;
+
+    VkPhysicalDeviceExtendedDynamicStateFeaturesEXT featuresDynamicState =
+        {
+            .sType                = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_FEATURES_EXT,
+            .extendedDynamicState = VK_TRUE,
+        };
+
+    const bool hasDynamicState = physicalProperties->featuresDynamicState.extendedDynamicState == VK_TRUE;
+    if( hasDynamicState )
+        {
+            extensions.push_back( VK_EXT_EXTENDED_DYNAMIC_STATE_EXTENSION_NAME );
+            featuresDynamicState.pNext = featuresChain;
+            featuresChain              = &featuresDynamicState;
+        }
+
+    VkPhysicalDeviceExtendedDynamicState2FeaturesEXT featuresDynamicState2 =
+        {
+            .sType                 = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_2_FEATURES_EXT,
+            .extendedDynamicState2 = VK_TRUE,
+        };
+
+    // Only depth bias enable is used, on top of the first extension
+    const bool hasDynamicState2 = hasDynamicState && physicalProperties->featuresDynamicState2.extendedDynamicState2 == VK_TRUE;
+    if( hasDynamicState2 )
+        {
+            extensions.push_back( VK_EXT_EXTENDED_DYNAMIC_STATE_2_EXTENSION_NAME );
+            featuresDynamicState2.pNext = featuresChain;
+            featuresChain               = &featuresDynamicState2;
+        }
+
+    VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT featuresPipelineLibrary =
+        {
+            .sType                   = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT,
+            .graphicsPipelineLibrary = VK_TRUE,
+        };
+
+    // Without fast linking, linking the parts costs about as much as compiling the whole pipeline
+    const bool hasPipelineLibrary = physicalProperties->featuresPipelineLibrary.graphicsPipelineLibrary == VK_TRUE &&
+                                    physicalProperties->propertiesPipelineLibrary.graphicsPipelineLibraryFastLinking == VK_TRUE;
+    if( hasPipelineLibrary )
+        {
+            extensions.push_back( VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME );
+            extensions.push_back( VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME );
+            featuresPipelineLibrary.pNext = featuresChain;
+            featuresChain                 = &featuresPipelineLibrary;
+        }
+
     VkDeviceCreateInfo createInfo =
         {
             .sType                   = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
-            .queueCreateInfoCount    = queueIds.IsGraphicsAndPresentationEqual() ? 1U : 2U,
-            .pQueueCreateInfos       = queueCreateInfos,
+            .pNext                   = featuresChain,
+            .queueCreateInfoCount    = static_cast< uint32_t >( queueCreateInfos.size() ),
+            .pQueueCreateInfos       = queueCreateInfos.data(),
             .enabledLayerCount       = static_cast< uint32_t >( validationLayers.size() ),
             .ppEnabledLayerNames     = validationLayers.data(),
-            .enabledExtensionCount   = static_cast< uint32_t >( m_deviceExtensions.size() ),
-            .ppEnabledExtensionNames = m_deviceExtensions.data(),
+            .enabledExtensionCount   = static_cast< uint32_t >( extensions.size() ),
+            .ppEnabledExtensionNames = extensions.data(),
             .pEnabledFeatures        = &deviceFeatures,
         };
 
     VK_CHECK( vkCreateDevice( deviceInfo.physical, &createInfo, nullptr, &deviceInfo.logical ),
               "Failed to create logical device" );
 
-    vkGetDeviceQueue( deviceInfo.logical, queueIds.graphicsFamily, 0, &m_vkGraphicsQueue );
-    vkGetDeviceQueue( deviceInfo.logical, queueIds.presentationFamily, 0, &presentQueue );
+    enabledFeatures.timelineSemaphore = hasVulkan12 && features12.timelineSemaphore == VK_TRUE;
+
+    enabledFeatures.descriptorIndexing = hasVulkan12 && hasDescriptorIndexing;
+    enabledFeatures.pushDescriptor     = hasPushDescriptor;
+
+    enabledFeatures.extendedDynamicState    = hasDynamicState;
+    enabledFeatures.extendedDynamicState2   = hasDynamicState2;
+    enabledFeatures.graphicsPipelineLibrary = hasPipelineLibrary;
+
+    if( hasPushDescriptor || hasDynamicState )
+        {
+            function_set_t::LinkDevice( deviceInfo.logical );
+        }
+
+    spdlog::info( "Timeline semaphores: {}", enabledFeatures.timelineSemaphore ? "enabled" : "unavailable, using fences" );
+    spdlog::info( "Descriptor indexing: {}", enabledFeatures.descriptorIndexing ? "enabled" : "unavailable" );
+    spdlog::info( "Push descriptors: {}", enabledFeatures.pushDescriptor ? "enabled" : "unavailable, using descriptor sets" );
+    spdlog::info( "Extended dynamic state: {}", enabledFeatures.extendedDynamicState2 ? "enabled, with depth bias" :
+                                                enabledFeatures.extendedDynamicState  ? "enabled" : "unavailable, states baked into pipelines" );
+    spdlog::info( "Graphics pipeline library: {}", enabledFeatures.graphicsPipelineLibrary ? "enabled" : "unavailable, compiling whole pipelines" );
+
+    /* ---------------------------------------- Queues ------------------------------------------------------------------ */
+    {
+        m_graphicsQueue.Create( this, static_cast< uint32_t >( queueIds.graphicsFamily ), 0 );
+
+        m_vkGraphicsQueue = m_graphicsQueue.GetQueue();
+        vkGetDeviceQueue( deviceInfo.logical, queueIds.presentationFamily, 0, &presentQueue );
+
+        if( queueIds.HasDedicatedTransfer() )
+            {
+                m_transferQueue.Create( this, static_cast< uint32_t >( queueIds.transferFamily ), 0 );
+                spdlog::info( "Transfer queue family: {}", queueIds.transferFamily );
+            }
+        else
+            {
+                spdlog::info( "No dedicated transfer queue family, uploads use the graphics queue" );
+            }
+
+        if( queueIds.HasDedicatedCompute() )
+            {
+                // Second queue of the family when it is shared with the transfer queue
+                const uint32_t index = queueIds.computeFamily == queueIds.transferFamily ? 1 : 0;
+
+                m_computeQueue.Create( this, static_cast< uint32_t >( queueIds.computeFamily ), index );
+                spdlog::info( "Compute queue family: {}", queueIds.computeFamily );
+            }
+        else
+            {
+                spdlog::info( "No dedicated compute queue family, compute work uses the graphics queue" );
+            }
+    }
+
+    /* ---------------------------------------- Memory Allocator -------------------------------------------------------- */
+    {
+        VoMemoryCreateInfo memoryInfo =
+            {
+                .instance         = instance,
+                .device           = deviceInfo.logical,
+                .physicalDevice   = deviceInfo.physical,
+                .vulkanApiVersion = std::min( GetPhysicalProperties()->deviceProperties.apiVersion, (uint32_t)VK_API_VERSION_1_3 ),
+            };
+
+        m_memory = voMemory::Create( memoryInfo );
+        if( m_memory == nullptr )
+            {
+                throw std::runtime_error( "Failed to create memory allocator" );
+            }
+    }
+
+    /* ---------------------------------------- Upload Context ---------------------------------------------------------- */
+    {
+        voUploadContext::CreateParms_t uploadParms =
+            {
+                .stagingSize = STAGING_RING_SIZE,
+                .frameBudget = UPLOAD_FRAME_BUDGET,
+            };
+
+        if( !m_uploadContext.Create( this, uploadParms ) )
+            {
+                throw std::runtime_error( "Failed to create upload context" );
+            }
+    }
+
+    /* ---------------------------------------- Compute Context --------------------------------------------------------- */
+    {
+        voComputeContext::CreateParms_t computeParms =
+            {
+                .numCommandBuffers = COMPUTE_COMMAND_BUFFERS,
+            };
+
+        if( !m_computeContext.Create( this, computeParms ) )
+            {
+                throw std::runtime_error( "Failed to create compute context" );
+            }
+    }
 
     return true;
 }
@@ -533,6 +982,32 @@ voDeviceContext::CreateCommandBuffers()
                   "Failed to allocate command buffers" );
     }
 
+    /* ---------------------------------------- Thread Command Pools ---------------------------------------------------- */
+    {
+        voCommandAllocator::CreateParms_t allocatorParms =
+            {
+                .numThreads  = m_jobSystem.GetNumThreads(),
+                .numFrames   = voSwapChain::MAX_FRAMES_IN_FLIGHT,
+                .queueFamily = static_cast< uint32_t >( queueIds.graphicsFamily ),
+            };
+
+        if( !m_commandAllocator.Create( this, allocatorParms ) )
+            {
+                throw std::runtime_error( "Failed to create thread command pools" );
+            }
+
+        voDescriptorAllocator::CreateParms_t descriptorParms =
+            {
+                .numFrames   = voSwapChain::MAX_FRAMES_IN_FLIGHT,
+                .initialSets = FRAME_DESCRIPTOR_SETS,
+            };
+
+        if( !m_descriptorAllocator.Create( this, descriptorParms ) )
+            {
+                throw std::runtime_error( "Failed to create frame descriptor pools" );
+            }
+    }
+
     return true;
 }
 
@@ -564,7 +1039,7 @@ voDeviceContext::CreateCommandBuffer( VkCommandBufferLevel level )
 }
 
 void
-voDeviceContext::FlushCommandBuffer( VkCommandBuffer commandBuffer, VkQueue queue )
+voDeviceContext::FlushCommandBuffer( VkCommandBuffer commandBuffer, voQueue * queue )
 {
     if( commandBuffer == VK_NULL_HANDLE ) return;
 
@@ -573,17 +1048,13 @@ voDeviceContext::FlushCommandBuffer( VkCommandBuffer commandBuffer, VkQueue queu
 
     /* ---------------------------------------- Submit ------------------------------------------------------------------ */
     {
-        voFence fence( this );
-
-        VkSubmitInfo submitInfo =
+        voQueue::submit_t submit =
             {
-                .sType              = VK_STRUCTURE_TYPE_SUBMIT_INFO,
-                .commandBufferCount = 1,
-                .pCommandBuffers    = &commandBuffer,
+                .numCommandBuffers = 1,
+                .commandBuffers    = &commandBuffer,
             };
 
-        VK_CHECK( vkQueueSubmit( queue, 1, &submitInfo, fence.GetFence() ),
-                  "Failed to submit command buffer to queue!" );
+        queue->Wait( this, queue->Submit( this, submit ) );
     }
 
     vkFreeCommandBuffers( deviceInfo.logical, m_vkCommandPool, 1, &commandBuffer );
@@ -2,32 +2,72 @@
 #include "vulkano/vo_deviceContext.hpp"
 #include <vulkan/vulkan_core.h>
 
+// ======================================================================================================================
+// ============================================ Fence Pool ==============================================================
+// ======================================================================================================================
 
-voFence::voFence( voDeviceContext * device )
-    : m_device( device )
+void
+voFencePool::Cleanup( voDeviceContext * device )
 {
-    Create( device );
-}
+    std::lock_guard< std::mutex > lock( m_mutex );
 
-voFence::~voFence()
-{
-    Wait( m_device );
+    for( VkFence fence : m_freeFences )
+        {
+            vkDestroyFence( device->deviceInfo.logical, fence, nullptr );
+        }
+    m_freeFences.clear();
 }
 
+VkFence
+voFencePool::Acquire( voDeviceContext * device )
+{
+    {
+        std::lock_guard< std::mutex > lock( m_mutex );
 
+        if( !m_freeFences.empty() )
+            {
+                VkFence fence = m_freeFences.back();
+                m_freeFences.pop_back();
+                return fence;
+            }
+    }
 
-
-void
-voFence::Create( voDeviceContext * device )
-{
     VkFenceCreateInfo fenceCreateInfo =
     {
         .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
         .flags = 0,
     };
 
-    VK_CHECK( vkCreateFence( device->deviceInfo.logical, &fenceCreateInfo, nullptr, &m_vkFence ),
+    VkFence fence = VK_NULL_HANDLE;
+    VK_CHECK( vkCreateFence( device->deviceInfo.logical, &fenceCreateInfo, nullptr, &fence ),
               "Failed to create fence!" );
+
+    return fence;
+}
+
+void
+voFencePool::Release( voDeviceContext * device, VkFence fence )
+{
+    VK_CHECK( vkResetFences( device->deviceInfo.logical, 1, &fence ),
+              "Failed to reset fence!" );
+
+    std::lock_guard< std::mutex > lock( m_mutex );
+    m_freeFences.push_back( fence );
+}
+
+// ======================================================================================================================
+// ============================================ Fence ===================================================================
+// ======================================================================================================================
+
+voFence::voFence( voDeviceContext * device )
+    : m_device( device )
+{
+    m_vkFence = device->m_fencePool.Acquire( device );
+}
+
+voFence::~voFence()
+{
+    Wait( m_device );
 }
 
 void
@@ -36,5 +76,6 @@ voFence::Wait( voDeviceContext * device )
     VK_CHECK( vkWaitForFences( device->deviceInfo.logical, 1, &m_vkFence, VK_TRUE, UINT64_MAX ),
               "Failed to wait for fence!" );
 
-    vkDestroyFence( device->deviceInfo.logical, m_vkFence, nullptr );
+    device->m_fencePool.Release( device, m_vkFence );
+    m_vkFence = VK_NULL_HANDLE;
 }
@@ -15,7 +15,8 @@ voFrameBuffer::Resize( voDeviceContext * device, const uint32_t & width, const u
     new_parms.width = width;
     new_parms.height = height;
 
-    Cleanup( device );
+    // The attachments may still be used by frames in flight
+    device->m_deletionQueue.Release( *this );
     Create( device, new_parms );
 }
 
@@ -46,6 +47,9 @@ voFrameBuffer::Create( voDeviceContext * device, CreateParms_t & parms )
 
     std::vector< VkImageView > imageViews { };
 
+    // Both attachment transitions go out in a single submission
+    device->m_uploadContext.BeginBatch();
+
     /* ---------------------------------------- Color ------------------------------------------------------------ */
     if ( parms.hasColor )
     {
@@ -82,6 +86,8 @@ voFrameBuffer::Create( voDeviceContext * device, CreateParms_t & parms )
         imageViews.push_back( imageDepth.vkImageView );
     }
 
+    device->m_uploadContext.EndBatch( device );
+
     /* ---------------------------------------- Framebuffer -------------------------------------------------------- */
     CreateRenderPass( device );
 
@@ -229,7 +235,7 @@ voFrameBuffer::CreateRenderPass( voDeviceContext * device )
 }
 
 void
-voFrameBuffer::BeginRenderPass( voDeviceContext * device, const int cmdBufferIndex )
+voFrameBuffer::BeginRenderPass( voDeviceContext * device, const int cmdBufferIndex, VkSubpassContents contents )
 {
     /* -------------------------------------- Clear Values --------------------------------------------------------- */
     {
@@ -266,7 +272,13 @@ voFrameBuffer::BeginRenderPass( voDeviceContext * device, const int cmdBufferInd
             .pClearValues    = clearValues.data(),
         };
 
-        vkCmdBeginRenderPass( device->m_vkCommandBuffers[ cmdBufferIndex ], &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE );
+        vkCmdBeginRenderPass( device->m_vkCommandBuffers[ cmdBufferIndex ], &renderPassBeginInfo, contents );
+    }
+
+    // Only secondary command buffers can be executed, they set their own dynamic state
+    if ( VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS == contents )
+    {
+        return;
     }
 
     /* -------------------------------------- Viewport & Scissor --------------------------------------------------- */
@@ -304,3 +316,23 @@ voFrameBuffer::EndRenderPass( voDeviceContext * device, const int cmdBufferIndex
 {
     vkCmdEndRenderPass( device->m_vkCommandBuffers[ cmdBufferIndex ] );
 }
+
+voCommandAllocator::inheritance_t
+voFrameBuffer::GetInheritance() const
+{
+    voCommandAllocator::inheritance_t inheritance =
+    {
+        .renderPass  = vkRenderPass,
+        .framebuffer = vkFrameBuffer,
+        .extent      = { parms.width, parms.height },
+    };
+
+    // Shadow maps are biased, as in BeginRenderPass
+    if ( parms.hasDepth && !parms.hasColor )
+    {
+        inheritance.depthBiasConstant = SHADOW_BIAS;
+        inheritance.depthBiasSlope    = SHADOW_SLOPE;
+    }
+
+    return inheritance;
+}
@@ -1,4 +1,6 @@
 #include "vulkano/vo_image.hpp"
+#include <algorithm>
+#include "vulkano/vo_descriptor.hpp"
 #include "vulkano/vo_deviceContext.hpp"
 
 bool
@@ -34,36 +36,33 @@ voImage::Create( voDeviceContext * device, const CreateParms_t & parms )
                 image.imageType = VK_IMAGE_TYPE_3D;
             }
 
+        // Extra usages (e.g. storage for compute passes) are kept on top of the render target ones
         if( VK_FORMAT_D32_SFLOAT == parms.format )
             {
-                image.usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+                image.usage |= VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
             }
         else
             {
-                image.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+                image.usage |= VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
             }
 
-        VK_CHECK( vkCreateImage( device->deviceInfo.logical, &image, VK_NULL_HANDLE, &vkImage ),
-                  "Failed to create image" );
-    }
-
-    /* ------------------------------------------------ Allocate Memory ------------------------------------------------ */
-    {
-        VkMemoryRequirements memReqs {};
-        vkGetImageMemoryRequirements( device->deviceInfo.logical, vkImage, &memReqs );
+        uint32_t families[2];
+        if( parms.concurrent && device->GetConcurrentFamilies( families ) > 1 )
+            {
+                image.sharingMode           = VK_SHARING_MODE_CONCURRENT;
+                image.queueFamilyIndexCount = 2;
+                image.pQueueFamilyIndices   = families;
+            }
 
-        VkMemoryAllocateInfo memAlloc =
+        voMemory::AllocationParms_t allocParms =
             {
-                .sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
-                .allocationSize  = memReqs.size,
-                .memoryTypeIndex = device->FindMemoryTypeIndex( memReqs.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT ),
+                .memoryClass = voMemory::MEMORY_CLASS_RENDER_TARGET,
+                .usage       = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE,
+                .dedicated   = parms.dedicated == 1,
             };
 
-        VK_CHECK( vkAllocateMemory( device->deviceInfo.logical, &memAlloc, VK_NULL_HANDLE, &vkDeviceMemory ),
-                  "Failed to allocate memory" );
-
-        VK_CHECK( vkBindImageMemory( device->deviceInfo.logical, vkImage, vkDeviceMemory, 0 ),
-                  "Failed to bind image memory" );
+        VK_CHECK( device->m_memory->CreateImage( image, allocParms, vkImage, vmaAllocation ),
+                  "Failed to create image" );
     }
 
     /* ------------------------------------------------ Create Image View ----------------------------------------------- */
@@ -110,54 +109,30 @@ voImage::Create( voDeviceContext * device, const CreateParms_t & parms )
 void
 voImage::Cleanup( voDeviceContext * device ) const
 {
+    voDescriptors::Forget( device, reinterpret_cast< uint64_t >( vkImageView ) );
     vkDestroyImageView( device->deviceInfo.logical, vkImageView, VK_NULL_HANDLE );
-    vkDestroyImage( device->deviceInfo.logical, vkImage, VK_NULL_HANDLE );
-    vkFreeMemory( device->deviceInfo.logical, vkDeviceMemory, VK_NULL_HANDLE );
+    device->m_memory->DestroyImage( vkImage, vmaAllocation );
 }
 
 void
 voImage::TransitionLayout( voDeviceContext * device )
 {
-    // Transition the image layout
-    VkCommandBuffer vkCommandBuffer = device->CreateCommandBuffer( VK_COMMAND_BUFFER_LEVEL_PRIMARY );
+    const VkImageAspectFlags aspect = ( VK_FORMAT_D32_SFLOAT == parms.format ) ? VK_IMAGE_ASPECT_DEPTH_BIT : VK_IMAGE_ASPECT_COLOR_BIT;
 
-    VkImageMemoryBarrier barrier =
-        {
-            .sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
-            .srcAccessMask       = 0,
-            .dstAccessMask       = VK_ACCESS_TRANSFER_WRITE_BIT,
-            .oldLayout           = VK_IMAGE_LAYOUT_UNDEFINED,
-            .newLayout           = VK_IMAGE_LAYOUT_GENERAL,
-            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-            .image               = vkImage,
-            .subresourceRange    = {
-                                    .aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT,
-                                    .baseMipLevel   = 0,
-                                    .levelCount     = 1,
-                                    .baseArrayLayer = 0,
-                                    .layerCount     = 1 },
-    };
-
-    if( VK_FORMAT_D32_SFLOAT == parms.format )
-        {
-            barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
-        }
+    // Batched with the other setup work, the graphics queue orders it before the frames using the image
+    device->m_uploadContext.TransitionImage( device, vkImage, aspect, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL );
 
-    VkPipelineStageFlags sourceStage      = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-    VkPipelineStageFlags destinationStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
+    vkImageLayout = VK_IMAGE_LAYOUT_GENERAL;
+}
 
-    vkCmdPipelineBarrier(
-        vkCommandBuffer,
-        sourceStage, destinationStage,
-        0,
-        0, VK_NULL_HANDLE,
-        0, VK_NULL_HANDLE,
-        1, &barrier );
+void
+voImage::Upload( voDeviceContext * device, const void * data, VkDeviceSize size, VkImageLayout finalLayout )
+{
+    const VkImageAspectFlags aspect = ( VK_FORMAT_D32_SFLOAT == parms.format ) ? VK_IMAGE_ASPECT_DEPTH_BIT : VK_IMAGE_ASPECT_COLOR_BIT;
 
-    device->FlushCommandBuffer( vkCommandBuffer, device->m_vkGraphicsQueue );
+    device->m_uploadContext.UploadImage( device, vkImage, aspect, { parms.width, parms.height, std::max( parms.depth, 1U ) }, data, size, finalLayout );
 
-    vkImageLayout = VK_IMAGE_LAYOUT_GENERAL;
+    vkImageLayout = finalLayout;
 }
 
 void
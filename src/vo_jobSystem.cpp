@@ -0,0 +1,279 @@
+#include "vulkano/vo_jobSystem.hpp"
+#include <algorithm>
+
+static thread_local uint32_t s_threadIndex = voJobSystem::INVALID_THREAD_INDEX;
+
+bool
+voJobSystem::Create( const CreateParms_t & parms )
+{
+    voAssert( m_workers.empty() && "Job system already created" );
+
+    m_numThreads = parms.numWorkers + 1;
+    m_queues     = std::make_unique< thread_queue_t[] >( m_numThreads );
+    m_stop       = false;
+
+    s_threadIndex = 0;
+
+    for( uint32_t i = 1; i < m_numThreads; i++ )
+        {
+            m_workers.emplace_back( &voJobSystem::WorkerLoop, this, i );
+        }
+
+    return true;
+}
+
+void
+voJobSystem::Cleanup()
+{
+    {
+        std::lock_guard< std::mutex > lock( m_sleepMutex );
+        m_stop = true;
+    }
+    m_wakeup.notify_all();
+
+    // Workers leave once the deques are empty
+    for( std::thread & worker : m_workers )
+        {
+            worker.join();
+        }
+    m_workers.clear();
+
+    // Whatever the workers could not run is left to the main thread
+    while( RunOneMainThreadJob() || ( m_numThreads > 0 && RunOneJob( 0 ) ) )
+        {
+        }
+
+    m_queues.reset();
+    m_numThreads = 0;
+}
+
+voJobSystem::handle_t
+voJobSystem::Schedule( std::function< void() > && func, const std::vector< handle_t > & dependencies, affinity_t affinity )
+{
+    handle_t job  = std::make_shared< job_t >();
+    job->func     = std::move( func );
+    job->affinity = affinity;
+
+    for( const handle_t & dependency : dependencies )
+        {
+            if( dependency == nullptr )
+                {
+                    continue;
+                }
+
+            std::lock_guard< std::mutex > lock( dependency->mutex );
+            if( !dependency->done.load( std::memory_order_acquire ) )
+                {
+                    job->numPending.fetch_add( 1, std::memory_order_relaxed );
+                    dependency->continuations.push_back( job );
+                }
+        }
+
+    // Drops the scheduling reference, the job is queued if every dependency already completed
+    Release( job );
+
+    return job;
+}
+
+voJobSystem::handle_t
+voJobSystem::ParallelFor( uint32_t count, uint32_t grainSize, std::function< void( uint32_t, uint32_t ) > && func, const std::vector< handle_t > & dependencies )
+{
+    grainSize = std::max( grainSize, 1U );
+
+    // Chunks share the function, it outlives the caller
+    auto shared = std::make_shared< std::function< void( uint32_t, uint32_t ) > >( std::move( func ) );
+
+    std::vector< handle_t > chunks;
+    chunks.reserve( ( count + grainSize - 1 ) / grainSize );
+
+    for( uint32_t first = 0; first < count; first += grainSize )
+        {
+            const uint32_t last = std::min( count, first + grainSize );
+            chunks.push_back( Schedule( [shared, first, last]() { ( *shared )( first, last ); }, dependencies ) );
+        }
+
+    // Empty job completing along with the last chunk
+    return Schedule( []() {}, chunks.empty() ? dependencies : chunks );
+}
+
+void
+voJobSystem::Wait( const handle_t & job )
+{
+    const uint32_t threadIndex = GetThreadIndex();
+
+    while( !IsComplete( job ) )
+        {
+            // The job may depend on main thread jobs
+            if( threadIndex == 0 && RunOneMainThreadJob() )
+                {
+                    continue;
+                }
+
+            if( !RunOneJob( threadIndex == INVALID_THREAD_INDEX ? 0 : threadIndex ) )
+                {
+                    std::this_thread::yield();
+                }
+        }
+}
+
+void
+voJobSystem::RunMainThreadJobs()
+{
+    voAssert( GetThreadIndex() == 0 && "Main thread jobs run on the thread that created the job system" );
+
+    // Only the jobs queued so far, those they schedule run on the next call
+    std::deque< handle_t > jobs;
+    {
+        std::lock_guard< std::mutex > lock( m_mainMutex );
+        jobs.swap( m_mainJobs );
+    }
+
+    for( const handle_t & job : jobs )
+        {
+            Execute( job );
+        }
+}
+
+uint32_t
+voJobSystem::GetThreadIndex()
+{
+    return s_threadIndex;
+}
+
+void
+voJobSystem::Enqueue( const handle_t & job )
+{
+    voAssert( m_numThreads > 0 && "Job system not created" );
+
+    if( job->affinity == AFFINITY_MAIN_THREAD )
+        {
+            std::lock_guard< std::mutex > lock( m_mainMutex );
+            m_mainJobs.push_back( job );
+            return;
+        }
+
+    // Threads outside of the system share the deque of the main thread
+    const uint32_t   threadIndex = GetThreadIndex();
+    thread_queue_t & queue       = m_queues[threadIndex < m_numThreads ? threadIndex : 0];
+
+    {
+        std::lock_guard< std::mutex > lock( queue.mutex );
+        queue.jobs.push_back( job );
+    }
+
+    // Counted under the sleep lock, so a worker about to sleep cannot miss the wake up
+    {
+        std::lock_guard< std::mutex > lock( m_sleepMutex );
+        m_numQueued.fetch_add( 1, std::memory_order_release );
+    }
+    m_wakeup.notify_one();
+}
+
+void
+voJobSystem::Release( const handle_t & job )
+{
+    if( job->numPending.fetch_sub( 1, std::memory_order_acq_rel ) == 1 )
+        {
+            Enqueue( job );
+        }
+}
+
+void
+voJobSystem::Execute( const handle_t & job )
+{
+    job->func();
+    job->func = nullptr;
+
+    std::vector< handle_t > continuations;
+    {
+        std::lock_guard< std::mutex > lock( job->mutex );
+        job->done.store( true, std::memory_order_release );
+        continuations.swap( job->continuations );
+    }
+
+    for( const handle_t & continuation : continuations )
+        {
+            Release( continuation );
+        }
+}
+
+bool
+voJobSystem::RunOneJob( uint32_t threadIndex )
+{
+    handle_t job;
+
+    // Own deque first, newest job first while its data is still in cache
+    {
+        thread_queue_t &              queue = m_queues[threadIndex];
+        std::lock_guard< std::mutex > lock( queue.mutex );
+        if( !queue.jobs.empty() )
+            {
+                job = std::move( queue.jobs.back() );
+                queue.jobs.pop_back();
+            }
+    }
+
+    // Then steal the oldest job of another thread
+    for( uint32_t i = 1; job == nullptr && i < m_numThreads; i++ )
+        {
+            thread_queue_t &              queue = m_queues[( threadIndex + i ) % m_numThreads];
+            std::lock_guard< std::mutex > lock( queue.mutex );
+            if( !queue.jobs.empty() )
+                {
+                    job = std::move( queue.jobs.front() );
+                    queue.jobs.pop_front();
+                }
+        }
+
+    if( job == nullptr )
+        {
+            return false;
+        }
+
+    m_numQueued.fetch_sub( 1, std::memory_order_relaxed );
+    Execute( job );
+
+    return true;
+}
+
+bool
+voJobSystem::RunOneMainThreadJob()
+{
+    handle_t job;
+    {
+        std::lock_guard< std::mutex > lock( m_mainMutex );
+        if( m_mainJobs.empty() )
+            {
+                return false;
+            }
+
+        job = std::move( m_mainJobs.front() );
+        m_mainJobs.pop_front();
+    }
+
+    Execute( job );
+
+    return true;
+}
+
+void
+voJobSystem::WorkerLoop( uint32_t threadIndex )
+{
+    s_threadIndex = threadIndex;
+
+    while( true )
+        {
+            if( RunOneJob( threadIndex ) )
+                {
+                    continue;
+                }
+
+            std::unique_lock< std::mutex > lock( m_sleepMutex );
+            m_wakeup.wait( lock, [this]() { return m_stop || m_numQueued.load( std::memory_order_acquire ) > 0; } );
+
+            if( m_stop && m_numQueued.load( std::memory_order_acquire ) == 0 )
+                {
+                    return;
+                }
+        }
+}
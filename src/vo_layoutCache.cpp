@@ -0,0 +1,112 @@
+#include "vulkano/vo_layoutCache.hpp"
+#include <algorithm>
+#include "vulkano/vo_deviceContext.hpp"
+
+VkDescriptorSetLayout
+voLayoutCache::GetSetLayout( voDeviceContext * device, const std::vector< VkDescriptorSetLayoutBinding > & bindings,
+                             VkDescriptorSetLayoutCreateFlags flags )
+{
+    // Ordered by binding, so the same bindings listed in another order share the layout
+    std::vector< VkDescriptorSetLayoutBinding > sorted = bindings;
+    std::sort( sorted.begin(), sorted.end(), []( const VkDescriptorSetLayoutBinding & a, const VkDescriptorSetLayoutBinding & b )
+               { return a.binding < b.binding; } );
+
+    key_t key { flags };
+    key.reserve( 1 + sorted.size() * 4 );
+    for( const VkDescriptorSetLayoutBinding & binding : sorted )
+        {
+            voAssert( binding.pImmutableSamplers == nullptr && "Immutable samplers are not supported by the layout cache" );
+
+            key.push_back( binding.binding );
+            key.push_back( binding.descriptorType );
+            key.push_back( binding.descriptorCount );
+            key.push_back( binding.stageFlags );
+        }
+
+    std::lock_guard< std::mutex > lock( m_mutex );
+
+    auto found = m_setLayouts.find( key );
+    if( found != m_setLayouts.end() )
+        {
+            return found->second;
+        }
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo =
+        {
+            .sType        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+            .flags        = flags,
+            .bindingCount = static_cast< uint32_t >( sorted.size() ),
+            .pBindings    = sorted.data(),
+        };
+
+    VkDescriptorSetLayout setLayout = VK_NULL_HANDLE;
+    VK_CHECK( vkCreateDescriptorSetLayout( device->deviceInfo.logical, &layoutInfo, nullptr, &setLayout ),
+              "Failed to create descriptor set layout" );
+
+    m_setLayouts.emplace( std::move( key ), setLayout );
+
+    return setLayout;
+}
+
+VkPipelineLayout
+voLayoutCache::GetPipelineLayout( voDeviceContext * device, const std::vector< VkDescriptorSetLayout > & setLayouts,
+                                  const std::vector< VkPushConstantRange > & pushConstants )
+{
+    // Set layouts are told apart by handle, the identical ones already share their handle
+    key_t key { setLayouts.size() };
+    for( VkDescriptorSetLayout setLayout : setLayouts )
+        {
+            key.push_back( reinterpret_cast< uint64_t >( setLayout ) );
+        }
+
+    for( const VkPushConstantRange & range : pushConstants )
+        {
+            key.push_back( range.stageFlags );
+            key.push_back( range.offset );
+            key.push_back( range.size );
+        }
+
+    std::lock_guard< std::mutex > lock( m_mutex );
+
+    auto found = m_pipelineLayouts.find( key );
+    if( found != m_pipelineLayouts.end() )
+        {
+            return found->second;
+        }
+
+    VkPipelineLayoutCreateInfo layoutInfo =
+        {
+            .sType                  = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+            .setLayoutCount         = static_cast< uint32_t >( setLayouts.size() ),
+            .pSetLayouts            = setLayouts.data(),
+            .pushConstantRangeCount = static_cast< uint32_t >( pushConstants.size() ),
+            .pPushConstantRanges    = pushConstants.data(),
+        };
+
+    VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+    VK_CHECK( vkCreatePipelineLayout( device->deviceInfo.logical, &layoutInfo, nullptr, &pipelineLayout ),
+              "Failed to create pipeline layout" );
+
+    m_pipelineLayouts.emplace( std::move( key ), pipelineLayout );
+
+    return pipelineLayout;
+}
+
+void
+voLayoutCache::Cleanup( voDeviceContext * device )
+{
+    std::lock_guard< std::mutex > lock( m_mutex );
+
+    for( const auto & [key, pipelineLayout] : m_pipelineLayouts )
+        {
+            vkDestroyPipelineLayout( device->deviceInfo.logical, pipelineLayout, nullptr );
+        }
+
+    for( const auto & [key, setLayout] : m_setLayouts )
+        {
+            vkDestroyDescriptorSetLayout( device->deviceInfo.logical, setLayout, nullptr );
+        }
+
+    m_pipelineLayouts.clear();
+    m_setLayouts.clear();
+}
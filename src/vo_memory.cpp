@@ -1,5 +1,6 @@
 #include "vulkano/vo_memory.hpp"
 #include <sstream>
+#include "vulkano/vo_common.hpp"
 
 #define VMA_IMPLEMENTATION
 //#define VMA_SYSTEM_ALIGNED_MALLOC(size, alignment) org_lwjgl_aligned_alloc((alignment), (size))
@@ -13,6 +14,14 @@
 #define VMA_EXTERNAL_MEMORY 1
 #include "vk_mem_alloc.h"
 
+#ifndef GEOMETRY_BLOCK_SIZE
+#    define GEOMETRY_BLOCK_SIZE ( 64ULL * 1024 * 1024 )
+#endif /** GEOMETRY_BLOCK_SIZE */
+
+#ifndef FRAME_LINEAR_BLOCK_SIZE
+#    define FRAME_LINEAR_BLOCK_SIZE ( 16ULL * 1024 * 1024 )
+#endif /** FRAME_LINEAR_BLOCK_SIZE */
+
 voMemory *
 voMemory::Create( const VoMemoryCreateInfo & createInfo )
 {
@@ -26,6 +35,12 @@ voMemory::Create( const VoMemoryCreateInfo & createInfo )
     allocatorInfo.device                 = createInfo.device;
     allocatorInfo.instance               = createInfo.instance;
 
+    // Dynamic function loading requires the two entry points, VMA fetches the rest
+    VmaVulkanFunctions vulkanFunctions    = {};
+    vulkanFunctions.vkGetInstanceProcAddr = vkGetInstanceProcAddr;
+    vulkanFunctions.vkGetDeviceProcAddr   = vkGetDeviceProcAddr;
+    allocatorInfo.pVulkanFunctions        = &vulkanFunctions;
+
     if( createInfo.enableHeapBudget )
         {
             allocatorInfo.flags |= VMA_ALLOCATOR_CREATE_EXT_MEMORY_BUDGET_BIT;
@@ -58,8 +73,14 @@ voMemory::Destroy()
                                 }
                             ss << "\n";
                         }
-                    // Log or print ss.str()
+                    spdlog::warn( ss.str() );
+                }
+
+            for( const auto & [key, pool] : m_pools )
+                {
+                    vmaDestroyPool( m_allocator, pool );
                 }
+            m_pools.clear();
 
             vmaDestroyAllocator( m_allocator );
             m_allocator = nullptr;
@@ -95,6 +116,37 @@ voMemory::CreateBuffer(
     return result;
 }
 
+VkResult
+voMemory::CreateBuffer(
+    const VkBufferCreateInfo & bufferInfo,
+    const AllocationParms_t & parms,
+    VkBuffer & buffer,
+    VmaAllocation & allocation,
+    VmaAllocationInfo * allocationInfo )
+{
+    VmaAllocationCreateInfo allocInfo = MakeAllocationInfo( parms );
+
+    if( !parms.dedicated && parms.memoryClass != MEMORY_CLASS_DEFAULT )
+        {
+            uint32_t memoryTypeIndex = 0;
+            if( vmaFindMemoryTypeIndexForBufferInfo( m_allocator, &bufferInfo, &allocInfo, &memoryTypeIndex ) == VK_SUCCESS )
+                {
+                    allocInfo.pool = GetPool( parms.memoryClass, memoryTypeIndex );
+                }
+        }
+
+    VkResult result = CreateBuffer( bufferInfo, allocInfo, buffer, allocation, allocationInfo );
+
+    // Pools have a fixed block size, anything that does not fit goes to the default pools
+    if( result != VK_SUCCESS && allocInfo.pool != VK_NULL_HANDLE )
+        {
+            allocInfo.pool = VK_NULL_HANDLE;
+            result         = CreateBuffer( bufferInfo, allocInfo, buffer, allocation, allocationInfo );
+        }
+
+    return result;
+}
+
 VkResult
 voMemory::CreateImage(
     const VkImageCreateInfo & imageInfo,
@@ -127,6 +179,37 @@ voMemory::CreateImage(
     return result;
 }
 
+VkResult
+voMemory::CreateImage(
+    const VkImageCreateInfo & imageInfo,
+    const AllocationParms_t & parms,
+    VkImage & image,
+    VmaAllocation & allocation,
+    VmaAllocationInfo * allocationInfo )
+{
+    VmaAllocationCreateInfo allocInfo = MakeAllocationInfo( parms );
+
+    if( !parms.dedicated && parms.memoryClass != MEMORY_CLASS_DEFAULT )
+        {
+            uint32_t memoryTypeIndex = 0;
+            if( vmaFindMemoryTypeIndexForImageInfo( m_allocator, &imageInfo, &allocInfo, &memoryTypeIndex ) == VK_SUCCESS )
+                {
+                    allocInfo.pool = GetPool( parms.memoryClass, memoryTypeIndex );
+                }
+        }
+
+    VkResult result = CreateImage( imageInfo, allocInfo, image, allocation, allocationInfo );
+
+    // Pools have a fixed block size, anything that does not fit goes to the default pools
+    if( result != VK_SUCCESS && allocInfo.pool != VK_NULL_HANDLE )
+        {
+            allocInfo.pool = VK_NULL_HANDLE;
+            result         = CreateImage( imageInfo, allocInfo, image, allocation, allocationInfo );
+        }
+
+    return result;
+}
+
 void
 voMemory::DestroyBuffer( VkBuffer buffer, VmaAllocation allocation )
 {
@@ -161,6 +244,20 @@ voMemory::UnmapMemory( VmaAllocation allocation )
     vmaUnmapMemory( m_allocator, allocation );
 }
 
+VkResult
+voMemory::FlushMemory( VmaAllocation allocation, VkDeviceSize offset, VkDeviceSize size )
+{
+    return vmaFlushAllocation( m_allocator, allocation, offset, size );
+}
+
+VkMemoryPropertyFlags
+voMemory::GetMemoryProperties( VmaAllocation allocation ) const
+{
+    VkMemoryPropertyFlags flags = 0;
+    vmaGetAllocationMemoryProperties( m_allocator, allocation, &flags );
+    return flags;
+}
+
 VkResult
 voMemory::CreatePool( const VmaPoolCreateInfo & createInfo, VmaPool & pool )
 {
@@ -215,3 +312,72 @@ voMemory::DefragmentationEnd(
 {
     vmaEndDefragmentation( m_allocator, context, nullptr );
 }
+
+VmaAllocationCreateInfo
+voMemory::MakeAllocationInfo( const AllocationParms_t & parms )
+{
+    VmaAllocationCreateInfo allocInfo =
+        {
+            .flags          = parms.flags,
+            .usage          = parms.usage,
+            .requiredFlags  = parms.requiredFlags,
+            .preferredFlags = parms.preferredFlags,
+            .pUserData      = const_cast< char * >( parms.debugName ),
+            .priority       = parms.memoryClass == MEMORY_CLASS_RENDER_TARGET ? 1.0F : 0.5F,
+        };
+
+    if( parms.dedicated )
+        {
+            allocInfo.flags |= VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT;
+        }
+
+    return allocInfo;
+}
+
+VmaPool
+voMemory::GetPool( MemoryClass_t memoryClass, uint32_t memoryTypeIndex )
+{
+    const uint64_t key = ( static_cast< uint64_t >( memoryClass ) << 32 ) | memoryTypeIndex;
+
+    std::lock_guard< std::mutex > lock( m_poolMutex );
+
+    auto it = m_pools.find( key );
+    if( it != m_pools.end() )
+        {
+            return it->second;
+        }
+
+    VmaPoolCreateInfo poolInfo =
+        {
+            .memoryTypeIndex = memoryTypeIndex,
+        };
+
+    switch( memoryClass )
+        {
+            case MEMORY_CLASS_GEOMETRY:
+                // Few big blocks, geometry stays resident for the whole level
+                poolInfo.blockSize = GEOMETRY_BLOCK_SIZE;
+                break;
+            case MEMORY_CLASS_FRAME_LINEAR:
+                // Transient data is released in allocation order, a linear allocator avoids any fragmentation
+                poolInfo.flags     = VMA_POOL_CREATE_LINEAR_ALGORITHM_BIT;
+                poolInfo.blockSize = FRAME_LINEAR_BLOCK_SIZE;
+                break;
+            case MEMORY_CLASS_RENDER_TARGET:
+                // Keep attachments resident when the heap is under pressure
+                poolInfo.priority = 1.0F;
+                break;
+            default:
+                break;
+        }
+
+    VmaPool pool = VK_NULL_HANDLE;
+    if( vmaCreatePool( m_allocator, &poolInfo, &pool ) != VK_SUCCESS )
+        {
+            spdlog::warn( "Failed to create memory pool for class {} (memory type {})", (int)memoryClass, memoryTypeIndex );
+            return VK_NULL_HANDLE;
+        }
+
+    m_pools[key] = pool;
+    return pool;
+}
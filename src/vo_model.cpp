@@ -238,28 +238,33 @@ FillTriangle( voModel & model )
 bool
 voModel::MakeVBO( voDeviceContext * device )
 {
-    VkCommandBuffer vkCommandBuffer = device->m_vkCommandBuffers[0];
+    VkDeviceSize bufferSize;
 
-    int bufferSize;
+    // Vertex and index data are staged together and submitted once
+    device->m_uploadContext.BeginBatch();
 
     // Create Vertex Buffer
-    bufferSize = (int)( sizeof( m_vertices[0] ) * m_vertices.size() );
+    bufferSize = sizeof( m_vertices[0] ) * m_vertices.size();
     if( !m_vertexBuffer.Allocate( device, m_vertices.data(), bufferSize, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT ) )
         {
             printf( "failed to allocate vertex buffer!\n" );
             assert( 0 );
+            device->m_uploadContext.EndBatch( device );
             return false;
         }
 
     // Create Index Buffer
-    bufferSize = (int)( sizeof( m_indices[0] ) * m_indices.size() );
+    bufferSize = sizeof( m_indices[0] ) * m_indices.size();
     if( !m_indexBuffer.Allocate( device, m_indices.data(), bufferSize, VK_BUFFER_USAGE_INDEX_BUFFER_BIT ) )
         {
             printf( "failed to allocate index buffer!\n" );
             assert( 0 );
+            device->m_uploadContext.EndBatch( device );
             return false;
         }
 
+    device->m_uploadContext.EndBatch( device );
+
     m_isVBO = true;
     return true;
 }
@@ -540,8 +545,9 @@ voModel::Cleanup( voDeviceContext & deviceContext ) const
 {
     if( !m_isVBO ) return;
 
-    m_vertexBuffer.Cleanup( &deviceContext );
-    m_indexBuffer.Cleanup( &deviceContext );
+    // The buffers may still be read by frames in flight, e.g. when reloading the model
+    deviceContext.m_deletionQueue.Release( m_vertexBuffer );
+    deviceContext.m_deletionQueue.Release( m_indexBuffer );
 }
 
 void
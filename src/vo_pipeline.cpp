@@ -1,30 +1,190 @@
 #include "vulkano/vo_pipeline.hpp"
+#include <algorithm>
+#include <array>
+#include <map>
+#include <memory>
+#include <sstream>
+#include "vulkano/vo_bindless.hpp"
 #include "vulkano/vo_descriptor.hpp"
 #include "vulkano/vo_deviceContext.hpp"
 #include "vulkano/vo_frameBuffer.hpp"
 #include "vulkano/vo_model.hpp"
+#include "vulkano/vo_pipelineRegistry.hpp"
 #include "vulkano/vo_shader.hpp"
 
 #ifndef SHADER_ENTRY_POINT
 #    define SHADER_ENTRY_POINT "main"
 #endif /** SHADER_ENTRY_POINT */
 
-bool
-voPipeline::Create( voDeviceContext * device, const CreateParms_t & parms )
+/**
+ * The parts of a graphics pipeline compiled apart with VK_EXT_graphics_pipeline_library, in flag bit order.
+ */
+enum library_t
+{
+    LIBRARY_VERTEX_INPUT,
+    LIBRARY_PRE_RASTERIZATION,
+    LIBRARY_FRAGMENT_SHADER,
+    LIBRARY_FRAGMENT_OUTPUT,
+    LIBRARY_COUNT
+};
+
+/**
+ * The create infos of a graphics pipeline and its key, owned by the compile which may run on a worker.
+ */
+struct graphics_state_t
+{
+    std::vector< VkPipelineShaderStageCreateInfo >   shaderStages {};
+    VkVertexInputBindingDescription                  bindingDescription {};
+    std::vector< VkVertexInputAttributeDescription > attributeDescriptions {};
+    VkViewport                                       viewport {};
+    VkRect2D                                         scissor {};
+    std::vector< VkDynamicState >                    dynamicStates {};
+    VkPipelineColorBlendAttachmentState              colorBlendAttachment {};
+
+    VkPipelineVertexInputStateCreateInfo   vertexInputInfo {};
+    VkPipelineInputAssemblyStateCreateInfo inputAssemblyInfo {};
+    VkPipelineViewportStateCreateInfo      viewportStateInfo {};
+    VkPipelineDynamicStateCreateInfo       dynamicStateInfo {};
+    VkPipelineRasterizationStateCreateInfo rasterizerInfo {};
+    VkPipelineMultisampleStateCreateInfo   multisamplingInfo {};
+    VkPipelineDepthStencilStateCreateInfo  depthStencilInfo {};
+    VkPipelineColorBlendStateCreateInfo    colorBlendingInfo {};
+    VkGraphicsPipelineCreateInfo           pipelineInfo {};
+
+    voPipelineRegistry::key_t                              key {};
+    std::array< voPipelineRegistry::key_t, LIBRARY_COUNT > libraryKeys {}; ///< Only built with graphics pipeline libraries
+};
+
+/**
+ * The create info of a compute pipeline and its key.
+ */
+struct compute_state_t
+{
+    VkComputePipelineCreateInfo pipelineInfo {};
+    voPipelineRegistry::key_t   key {};
+};
+
+/**
+ * What rebuilds a pipeline on the next run, from a line of the warm-up manifest.
+ */
+struct recipe_t
+{
+    VkPipelineBindPoint                         bindPoint { VK_PIPELINE_BIND_POINT_GRAPHICS };
+    std::string                                 shader {};
+    voPipeline::CreateParms_t                   parms {};
+    bool                                        hasSetLayout { false };
+    VkDescriptorSetLayoutCreateFlags            setLayoutFlags { 0 };
+    std::vector< VkDescriptorSetLayoutBinding > setLayoutBindings {};
+};
+
+/**
+ * Set layout of the descriptors of the pipeline, if any.
+ */
+static VkDescriptorSetLayout
+GetSetLayout( const voPipeline::CreateParms_t & parms )
+{
+    return parms.descriptors != nullptr ? parms.descriptors->vkDescriptorSetLayout : VK_NULL_HANDLE;
+}
+
+/**
+ * Pipeline layout from the layout cache: the set layout of its own descriptors, then the bindless set at `voBindless::SET_INDEX`,
+ * and the push constants given by the parameters or else reflected from the shaders.
+ */
+static VkPipelineLayout
+GetPipelineLayout( voDeviceContext * device, const voPipeline::CreateParms_t & parms, VkDescriptorSetLayout setLayout, VkShaderStageFlags pushConstantStages )
 {
-    if( VK_NULL_HANDLE != vkPipeline )
+    std::vector< VkDescriptorSetLayout > setLayouts {};
+
+    // Check if descriptors are present and have bindings
+    if( setLayout != VK_NULL_HANDLE )
         {
-            Cleanup( device );
+            setLayouts.push_back( setLayout );
+        }
+
+    if( parms.bindless != nullptr )
+        {
+            // Sets below the bindless one are empty when the pipeline has no descriptors
+            setLayouts.resize( voBindless::SET_INDEX, parms.bindless->vkEmptySetLayout );
+            setLayouts.push_back( parms.bindless->vkDescriptorSetLayout );
+        }
+
+    std::vector< VkPushConstantRange > pushConstants {};
+    if( parms.pushConstantSize > 0 )
+        {
+            pushConstants.push_back( {
+                .stageFlags = pushConstantStages, // Shader stage push constant will go to
+                .offset     = 0,                  // Offset into given data to pass to push constant
+                .size       = parms.pushConstantSize,
+            } );
+        }
+    else if( parms.shader != nullptr && parms.shader->reflection.pushConstants.size > 0 )
+        {
+            pushConstants.push_back( parms.shader->reflection.pushConstants );
+        }
+
+    return device->m_layoutCache.GetPipelineLayout( device, setLayouts, pushConstants );
+}
+
+/**
+ * Adds the stages of the shader and the hashes of their code to a pipeline key, in stage order.
+ */
+static void
+AddShaderKey( voPipelineRegistry::key_t & key, const voShader * shader, VkShaderStageFlags stages = VK_SHADER_STAGE_ALL )
+{
+    for( int i = 0; i < voShader::SHADER_STAGE_NUM; i++ )
+        {
+            auto module = shader->modules.find( static_cast< voShader::ShaderStage_t >( i ) );
+            if( module != shader->modules.end() && ( module->second.stage & stages ) != 0 )
+                {
+                    key.insert( key.end(), { module->second.stage, module->second.hash } );
+                }
+        }
+}
+
+/**
+ * Cull mode flags of a cull mode.
+ */
+static VkCullModeFlags
+GetCullModeFlags( voPipeline::CullMode_t cullMode )
+{
+    switch( cullMode )
+        {
+            case voPipeline::CULL_MODE_FRONT:
+                return VK_CULL_MODE_FRONT_BIT;
+
+            case voPipeline::CULL_MODE_BACK:
+                return VK_CULL_MODE_BACK_BIT;
+
+            default:
+                return VK_CULL_MODE_NONE;
         }
+}
 
-    m_parms = parms;
+/**
+ * Fills the create infos of a graphics pipeline, and the key of everything it is built from.
+ * With dynamic state the states set when recording are left out, so the pipelines they tell apart share a key.
+ */
+static void
+BuildGraphicsState( const voPipeline::CreateParms_t & createParms, VkPipelineLayout vkPipelineLayout, bool dynamicState, bool dynamicState2,
+                    graphics_state_t & state )
+{
+    voPipeline::CreateParms_t parms = createParms;
+    if( dynamicState )
+        {
+            parms.cullMode   = voPipeline::CULL_MODE_NONE;
+            parms.depthTest  = false;
+            parms.depthWrite = false;
+        }
+    if( dynamicState2 )
+        {
+            parms.depthBias = false;
+        }
 
     const int width  = static_cast< int >( parms.width );
     const int height = static_cast< int >( parms.height );
 
     /* ----------------------------------------- Shader Stages Creation ----------------------------------------- */
 
-    std::vector< VkPipelineShaderStageCreateInfo > shaderStages {};
     for( const auto & module : parms.shader->modules )
         {
             VkPipelineShaderStageCreateInfo shaderStageInfo =
@@ -35,26 +195,48 @@ voPipeline::Create( voDeviceContext * device, const CreateParms_t & parms )
                     .pName  = SHADER_ENTRY_POINT,
                 };
 
-            shaderStages.push_back( shaderStageInfo );
+            state.shaderStages.push_back( shaderStageInfo );
         }
 
     /* ----------------------------------------- Vertex Input ----------------------------------------- */
 
-    VkVertexInputBindingDescription bindingDescription = vert_t::GetBindingDescription();
-    vert_t::AttrDesc attributeDescriptions             = vert_t::GetAttributeDescriptions();
+    state.bindingDescription = vert_t::GetBindingDescription();
+    vert_t::AttrDesc vertexAttributes                  = vert_t::GetAttributeDescriptions();
+
+    state.attributeDescriptions.assign( vertexAttributes.begin(), vertexAttributes.end() );
+
+    // Only fetch the attributes the vertex shader reads
+    const std::vector< voShader::vertexInput_t > & vertexInputs = parms.shader->reflection.vertexInputs;
+    if( !vertexInputs.empty() )
+        {
+            const auto isRead = [&]( uint32_t location )
+            {
+                return std::any_of( vertexInputs.begin(), vertexInputs.end(), [&]( const voShader::vertexInput_t & input ) { return input.location == location; } );
+            };
+
+            for( const voShader::vertexInput_t & input : vertexInputs )
+                {
+                    if( std::none_of( vertexAttributes.begin(), vertexAttributes.end(), [&]( const VkVertexInputAttributeDescription & attribute ) { return attribute.location == input.location; } ) )
+                        {
+                            spdlog::error( "Vertex shader input at location {} is not provided by vert_t", input.location );
+                        }
+                }
+
+            std::erase_if( state.attributeDescriptions, [&]( const VkVertexInputAttributeDescription & attribute ) { return !isRead( attribute.location ); } );
+        }
 
-    VkPipelineVertexInputStateCreateInfo vertexInputInfo =
+    state.vertexInputInfo =
         {
             .sType                           = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
             .vertexBindingDescriptionCount   = 1,                                                       // Number of vertex binding descriptions
-            .pVertexBindingDescriptions      = &bindingDescription,                                     // List of vertex binding descriptions (data spacing/stride information)
-            .vertexAttributeDescriptionCount = static_cast< uint32_t >( attributeDescriptions.size() ), // Number of vertex attribute descriptions
-            .pVertexAttributeDescriptions    = attributeDescriptions.data()                             // List of vertex attribute descriptions (data format and where to bind to from)
+            .pVertexBindingDescriptions      = &state.bindingDescription,                                     // List of vertex binding descriptions (data spacing/stride information)
+            .vertexAttributeDescriptionCount = static_cast< uint32_t >( state.attributeDescriptions.size() ), // Number of vertex attribute descriptions
+            .pVertexAttributeDescriptions    = state.attributeDescriptions.data()                             // List of vertex attribute descriptions (data format and where to bind to from)
         };
 
     /* ----------------------------------------- Input Assembly ----------------------------------------- */
 
-    VkPipelineInputAssemblyStateCreateInfo inputAssemblyInfo =
+    state.inputAssemblyInfo =
         {
             .sType                  = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO,
             .topology               = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST, // Primitive type to assemble vertices as
@@ -77,7 +259,7 @@ voPipeline::Create( voDeviceContext * device, const CreateParms_t & parms )
 
     /* ----------------------------------------- Viewport & Scissor ----------------------------------------- */
 
-    VkViewport viewport =
+    state.viewport =
         {
             .x = 0.0F, // x start coordinate
             .y = 0.0F, // y start coordinate
@@ -89,19 +271,19 @@ voPipeline::Create( voDeviceContext * device, const CreateParms_t & parms )
             .maxDepth = 1.0F  // Max depth of the framebuffer
         };
 
-    VkRect2D scissor =
+    state.scissor =
         {
             .offset = {              0,                0}, // Offset to use region from
             .extent = {(uint32_t)width, (uint32_t)height}, // Extent to describre region to use, starting at offset
     };
 
-    VkPipelineViewportStateCreateInfo viewportStateInfo =
+    state.viewportStateInfo =
         {
             .sType         = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO,
             .viewportCount = 1,         // Number of viewports to use
-            .pViewports    = &viewport, // List of viewports to use
+            .pViewports    = &state.viewport, // List of viewports to use
             .scissorCount  = 1,         // Number of scissor rectangles to use
-            .pScissors     = &scissor   // List of scissor rectangles to use
+            .pScissors     = &state.scissor   // List of scissor rectangles to use
         };
 
     /* ----------------------------------------- Dynamic States ----------------------------------------- */
@@ -109,54 +291,59 @@ voPipeline::Create( voDeviceContext * device, const CreateParms_t & parms )
     // Dynamic states to enable
     // WARNING: If you are resizing the window, you need to recreate the swap chain,
     // 			 swap chain images, and any image views associated with output attachments to the swap chain
-    std::array< VkDynamicState, 3 > dynamicStates =
+    state.dynamicStates =
         {
             VK_DYNAMIC_STATE_VIEWPORT,
             VK_DYNAMIC_STATE_SCISSOR,
             VK_DYNAMIC_STATE_DEPTH_BIAS };
 
+    // Set when recording, see voPipeline::SetRenderState
+    if( dynamicState )
+        {
+            state.dynamicStates.insert( state.dynamicStates.end(),
+                                        {
+                                            VK_DYNAMIC_STATE_CULL_MODE,
+                                            VK_DYNAMIC_STATE_FRONT_FACE,
+                                            VK_DYNAMIC_STATE_PRIMITIVE_TOPOLOGY,
+                                            VK_DYNAMIC_STATE_DEPTH_TEST_ENABLE,
+                                            VK_DYNAMIC_STATE_DEPTH_WRITE_ENABLE,
+                                            VK_DYNAMIC_STATE_DEPTH_COMPARE_OP,
+                                        } );
+        }
+    if( dynamicState2 )
+        {
+            state.dynamicStates.push_back( VK_DYNAMIC_STATE_DEPTH_BIAS_ENABLE );
+        }
+
     // Dynamic state creation information
-    VkPipelineDynamicStateCreateInfo dynamicStateInfo =
+    state.dynamicStateInfo =
         {
             .sType             = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO,
-            .dynamicStateCount = static_cast< uint32_t >( dynamicStates.size() ), // Number of dynamic states to enable
-            .pDynamicStates    = dynamicStates.data()                             // List of dynamic states to enable
+            .dynamicStateCount = static_cast< uint32_t >( state.dynamicStates.size() ), // Number of dynamic states to enable
+            .pDynamicStates    = state.dynamicStates.data()                             // List of dynamic states to enable
         };
 
     /* ----------------------------------------- Rasterizer ----------------------------------------- */
 
     // How to draw the polygons
-    VkPipelineRasterizationStateCreateInfo rasterizerInfo =
+    state.rasterizerInfo =
         {
             .sType                   = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO,
             .depthClampEnable        = VK_FALSE,                        // Change if fragments beyond near/far planes are clamped (default) or discarded
             .rasterizerDiscardEnable = VK_FALSE,                        // Whether to discard data and skip rasterizer. Never creates fragments, only suitable for pipeline without framebuffer output
             .polygonMode             = VK_POLYGON_MODE_FILL,            // How to handle filling points between vertices
             .frontFace               = VK_FRONT_FACE_COUNTER_CLOCKWISE, // Winding to determine which side is front
-            .depthBiasEnable         = VK_FALSE,                        // Whether to add depth bias to fragments (good for stopping "shadow acne" in shadow mapping)
+            .depthBiasEnable         = parms.depthBias ? VK_TRUE : VK_FALSE, // Whether to add depth bias to fragments (good for stopping "shadow acne" in shadow mapping)
             .lineWidth               = 1.0F,                            // How thick lines should be when drawn
         };
 
     // Determine the culling face mode
-    switch( parms.cullMode )
-        {
-            case CULL_MODE_FRONT:
-                rasterizerInfo.cullMode = VK_CULL_MODE_FRONT_BIT;
-                break;
-
-            case CULL_MODE_BACK:
-                rasterizerInfo.cullMode = VK_CULL_MODE_BACK_BIT;
-                break;
-
-            default:
-                rasterizerInfo.cullMode = VK_CULL_MODE_NONE;
-                break;
-        }
+    state.rasterizerInfo.cullMode = GetCullModeFlags( parms.cullMode );
 
     /* ----------------------------------------- Multisampling ----------------------------------------- */
 
     // How to handle multisampling
-    VkPipelineMultisampleStateCreateInfo multisamplingInfo =
+    state.multisamplingInfo =
         {
             .sType                = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO,
             .rasterizationSamples = VK_SAMPLE_COUNT_1_BIT, // Number of samples to use per fragment
@@ -166,7 +353,7 @@ voPipeline::Create( voDeviceContext * device, const CreateParms_t & parms )
     /* ----------------------------------------- Depth Stencil ----------------------------------------- */
 
     // Depth and stencil testing
-    VkPipelineDepthStencilStateCreateInfo depthStencilInfo =
+    state.depthStencilInfo =
         {
             .sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO,
 
@@ -200,7 +387,7 @@ voPipeline::Create( voDeviceContext * device, const CreateParms_t & parms )
     /* ----------------------------------------- Color Blending ----------------------------------------- */
 
     // How to handle the colours
-    VkPipelineColorBlendAttachmentState colorBlendAttachment =
+    state.colorBlendAttachment =
         {
             .blendEnable = VK_TRUE, // Enable blending
 
@@ -228,7 +415,7 @@ voPipeline::Create( voDeviceContext * device, const CreateParms_t & parms )
      */
 
     // How to handle all the colours and alpha
-    VkPipelineColorBlendStateCreateInfo colorBlendingInfo =
+    state.colorBlendingInfo =
         {
             .sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO,
 
@@ -236,67 +423,30 @@ voPipeline::Create( voDeviceContext * device, const CreateParms_t & parms )
             .logicOp       = VK_LOGIC_OP_COPY, // What logical operation to use
 
             .attachmentCount = 1, // Number of colour blend attachments
-            .pAttachments    = &colorBlendAttachment, // Information about how to handle blending
+            .pAttachments    = &state.colorBlendAttachment, // Information about how to handle blending
 
             .blendConstants = { 0.0F, 0.0F, 0.0F, 0.0F }  // (Optional) Constants to use for blending [VK_BLEND_FACTOR_CONSTANT_COLOR]
     };
 
-    /* ----------------------------------------- Pipeline Layout ----------------------------------------- */
-
-    VkPipelineLayoutCreateInfo pipelineLayoutInfo {
-        .sType          = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
-        .setLayoutCount = 0,
-        .pSetLayouts    = VK_NULL_HANDLE,
-    };
-
-    // Check if descriptors are present and have bindings
-    if( parms.descriptors && parms.descriptors->vkDescriptorSetLayout != VK_NULL_HANDLE )
-        {
-            // Update pipeline layout info
-            pipelineLayoutInfo.setLayoutCount = 1;
-            pipelineLayoutInfo.pSetLayouts    = &parms.descriptors->vkDescriptorSetLayout;
-        }
-
-    /* ----------------------------------------- Push constants ----------------------------------------- */
-
-    // Check for push constants
-    if( parms.pushConstantSize > 0 )
-        {
-            // Define push constant values (no 'create' needed)
-            VkPushConstantRange pushConstantRange =
-                {
-                    .stageFlags = parms.pushConstantShaderStages, // Shader stage push constant will go to
-                    .offset     = 0,                              // Offset into given data to pass to push constant
-                    .size       = parms.pushConstantSize,         // Size of data being passed
-                };
-
-            // Set push constant to layout
-            pipelineLayoutInfo.pushConstantRangeCount = 1;                  // Number of push constant ranges
-            pipelineLayoutInfo.pPushConstantRanges    = &pushConstantRange; // Pointer to array of push constant ranges
-        }
-
-    VK_CHECK( vkCreatePipelineLayout( device->deviceInfo.logical, &pipelineLayoutInfo, VK_NULL_HANDLE, &vkPipelineLayout ),
-              "Failed to create pipeline layout" );
-
     /* ----------------------------------------- Create Pipeline ----------------------------------------- */
 
-    VkGraphicsPipelineCreateInfo pipelineInfo =
+    state.pipelineInfo =
         {
             .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
 
             // Shader stages
-            .stageCount = static_cast< uint32_t >( shaderStages.size() ),
-            .pStages    = shaderStages.data(),
+            .stageCount = static_cast< uint32_t >( state.shaderStages.size() ),
+            .pStages    = state.shaderStages.data(),
 
             // States creation
-            .pVertexInputState   = &vertexInputInfo,
-            .pInputAssemblyState = &inputAssemblyInfo,
-            .pViewportState      = &viewportStateInfo,
-            .pRasterizationState = &rasterizerInfo,
-            .pMultisampleState   = &multisamplingInfo,
-            .pDepthStencilState  = &depthStencilInfo,
-            .pColorBlendState    = &colorBlendingInfo,
-            .pDynamicState       = &dynamicStateInfo,
+            .pVertexInputState   = &state.vertexInputInfo,
+            .pInputAssemblyState = &state.inputAssemblyInfo,
+            .pViewportState      = &state.viewportStateInfo,
+            .pRasterizationState = &state.rasterizerInfo,
+            .pMultisampleState   = &state.multisamplingInfo,
+            .pDepthStencilState  = &state.depthStencilInfo,
+            .pColorBlendState    = &state.colorBlendingInfo,
+            .pDynamicState       = &state.dynamicStateInfo,
 
             // Layout setup
             .layout     = vkPipelineLayout,
@@ -311,28 +461,39 @@ voPipeline::Create( voDeviceContext * device, const CreateParms_t & parms )
     // Attach a valid render pass
     if( parms.framebuffer != nullptr )
         {
-            pipelineInfo.renderPass = parms.framebuffer->vkRenderPass;
+            state.pipelineInfo.renderPass = parms.framebuffer->vkRenderPass;
         }
 
-    // used to store and reuse previously created pipelines, reducing the cost of pipeline creation
-    VkPipelineCache pipelineCache = VK_NULL_HANDLE;
-
-    VK_CHECK( vkCreateGraphicsPipelines( device->deviceInfo.logical, pipelineCache, 1, &pipelineInfo, VK_NULL_HANDLE, &vkPipeline ),
-              "Failed to create pipeline" );
+    /* ----------------------------------------- Pipeline Key ----------------------------------------- */
 
-    return true;
-}
+    // Everything the pipeline is built from, the viewport and scissor being dynamic
+    voPipelineRegistry::key_t & key = state.key;
+    key.push_back( VK_PIPELINE_BIND_POINT_GRAPHICS );
+    AddShaderKey( key, parms.shader );
 
-bool
-voPipeline::CreateCompute( voDeviceContext * device, const CreateParms_t & parms )
-{
-    if( vkPipeline != VK_NULL_HANDLE )
+    key.insert( key.end(), { state.bindingDescription.stride, state.bindingDescription.inputRate } );
+    for( const VkVertexInputAttributeDescription & attribute : state.attributeDescriptions )
         {
-            Cleanup( device );
+            key.insert( key.end(), { attribute.location, attribute.format, attribute.offset } );
         }
 
-    m_parms = parms;
+    key.insert( key.end(), { state.inputAssemblyInfo.topology, state.rasterizerInfo.polygonMode, state.rasterizerInfo.cullMode, state.rasterizerInfo.frontFace,
+                             state.rasterizerInfo.depthBiasEnable, state.multisamplingInfo.rasterizationSamples, state.depthStencilInfo.depthTestEnable, state.depthStencilInfo.depthWriteEnable,
+                             state.depthStencilInfo.depthCompareOp, state.colorBlendAttachment.blendEnable, state.colorBlendAttachment.colorWriteMask } );
 
+    key.insert( key.end(), state.dynamicStates.begin(), state.dynamicStates.end() );
+
+    // Compatible render passes created apart are told apart, the push constant ranges are part of the layout
+    key.insert( key.end(), { reinterpret_cast< uint64_t >( state.pipelineInfo.renderPass ), state.pipelineInfo.subpass,
+                             reinterpret_cast< uint64_t >( vkPipelineLayout ) } );
+}
+
+/**
+ * Fills the create info of a compute pipeline, and its key.
+ */
+static void
+BuildComputeState( const voPipeline::CreateParms_t & parms, VkPipelineLayout vkPipelineLayout, compute_state_t & state )
+{
     /* ----------------------------------------- Shader Stages Creation ----------------------------------------- */
 
     VkPipelineShaderStageCreateInfo shaderStageInfo =
@@ -343,45 +504,513 @@ voPipeline::CreateCompute( voDeviceContext * device, const CreateParms_t & parms
             .pName  = SHADER_ENTRY_POINT,
         };
 
-    /* ----------------------------------------- Pipeline Layout ----------------------------------------- */
+    /* ----------------------------------------- Create Compute Pipeline ----------------------------------------- */
 
-    VkPipelineLayoutCreateInfo pipelineLayoutInfo =
+    state.pipelineInfo =
         {
-            .sType          = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
-            .setLayoutCount = 1,
-            .pSetLayouts    = &parms.descriptors->vkDescriptorSetLayout,
+            .sType              = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+            .stage              = shaderStageInfo,
+            .layout             = vkPipelineLayout,
+            .basePipelineHandle = VK_NULL_HANDLE,
         };
 
-    /* ----------------------------------------- Push constants ----------------------------------------- */
+    state.key.push_back( VK_PIPELINE_BIND_POINT_COMPUTE );
+    AddShaderKey( state.key, parms.shader );
+    state.key.push_back( reinterpret_cast< uint64_t >( vkPipelineLayout ) );
+}
 
-    if( parms.pushConstantSize > 0 )
+/**
+ * Compiles a graphics pipeline, the state is kept alive until the compile has run.
+ */
+static voPipelineRegistry::compile_t
+CompileGraphics( voDeviceContext * device, std::shared_ptr< graphics_state_t > state )
+{
+    return [device, state]()
+    {
+        // used to store and reuse previously created pipelines, reducing the cost of pipeline creation
+        VkPipelineCache pipelineCache = device->m_pipelineCache.vkPipelineCache;
+
+        VkPipeline pipeline { VK_NULL_HANDLE };
+        VK_CHECK( vkCreateGraphicsPipelines( device->deviceInfo.logical, pipelineCache, 1, &state->pipelineInfo, VK_NULL_HANDLE, &pipeline ),
+                  "Failed to create pipeline" );
+
+        return pipeline;
+    };
+}
+
+/**
+ * Compiles a compute pipeline.
+ */
+static voPipelineRegistry::compile_t
+CompileCompute( voDeviceContext * device, std::shared_ptr< compute_state_t > state )
+{
+    return [device, state]()
+    {
+        VkPipeline pipeline { VK_NULL_HANDLE };
+        VK_CHECK( vkCreateComputePipelines( device->deviceInfo.logical, device->m_pipelineCache.vkPipelineCache, 1, &state->pipelineInfo, VK_NULL_HANDLE, &pipeline ),
+                  "Failed to create pipeline" );
+
+        return pipeline;
+    };
+}
+
+/* ---- Graphics Pipeline Libraries ---- */
+
+/**
+ * Builds the keys of the parts of a graphics pipeline, from its state. The pipeline layout is shared by the shader parts.
+ */
+static void
+BuildLibraryKeys( const voShader * shader, graphics_state_t & state )
+{
+    const VkPipelineLayout vkPipelineLayout = state.pipelineInfo.layout;
+    const VkRenderPass     vkRenderPass     = state.pipelineInfo.renderPass;
+
+    for( uint32_t i = 0; i < LIBRARY_COUNT; i++ )
         {
-            VkPushConstantRange pushConstantRange =
-                {
-                    .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
-                    .offset     = 0,
-                    .size       = parms.pushConstantSize,
-                };
+            voPipelineRegistry::key_t & key = state.libraryKeys[i];
+            key.clear();
 
-            pipelineLayoutInfo.pushConstantRangeCount = 1;
-            pipelineLayoutInfo.pPushConstantRanges    = &pushConstantRange;
+            // Never taken for a bind point
+            key.insert( key.end(), { VK_PIPELINE_CREATE_LIBRARY_BIT_KHR, 1U << i } );
+            key.insert( key.end(), state.dynamicStates.begin(), state.dynamicStates.end() );
         }
 
-    VK_CHECK( vkCreatePipelineLayout( device->deviceInfo.logical, &pipelineLayoutInfo, VK_NULL_HANDLE, &vkPipelineLayout ),
-              "Failed to create pipeline layout" );
+    voPipelineRegistry::key_t & vertexInput = state.libraryKeys[LIBRARY_VERTEX_INPUT];
+    vertexInput.insert( vertexInput.end(), { state.bindingDescription.stride, state.bindingDescription.inputRate, state.inputAssemblyInfo.topology } );
+    for( const VkVertexInputAttributeDescription & attribute : state.attributeDescriptions )
+        {
+            vertexInput.insert( vertexInput.end(), { attribute.location, attribute.format, attribute.offset } );
+        }
 
-    /* ----------------------------------------- Create Compute Pipeline ----------------------------------------- */
+    voPipelineRegistry::key_t & preRasterization = state.libraryKeys[LIBRARY_PRE_RASTERIZATION];
+    AddShaderKey( preRasterization, shader, VK_SHADER_STAGE_ALL_GRAPHICS & ~VK_SHADER_STAGE_FRAGMENT_BIT );
+    preRasterization.insert( preRasterization.end(), { state.rasterizerInfo.polygonMode, state.rasterizerInfo.cullMode, state.rasterizerInfo.frontFace,
+                                                       state.rasterizerInfo.depthBiasEnable, reinterpret_cast< uint64_t >( vkRenderPass ),
+                                                       state.pipelineInfo.subpass, reinterpret_cast< uint64_t >( vkPipelineLayout ) } );
+
+    voPipelineRegistry::key_t & fragmentShader = state.libraryKeys[LIBRARY_FRAGMENT_SHADER];
+    AddShaderKey( fragmentShader, shader, VK_SHADER_STAGE_FRAGMENT_BIT );
+    fragmentShader.insert( fragmentShader.end(), { state.multisamplingInfo.rasterizationSamples, state.depthStencilInfo.depthTestEnable,
+                                                   state.depthStencilInfo.depthWriteEnable, state.depthStencilInfo.depthCompareOp,
+                                                   reinterpret_cast< uint64_t >( vkRenderPass ), state.pipelineInfo.subpass,
+                                                   reinterpret_cast< uint64_t >( vkPipelineLayout ) } );
+
+    voPipelineRegistry::key_t & fragmentOutput = state.libraryKeys[LIBRARY_FRAGMENT_OUTPUT];
+    fragmentOutput.insert( fragmentOutput.end(), { state.multisamplingInfo.rasterizationSamples, state.colorBlendAttachment.blendEnable,
+                                                   state.colorBlendAttachment.colorWriteMask, reinterpret_cast< uint64_t >( vkRenderPass ),
+                                                   state.pipelineInfo.subpass } );
+}
+
+/**
+ * Compiles a part of a graphics pipeline, from the state of the first pipeline needing it.
+ */
+static voPipelineRegistry::compile_t
+CompileLibrary( voDeviceContext * device, std::shared_ptr< graphics_state_t > state, library_t library )
+{
+    return [device, state, library]()
+    {
+        VkGraphicsPipelineLibraryCreateInfoEXT libraryInfo =
+            {
+                .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_LIBRARY_CREATE_INFO_EXT,
+                .flags = static_cast< VkGraphicsPipelineLibraryFlagsEXT >( 1U << library ),
+            };
+
+        // Parts are linked again with link time optimization once the pipeline is in use
+        VkGraphicsPipelineCreateInfo pipelineInfo =
+            {
+                .sType         = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+                .pNext         = &libraryInfo,
+                .flags         = VK_PIPELINE_CREATE_LIBRARY_BIT_KHR | VK_PIPELINE_CREATE_RETAIN_LINK_TIME_OPTIMIZATION_INFO_BIT_EXT,
+                .pDynamicState = &state->dynamicStateInfo, // Only the states of the part are read
+            };
+
+        std::vector< VkPipelineShaderStageCreateInfo > shaderStages {};
+        switch( library )
+            {
+                case LIBRARY_VERTEX_INPUT:
+                    pipelineInfo.pVertexInputState   = &state->vertexInputInfo;
+                    pipelineInfo.pInputAssemblyState = &state->inputAssemblyInfo;
+                    break;
+
+                case LIBRARY_PRE_RASTERIZATION:
+                    std::copy_if( state->shaderStages.begin(), state->shaderStages.end(), std::back_inserter( shaderStages ),
+                                  []( const VkPipelineShaderStageCreateInfo & stage ) { return stage.stage != VK_SHADER_STAGE_FRAGMENT_BIT; } );
+                    pipelineInfo.pViewportState      = &state->viewportStateInfo;
+                    pipelineInfo.pRasterizationState = &state->rasterizerInfo;
+                    pipelineInfo.layout              = state->pipelineInfo.layout;
+                    break;
+
+                case LIBRARY_FRAGMENT_SHADER:
+                    std::copy_if( state->shaderStages.begin(), state->shaderStages.end(), std::back_inserter( shaderStages ),
+                                  []( const VkPipelineShaderStageCreateInfo & stage ) { return stage.stage == VK_SHADER_STAGE_FRAGMENT_BIT; } );
+                    pipelineInfo.pMultisampleState  = &state->multisamplingInfo;
+                    pipelineInfo.pDepthStencilState = &state->depthStencilInfo;
+                    pipelineInfo.layout             = state->pipelineInfo.layout;
+                    break;
+
+                default:
+                    pipelineInfo.pMultisampleState = &state->multisamplingInfo;
+                    pipelineInfo.pColorBlendState  = &state->colorBlendingInfo;
+                    break;
+            }
+
+        pipelineInfo.stageCount = static_cast< uint32_t >( shaderStages.size() );
+        pipelineInfo.pStages    = shaderStages.data();
+
+        // Every part but the vertex input is compiled against the render pass
+        if( library != LIBRARY_VERTEX_INPUT )
+            {
+                pipelineInfo.renderPass = state->pipelineInfo.renderPass;
+                pipelineInfo.subpass    = state->pipelineInfo.subpass;
+            }
+
+        VkPipeline pipeline { VK_NULL_HANDLE };
+        VK_CHECK( vkCreateGraphicsPipelines( device->deviceInfo.logical, device->m_pipelineCache.vkPipelineCache, 1, &pipelineInfo, VK_NULL_HANDLE, &pipeline ),
+                  "Failed to create pipeline library" );
+
+        return pipeline;
+    };
+}
 
-    VkComputePipelineCreateInfo pipelineInfo =
+/**
+ * Links the compiled parts of a graphics pipeline, they stay in the registry until it is cleaned up.
+ */
+static VkPipeline
+LinkLibraries( voDeviceContext * device, const graphics_state_t & state, VkPipelineCreateFlags flags )
+{
+    std::array< VkPipeline, LIBRARY_COUNT > libraries {};
+    for( uint32_t i = 0; i < LIBRARY_COUNT; i++ )
         {
-            .sType              = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
-            .stage              = shaderStageInfo,
-            .layout             = vkPipelineLayout,
-            .basePipelineHandle = VK_NULL_HANDLE,
+            libraries[i] = device->m_pipelineRegistry.Get( state.libraryKeys[i] );
+        }
+
+    VkPipelineLibraryCreateInfoKHR linkInfo =
+        {
+            .sType        = VK_STRUCTURE_TYPE_PIPELINE_LIBRARY_CREATE_INFO_KHR,
+            .libraryCount = LIBRARY_COUNT,
+            .pLibraries   = libraries.data(),
+        };
+
+    VkGraphicsPipelineCreateInfo pipelineInfo =
+        {
+            .sType  = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+            .pNext  = &linkInfo,
+            .flags  = flags,
+            .layout = state.pipelineInfo.layout,
         };
 
-    VK_CHECK( vkCreateComputePipelines( device->deviceInfo.logical, VK_NULL_HANDLE, 1, &pipelineInfo, VK_NULL_HANDLE, &vkPipeline ),
-              "Failed to create pipeline" );
+    VkPipeline pipeline { VK_NULL_HANDLE };
+    VK_CHECK( vkCreateGraphicsPipelines( device->deviceInfo.logical, device->m_pipelineCache.vkPipelineCache, 1, &pipelineInfo, VK_NULL_HANDLE, &pipeline ),
+              "Failed to link pipeline libraries" );
+
+    return pipeline;
+}
+
+/**
+ * Compiles the parts of a graphics pipeline not in the registry yet, in parallel.
+ * Returns the jobs the link depends on, the parts still compiling.
+ */
+static std::vector< voJobSystem::handle_t >
+PrepareLibraries( voDeviceContext * device, std::shared_ptr< graphics_state_t > state )
+{
+    // Parts are shared with every pipeline having the same state for them
+    std::vector< voJobSystem::handle_t > compiles( LIBRARY_COUNT );
+    for( uint32_t i = 0; i < LIBRARY_COUNT; i++ )
+        {
+            compiles[i] = device->m_pipelineRegistry.Prepare( device, state->libraryKeys[i], CompileLibrary( device, state, static_cast< library_t >( i ) ) );
+        }
+
+    return compiles;
+}
+
+/**
+ * Links a graphics pipeline without optimization, once its parts are compiled.
+ */
+static voPipelineRegistry::compile_t
+LinkGraphics( voDeviceContext * device, std::shared_ptr< graphics_state_t > state )
+{
+    return [device, state]()
+    {
+        return LinkLibraries( device, *state, 0 );
+    };
+}
+
+/**
+ * Links the parts of a graphics pipeline again with link time optimization, replacing the quickly linked pipeline.
+ */
+static voPipelineRegistry::compile_t
+OptimizeGraphics( voDeviceContext * device, std::shared_ptr< graphics_state_t > state )
+{
+    return [device, state]()
+    {
+        return LinkLibraries( device, *state, VK_PIPELINE_CREATE_LINK_TIME_OPTIMIZATION_BIT_EXT );
+    };
+}
+
+/* ---- Warm-up Manifest ---- */
+
+/**
+ * Records the recipe of a pipeline in the warm-up manifest, for the pipelines rebuilt from plain data:
+ * a named shader, the descriptors set layout and the swapchain render pass for graphics pipelines.
+ */
+static void
+RecordRecipe( voDeviceContext * device, const voPipeline::CreateParms_t & parms, VkPipelineBindPoint bindPoint, VkShaderStageFlags pushConstantStages )
+{
+    if( parms.shader == nullptr || parms.shader->name.empty() || parms.bindless != nullptr )
+        {
+            return;
+        }
+
+    if( bindPoint == VK_PIPELINE_BIND_POINT_GRAPHICS && ( parms.framebuffer != nullptr || parms.renderPass != device->swapChain.GetRenderPass() ) )
+        {
+            return;
+        }
+
+    const voDescriptors * descriptors = parms.descriptors;
+    const bool            hasSet      = GetSetLayout( parms ) != VK_NULL_HANDLE;
+
+    std::string recipe = fmt::format( "{} {} {} {} {} {} {} {} {} {} {} {}", static_cast< uint32_t >( bindPoint ), parms.shader->name,
+                                      static_cast< uint32_t >( parms.cullMode ), static_cast< uint32_t >( parms.depthTest ),
+                                      static_cast< uint32_t >( parms.depthWrite ), static_cast< uint32_t >( parms.depthBias ),
+                                      static_cast< uint32_t >( parms.dynamicState ), parms.pushConstantSize, pushConstantStages, hasSet ? 1 : 0,
+                                      hasSet ? descriptors->GetLayoutFlags() : 0, hasSet ? descriptors->GetLayoutBindings().size() : 0 );
+
+    if( hasSet )
+        {
+            for( const VkDescriptorSetLayoutBinding & binding : descriptors->GetLayoutBindings() )
+                {
+                    recipe += fmt::format( " {} {} {} {}", binding.binding, static_cast< uint32_t >( binding.descriptorType ),
+                                           binding.descriptorCount, binding.stageFlags );
+                }
+        }
+
+    device->m_pipelineRegistry.Record( recipe );
+}
+
+/**
+ * Reads a line of the warm-up manifest, as written by `RecordRecipe`.
+ */
+static bool
+ParseRecipe( const std::string & line, recipe_t & recipe )
+{
+    std::istringstream stream( line );
+
+    uint32_t bindPoint, cullMode, depthTest, depthWrite, depthBias, dynamicState, pushConstantStages, hasSetLayout, numBindings;
+    stream >> bindPoint >> recipe.shader >> cullMode >> depthTest >> depthWrite >> depthBias >> dynamicState >> recipe.parms.pushConstantSize >>
+        pushConstantStages >> hasSetLayout >> recipe.setLayoutFlags >> numBindings;
+
+    if( !stream || bindPoint > VK_PIPELINE_BIND_POINT_COMPUTE || cullMode > voPipeline::CULL_MODE_NONE )
+        {
+            return false;
+        }
+
+    recipe.bindPoint                      = static_cast< VkPipelineBindPoint >( bindPoint );
+    recipe.parms.cullMode                 = static_cast< voPipeline::CullMode_t >( cullMode );
+    recipe.parms.depthTest                = depthTest != 0;
+    recipe.parms.depthWrite               = depthWrite != 0;
+    recipe.parms.depthBias                = depthBias != 0;
+    recipe.parms.dynamicState             = dynamicState != 0;
+    recipe.parms.pushConstantShaderStages = static_cast< VkShaderStageFlagBits >( pushConstantStages );
+    recipe.hasSetLayout                   = hasSetLayout != 0;
+
+    recipe.setLayoutBindings.resize( numBindings );
+    for( VkDescriptorSetLayoutBinding & binding : recipe.setLayoutBindings )
+        {
+            uint32_t type;
+            stream >> binding.binding >> type >> binding.descriptorCount >> binding.stageFlags;
+            binding.descriptorType = static_cast< VkDescriptorType >( type );
+        }
+
+    return static_cast< bool >( stream );
+}
+
+/* ---- voPipeline ---- */
+
+bool
+voPipeline::Create( voDeviceContext * device, const CreateParms_t & parms )
+{
+    if( !m_key.empty() )
+        {
+            Cleanup( device );
+        }
+
+    m_device       = device;
+    m_parms        = parms;
+    m_dynamicState = parms.dynamicState && device->enabledFeatures.extendedDynamicState;
+    vkBindPoint    = VK_PIPELINE_BIND_POINT_GRAPHICS;
+
+    // A fallback with baked states would be drawn with them instead of the states of this pipeline
+    voAssert( !m_dynamicState || parms.fallback == nullptr || parms.fallback->HasDynamicState() );
+
+    /* ----------------------------------------- Pipeline Layout ----------------------------------------- */
+
+    // Shared with the pipelines having the same sets and push constants, they are compatible for every set
+    vkPipelineLayout = GetPipelineLayout( device, parms, GetSetLayout( parms ), parms.pushConstantShaderStages );
+
+    /* ----------------------------------------- Compile ----------------------------------------- */
+
+    auto state = std::make_shared< graphics_state_t >();
+    BuildGraphicsState( parms, vkPipelineLayout, m_dynamicState, m_dynamicState && device->enabledFeatures.extendedDynamicState2, *state );
+
+    m_key = state->key;
+    if( device->enabledFeatures.graphicsPipelineLibrary )
+        {
+            // Linked from the cached parts at first use, the optimized pipeline replaces it once linked in the background
+            BuildLibraryKeys( parms.shader, *state );
+
+            // The link job starts once the parts are compiled, known pipelines need none
+            std::vector< voJobSystem::handle_t > parts;
+            if( !device->m_pipelineRegistry.Contains( m_key ) )
+                {
+                    parts = PrepareLibraries( device, state );
+                }
+
+            Acquire( device, LinkGraphics( device, state ), OptimizeGraphics( device, state ), parts );
+        }
+    else
+        {
+            Acquire( device, CompileGraphics( device, state ) );
+        }
+
+    RecordRecipe( device, parms, vkBindPoint, parms.pushConstantShaderStages );
+
+    return true;
+}
+
+bool
+voPipeline::CreateCompute( voDeviceContext * device, const CreateParms_t & parms )
+{
+    if( !m_key.empty() )
+        {
+            Cleanup( device );
+        }
+
+    m_device       = device;
+    m_parms        = parms;
+    m_dynamicState = false;
+    vkBindPoint    = VK_PIPELINE_BIND_POINT_COMPUTE;
+
+    /* ----------------------------------------- Pipeline Layout ----------------------------------------- */
+
+    vkPipelineLayout = GetPipelineLayout( device, parms, GetSetLayout( parms ), VK_SHADER_STAGE_COMPUTE_BIT );
+
+    /* ----------------------------------------- Compile ----------------------------------------- */
+
+    auto state = std::make_shared< compute_state_t >();
+    BuildComputeState( parms, vkPipelineLayout, *state );
+
+    m_key = state->key;
+    Acquire( device, CompileCompute( device, state ) );
+
+    RecordRecipe( device, parms, vkBindPoint, VK_SHADER_STAGE_COMPUTE_BIT );
 
     return true;
 }
+
+void
+voPipeline::WarmUp( voDeviceContext * device )
+{
+    const std::vector< std::string > & manifest = device->m_pipelineRegistry.GetManifest();
+    if( manifest.empty() )
+        {
+            return;
+        }
+
+    // Shaders are loaded once, and only kept until the compiles using them have run
+    auto shaders = std::make_shared< std::map< std::string, voShader > >();
+
+    std::vector< voJobSystem::handle_t > compiles {};
+    for( const std::string & line : manifest )
+        {
+            recipe_t recipe {};
+            if( !ParseRecipe( line, recipe ) )
+                {
+                    spdlog::warn( "Invalid pipeline manifest entry: {}", line );
+                    continue;
+                }
+
+            voShader & shader = ( *shaders )[recipe.shader];
+            if( shader.modules.empty() && ( !shader.Load( device, recipe.shader.c_str() ) || shader.modules.empty() ) )
+                {
+                    spdlog::warn( "Pipeline manifest shader {} not found", recipe.shader );
+                    continue;
+                }
+
+            recipe.parms.shader     = &shader;
+            recipe.parms.renderPass = device->swapChain.GetRenderPass();
+
+            // Same bindings and flags as the descriptors, so the same layouts and keys as the pipelines of the previous run
+            const VkDescriptorSetLayout setLayout = recipe.hasSetLayout ? device->m_layoutCache.GetSetLayout( device, recipe.setLayoutBindings, recipe.setLayoutFlags ) : VK_NULL_HANDLE;
+            const VkPipelineLayout      layout    = GetPipelineLayout( device, recipe.parms, setLayout, recipe.parms.pushConstantShaderStages );
+
+            if( recipe.bindPoint == VK_PIPELINE_BIND_POINT_COMPUTE )
+                {
+                    auto state = std::make_shared< compute_state_t >();
+                    BuildComputeState( recipe.parms, layout, *state );
+                    compiles.push_back( device->m_pipelineRegistry.Prepare( device, state->key, CompileCompute( device, state ) ) );
+                }
+            else
+                {
+                    const bool dynamicState = recipe.parms.dynamicState && device->enabledFeatures.extendedDynamicState;
+
+                    auto state = std::make_shared< graphics_state_t >();
+                    BuildGraphicsState( recipe.parms, layout, dynamicState, dynamicState && device->enabledFeatures.extendedDynamicState2, *state );
+                    compiles.push_back( device->m_pipelineRegistry.Prepare( device, state->key, CompileGraphics( device, state ) ) );
+                }
+        }
+
+    device->m_jobSystem.Schedule( [device, shaders]()
+                                  {
+                                      for( auto & [name, shader] : *shaders )
+                                          {
+                                              shader.Cleanup( device );
+                                          }
+                                  },
+                                  compiles );
+
+    spdlog::info( "Warming up {} pipelines", manifest.size() );
+}
+
+void
+voPipeline::SetRenderState( VkCommandBuffer cmdBuffer, const render_state_t & state ) const
+{
+    voAssert( m_dynamicState && "Pipeline created without dynamic state" );
+
+    function_set_t::vkCmdSetCullModeEXT( cmdBuffer, GetCullModeFlags( state.cullMode ) );
+    function_set_t::vkCmdSetFrontFaceEXT( cmdBuffer, state.frontFace );
+    function_set_t::vkCmdSetPrimitiveTopologyEXT( cmdBuffer, state.topology );
+    function_set_t::vkCmdSetDepthTestEnableEXT( cmdBuffer, state.depthTest ? VK_TRUE : VK_FALSE );
+    function_set_t::vkCmdSetDepthWriteEnableEXT( cmdBuffer, state.depthWrite ? VK_TRUE : VK_FALSE );
+    function_set_t::vkCmdSetDepthCompareOpEXT( cmdBuffer, state.depthCompareOp );
+
+    // Part of the pipeline without the second extension
+    if( m_device->enabledFeatures.extendedDynamicState2 )
+        {
+            function_set_t::vkCmdSetDepthBiasEnableEXT( cmdBuffer, state.depthBias ? VK_TRUE : VK_FALSE );
+        }
+}
+
+void
+voPipeline::Acquire( voDeviceContext * device, const voPipelineRegistry::compile_t & compile, const voPipelineRegistry::compile_t & optimize,
+                     const std::vector< voJobSystem::handle_t > & dependencies )
+{
+    // Asynchronous pipelines are picked up by IsReady once compiled, and optimized pipelines once optimized
+    vkPipeline = device->m_pipelineRegistry.Acquire( device, m_key, compile, &m_compileJob, optimize, dependencies );
+
+    // The compile and the parts it links read the shader modules after Create returns
+    if( m_parms.async && vkPipeline == VK_NULL_HANDLE && m_parms.shader != nullptr )
+        {
+            m_parms.shader->AddCompile( m_compileJob );
+            for( const voJobSystem::handle_t & dependency : dependencies )
+                {
+                    m_parms.shader->AddCompile( dependency );
+                }
+        }
+
+    if( !m_parms.async && vkPipeline == VK_NULL_HANDLE )
+        {
+            // The calling thread helps with the jobs meanwhile
+            device->m_jobSystem.Wait( m_compileJob );
+            vkPipeline = device->m_pipelineRegistry.Get( m_key, &m_compileJob );
+        }
+}
@@ -0,0 +1,178 @@
+#include "vulkano/vo_pipelineCache.hpp"
+#include <vector>
+#include "vo_utilities.hpp"
+#include "vulkano/vo_deviceContext.hpp"
+
+bool
+voPipelineCache::Create( voDeviceContext * device, const CreateParms_t & parms )
+{
+    InitializeFileSystem();
+
+    m_fileName     = ( fs::path( g_ApplicationDirectory ) / parms.fileName ).string();
+    m_saveInterval = std::chrono::seconds( parms.saveInterval );
+    m_lastSave     = std::chrono::steady_clock::now();
+    m_savedSize    = 0;
+
+    /* ---------------------------------------- Load -------------------------------------------------------------------- */
+    std::vector< uint8_t > data {};
+    {
+        std::ifstream file( m_fileName, std::ios::binary | std::ios::ate );
+        if( file.is_open() )
+            {
+                data.resize( static_cast< size_t >( file.tellg() ) );
+                file.seekg( 0, std::ios::beg );
+
+                if( !file.read( reinterpret_cast< char * >( data.data() ), static_cast< std::streamsize >( data.size() ) ) )
+                    {
+                        spdlog::warn( "Unable to read pipeline cache: {}", m_fileName );
+                        data.clear();
+                    }
+            }
+    }
+
+    if( !data.empty() && !IsCompatible( device, data.data(), data.size() ) )
+        {
+            spdlog::info( "Pipeline cache {} was written for another device or driver, starting empty", m_fileName );
+            data.clear();
+        }
+
+    /* ---------------------------------------- Cache ------------------------------------------------------------------- */
+    VkPipelineCacheCreateInfo cacheInfo =
+        {
+            .sType           = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+            .initialDataSize = data.size(),
+            .pInitialData    = data.empty() ? nullptr : data.data(),
+        };
+
+    // The driver may still reject data it does not like, an empty cache is better than no cache
+    if( vkCreatePipelineCache( device->deviceInfo.logical, &cacheInfo, nullptr, &vkPipelineCache ) != VK_SUCCESS )
+        {
+            spdlog::warn( "Pipeline cache {} rejected by the driver, starting empty", m_fileName );
+
+            cacheInfo.initialDataSize = 0;
+            cacheInfo.pInitialData    = nullptr;
+            data.clear();
+
+            VK_CHECK( vkCreatePipelineCache( device->deviceInfo.logical, &cacheInfo, nullptr, &vkPipelineCache ),
+                      "Failed to create pipeline cache" );
+        }
+
+    m_savedSize = data.size();
+    if( !data.empty() )
+        {
+            spdlog::info( "Pipeline cache loaded: {} bytes", data.size() );
+        }
+
+    return true;
+}
+
+void
+voPipelineCache::Cleanup( voDeviceContext * device )
+{
+    if( vkPipelineCache == VK_NULL_HANDLE )
+        {
+            return;
+        }
+
+    Save( device );
+
+    vkDestroyPipelineCache( device->deviceInfo.logical, vkPipelineCache, nullptr );
+    vkPipelineCache = VK_NULL_HANDLE;
+    m_saveJob       = nullptr;
+}
+
+bool
+voPipelineCache::Save( voDeviceContext * device )
+{
+    std::lock_guard< std::mutex > lock( m_saveMutex );
+
+    // The cache may grow between the two calls, as pipelines keep being created
+    std::vector< uint8_t > data {};
+    VkResult               result;
+    do
+        {
+            size_t size = 0;
+            VK_CHECK( vkGetPipelineCacheData( device->deviceInfo.logical, vkPipelineCache, &size, nullptr ),
+                      "Failed to get pipeline cache size" );
+
+            data.resize( size );
+            result = vkGetPipelineCacheData( device->deviceInfo.logical, vkPipelineCache, &size, data.data() );
+            data.resize( size );
+        }
+    while( result == VK_INCOMPLETE );
+
+    if( result != VK_SUCCESS || data.size() == m_savedSize )
+        {
+            return result == VK_SUCCESS;
+        }
+
+    // Written aside then renamed over the previous file, which is either kept or replaced as a whole
+    const std::string tempName = m_fileName + ".tmp";
+    {
+        std::ofstream file( tempName, std::ios::binary | std::ios::trunc );
+        if( !file.write( reinterpret_cast< const char * >( data.data() ), static_cast< std::streamsize >( data.size() ) ) || !file.flush() )
+            {
+                spdlog::error( "Unable to write pipeline cache: {}", tempName );
+                return false;
+            }
+    }
+
+    std::error_code error;
+    fs::rename( tempName, m_fileName, error );
+    if( error )
+        {
+            spdlog::error( "Unable to replace pipeline cache {}: {}", m_fileName, error.message() );
+            fs::remove( tempName, error );
+            return false;
+        }
+
+    spdlog::info( "Pipeline cache saved: {} bytes", data.size() );
+    m_savedSize = data.size();
+
+    return true;
+}
+
+void
+voPipelineCache::Update( voDeviceContext * device )
+{
+    if( m_saveInterval.count() == 0 || !voJobSystem::IsComplete( m_saveJob ) )
+        {
+            return;
+        }
+
+    const auto now = std::chrono::steady_clock::now();
+    if( now - m_lastSave < m_saveInterval )
+        {
+            return;
+        }
+    m_lastSave = now;
+
+    // Nothing compiled since the last save
+    size_t size = 0;
+    if( vkGetPipelineCacheData( device->deviceInfo.logical, vkPipelineCache, &size, nullptr ) != VK_SUCCESS || size == m_savedSize )
+        {
+            return;
+        }
+
+    // Off the frame, the cache is internally synchronized with the pipelines being created
+    m_saveJob = device->m_jobSystem.Schedule( [this, device]() { Save( device ); } );
+}
+
+bool
+voPipelineCache::IsCompatible( voDeviceContext * device, const uint8_t * data, size_t size )
+{
+    VkPipelineCacheHeaderVersionOne header {};
+    if( size < sizeof( header ) )
+        {
+            return false;
+        }
+    memcpy( &header, data, sizeof( header ) );
+
+    const VkPhysicalDeviceProperties & properties = device->GetPhysicalProperties()->deviceProperties;
+
+    return header.headerSize >= sizeof( header ) && header.headerSize <= size &&
+           header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+           header.vendorID == properties.vendorID &&
+           header.deviceID == properties.deviceID &&
+           memcmp( header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE ) == 0;
+}
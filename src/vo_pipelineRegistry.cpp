@@ -0,0 +1,281 @@
+#include "vulkano/vo_pipelineRegistry.hpp"
+#include "vo_utilities.hpp"
+#include "vulkano/vo_deviceContext.hpp"
+
+bool
+voPipelineRegistry::Create( voDeviceContext *, const CreateParms_t & parms )
+{
+    InitializeFileSystem();
+
+    m_manifestFileName = ( fs::path( g_ApplicationDirectory ) / parms.manifestFileName ).string();
+    m_manifest.clear();
+    m_recipes.clear();
+
+    std::ifstream file( m_manifestFileName );
+    for( std::string line; std::getline( file, line ); )
+        {
+            if( !line.empty() )
+                {
+                    m_manifest.push_back( line );
+                }
+        }
+
+    if( !m_manifest.empty() )
+        {
+            spdlog::info( "Pipeline manifest loaded: {} pipelines to warm up", m_manifest.size() );
+        }
+
+    return true;
+}
+
+void
+voPipelineRegistry::Cleanup( voDeviceContext * device )
+{
+    std::lock_guard< std::mutex > lock( m_mutex );
+
+    /* ---------------------------------------- Manifest ---------------------------------------------------------------- */
+    if( !m_recipes.empty() )
+        {
+            // Written aside then renamed over the previous file, like the pipeline cache
+            const std::string tempName = m_manifestFileName + ".tmp";
+            bool              written  = false;
+            {
+                std::ofstream file( tempName, std::ios::trunc );
+                for( const std::string & recipe : m_recipes )
+                    {
+                        file << recipe << '\n';
+                    }
+
+                file.flush();
+                written = file.good();
+            }
+
+            // A partial file never replaces the manifest of the previous run
+            std::error_code error;
+            if( !written )
+                {
+                    spdlog::warn( "Unable to write pipeline manifest {}", tempName );
+                    fs::remove( tempName, error );
+                }
+            else
+                {
+                    fs::rename( tempName, m_manifestFileName, error );
+                    if( error )
+                        {
+                            spdlog::warn( "Unable to save pipeline manifest {}: {}", m_manifestFileName, error.message() );
+                        }
+                }
+        }
+
+    /* ---------------------------------------- Pipelines --------------------------------------------------------------- */
+    if( m_stats.hits + m_stats.compiles > 0 )
+        {
+            spdlog::info( "Pipeline registry: {} compiles, {} hits, {:.1f}% hit rate", m_stats.compiles, m_stats.hits, m_stats.GetHitRate() * 100.0 );
+        }
+
+    uint32_t numLeaked = 0;
+    for( const auto & [key, entry] : m_pipelines )
+        {
+            voAssert( voJobSystem::IsComplete( entry.job ) && "Pipeline still compiling" );
+
+            numLeaked += entry.refCount > 0 ? 1 : 0;
+            vkDestroyPipeline( device->deviceInfo.logical, entry.vkPipeline, nullptr );
+        }
+
+    if( numLeaked > 0 )
+        {
+            spdlog::warn( "Pipeline registry: {} pipelines were never released", numLeaked );
+        }
+
+    m_pipelines.clear();
+    m_manifest.clear();
+    m_recipes.clear();
+    m_stats = {};
+}
+
+VkPipeline
+voPipelineRegistry::Acquire( voDeviceContext * device, const key_t & key, const compile_t & compile, voJobSystem::handle_t * job,
+                             const compile_t & optimize, const std::vector< voJobSystem::handle_t > & dependencies )
+{
+    voJobSystem::handle_t compileJob;
+    {
+        std::lock_guard< std::mutex > lock( m_mutex );
+
+        auto [entry, inserted] = m_pipelines.try_emplace( key );
+        if( inserted )
+            {
+                entry->second.job = Compile( device, key, compile, optimize, dependencies );
+                m_stats.compiles++;
+            }
+        else
+            {
+                m_stats.hits++;
+            }
+
+        entry->second.refCount++;
+        entry->second.resident = false;
+
+        if( entry->second.vkPipeline != VK_NULL_HANDLE )
+            {
+                if( job != nullptr )
+                    {
+                        *job = entry->second.optimizing ? entry->second.job : nullptr;
+                    }
+                return entry->second.vkPipeline;
+            }
+
+        compileJob = entry->second.job;
+    }
+
+    if( job != nullptr )
+        {
+            *job = compileJob;
+            return VK_NULL_HANDLE;
+        }
+
+    // The calling thread helps with the jobs meanwhile, the reference keeps the entry alive
+    device->m_jobSystem.Wait( compileJob );
+
+    return Get( key );
+}
+
+voJobSystem::handle_t
+voPipelineRegistry::Prepare( voDeviceContext * device, const key_t & key, const compile_t & compile )
+{
+    std::lock_guard< std::mutex > lock( m_mutex );
+
+    // Known pipelines may still be compiling, the job is a dependency of the caller
+    auto [entry, inserted] = m_pipelines.try_emplace( key );
+    if( !inserted )
+        {
+            return entry->second.vkPipeline == VK_NULL_HANDLE ? entry->second.job : nullptr;
+        }
+
+    entry->second.resident = true;
+    entry->second.job      = Compile( device, key, compile );
+    m_stats.compiles++;
+
+    return entry->second.job;
+}
+
+VkPipeline
+voPipelineRegistry::Get( const key_t & key, voJobSystem::handle_t * job ) const
+{
+    std::lock_guard< std::mutex > lock( m_mutex );
+
+    auto entry = m_pipelines.find( key );
+    if( entry == m_pipelines.end() )
+        {
+            return VK_NULL_HANDLE;
+        }
+
+    // Until the pipeline is compiled, then while it is optimized
+    if( job != nullptr )
+        {
+            *job = entry->second.vkPipeline == VK_NULL_HANDLE || entry->second.optimizing ? entry->second.job : nullptr;
+        }
+
+    return entry->second.vkPipeline;
+}
+
+void
+voPipelineRegistry::Release( voDeviceContext * device, const key_t & key )
+{
+    std::lock_guard< std::mutex > lock( m_mutex );
+
+    auto entry = m_pipelines.find( key );
+    if( entry == m_pipelines.end() || entry->second.refCount == 0 )
+        {
+            spdlog::error( "Releasing a pipeline unknown to the registry" );
+            return;
+        }
+
+    // A pipeline still compiling or optimizing is erased by its job
+    if( --entry->second.refCount == 0 && entry->second.vkPipeline != VK_NULL_HANDLE && !entry->second.optimizing )
+        {
+            Erase( device, entry );
+        }
+}
+
+void
+voPipelineRegistry::Record( const std::string & recipe )
+{
+    std::lock_guard< std::mutex > lock( m_mutex );
+    m_recipes.insert( recipe );
+}
+
+voJobSystem::handle_t
+voPipelineRegistry::Compile( voDeviceContext * device, const key_t & key, const compile_t & compile, const compile_t & optimize,
+                             const std::vector< voJobSystem::handle_t > & dependencies )
+{
+    m_stats.numPipelines++;
+
+    return device->m_jobSystem.Schedule( [this, device, key, compile, optimize]()
+                                         {
+                                             VkPipeline vkPipeline = compile();
+
+                                             std::lock_guard< std::mutex > lock( m_mutex );
+
+                                             // Entries are not erased while compiling
+                                             auto entry               = m_pipelines.find( key );
+                                             entry->second.vkPipeline = vkPipeline;
+
+                                             // Kept until replaced by the optimized pipeline, even without users
+                                             if( optimize )
+                                                 {
+                                                     entry->second.optimizing = true;
+                                                     entry->second.job        = Optimize( device, key, optimize );
+                                                     return;
+                                                 }
+
+                                             if( entry->second.refCount == 0 && !entry->second.resident )
+                                                 {
+                                                     Erase( device, entry );
+                                                 }
+                                         },
+                                         dependencies );
+}
+
+voJobSystem::handle_t
+voPipelineRegistry::Optimize( voDeviceContext * device, const key_t & key, const compile_t & optimize )
+{
+    return device->m_jobSystem.Schedule( [this, device, key, optimize]()
+                                         {
+                                             VkPipeline vkPipeline = optimize();
+
+                                             std::lock_guard< std::mutex > lock( m_mutex );
+
+                                             // Neither erased while optimizing, users pick up the optimized pipeline through Get
+                                             auto             entry    = m_pipelines.find( key );
+                                             const VkPipeline replaced = entry->second.vkPipeline;
+
+                                             entry->second.vkPipeline = vkPipeline;
+                                             entry->second.optimizing = false;
+
+                                             // The frames in flight may still draw with it
+                                             device->m_deletionQueue.Destroy( [replaced]( voDeviceContext * device )
+                                                                              {
+                                                                                  vkDestroyPipeline( device->deviceInfo.logical, replaced, nullptr );
+                                                                              } );
+
+                                             if( entry->second.refCount == 0 && !entry->second.resident )
+                                                 {
+                                                     Erase( device, entry );
+                                                 }
+                                         } );
+}
+
+void
+voPipelineRegistry::Erase( voDeviceContext * device, std::map< key_t, entry_t >::iterator entry )
+{
+    const VkPipeline vkPipeline = entry->second.vkPipeline;
+
+    m_pipelines.erase( entry );
+    m_stats.numPipelines--;
+
+    // The frames in flight may still draw with it
+    device->m_deletionQueue.Destroy( [vkPipeline]( voDeviceContext * device )
+                                     {
+                                         vkDestroyPipeline( device->deviceInfo.logical, vkPipeline, nullptr );
+                                     } );
+}
@@ -0,0 +1,281 @@
+#include "vulkano/vo_queue.hpp"
+#include <algorithm>
+#include "vulkano/vo_deviceContext.hpp"
+#include "vulkano/vo_fence.hpp"
+
+#ifndef MAX_SUBMIT_WAITS
+#    define MAX_SUBMIT_WAITS 8
+#endif /** MAX_SUBMIT_WAITS */
+
+bool
+voQueue::Create( voDeviceContext * device, uint32_t family, uint32_t index )
+{
+    m_family        = family;
+    m_lastSubmitted = 0;
+    m_completed     = 0;
+
+    vkGetDeviceQueue( device->deviceInfo.logical, family, index, &m_vkQueue );
+
+    /* ------------------------------------------------ Timeline -------------------------------------------------------- */
+    if( device->enabledFeatures.timelineSemaphore )
+        {
+            VkSemaphoreTypeCreateInfo typeInfo =
+                {
+                    .sType         = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO,
+                    .semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE,
+                    .initialValue  = 0,
+                };
+
+            VkSemaphoreCreateInfo semaphoreInfo =
+                {
+                    .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+                    .pNext = &typeInfo,
+                };
+
+            VK_CHECK( vkCreateSemaphore( device->deviceInfo.logical, &semaphoreInfo, nullptr, &m_vkTimeline ),
+                      "Failed to create timeline semaphore" );
+        }
+
+    return m_vkQueue != VK_NULL_HANDLE;
+}
+
+void
+voQueue::Cleanup( voDeviceContext * device )
+{
+    if( m_vkQueue == VK_NULL_HANDLE )
+        {
+            return;
+        }
+
+    WaitIdle( device );
+
+    vkDestroySemaphore( device->deviceInfo.logical, m_vkTimeline, nullptr );
+
+    m_vkTimeline = VK_NULL_HANDLE;
+    m_vkQueue    = VK_NULL_HANDLE;
+}
+
+uint64_t
+voQueue::Submit( voDeviceContext * device, const submit_t & submit )
+{
+    // One more slot for the binary semaphore
+    voAssert( submit.numWaits <= MAX_SUBMIT_WAITS );
+
+    VkSemaphore          waitSemaphores[MAX_SUBMIT_WAITS + 1];
+    uint64_t             waitValues[MAX_SUBMIT_WAITS + 1];
+    VkPipelineStageFlags waitStages[MAX_SUBMIT_WAITS + 1];
+    uint32_t             numWaits = 0;
+
+    /* ------------------------------------------------ Waits ----------------------------------------------------------- */
+    for( uint32_t i = 0; i < submit.numWaits; ++i )
+        {
+            const wait_t & wait = submit.waits[i];
+            if( wait.value == 0 )
+                {
+                    continue;
+                }
+
+            if( IsTimeline() )
+                {
+                    waitSemaphores[numWaits] = wait.queue->GetTimeline();
+                    waitValues[numWaits]     = wait.value;
+                    waitStages[numWaits]     = wait.stages;
+                    ++numWaits;
+                }
+            else
+                {
+                    // Fences can not be waited on by the GPU, the dependency is resolved on the host
+                    wait.queue->Wait( device, wait.value );
+                }
+        }
+
+    if( submit.waitSemaphore != VK_NULL_HANDLE )
+        {
+            waitSemaphores[numWaits] = submit.waitSemaphore;
+            waitValues[numWaits]     = 0; // Ignored for binary semaphores
+            waitStages[numWaits]     = submit.waitSemaphoreStages;
+            ++numWaits;
+        }
+
+    std::lock_guard< std::mutex > lock( m_mutex );
+
+    const uint64_t value = m_lastSubmitted + 1;
+
+    /* ------------------------------------------------ Signals --------------------------------------------------------- */
+    VkSemaphore signalSemaphores[2];
+    uint64_t    signalValues[2];
+    uint32_t    numSignals = 0;
+
+    if( IsTimeline() )
+        {
+            signalSemaphores[numSignals] = m_vkTimeline;
+            signalValues[numSignals]     = value;
+            ++numSignals;
+        }
+
+    if( submit.signalSemaphore != VK_NULL_HANDLE )
+        {
+            signalSemaphores[numSignals] = submit.signalSemaphore;
+            signalValues[numSignals]     = 0;
+            ++numSignals;
+        }
+
+    /* ------------------------------------------------ Submit ---------------------------------------------------------- */
+    {
+        VkTimelineSemaphoreSubmitInfo timelineInfo =
+            {
+                .sType                     = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO,
+                .waitSemaphoreValueCount   = numWaits,
+                .pWaitSemaphoreValues      = waitValues,
+                .signalSemaphoreValueCount = numSignals,
+                .pSignalSemaphoreValues    = signalValues,
+            };
+
+        VkSubmitInfo submitInfo =
+            {
+                .sType                = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+                .pNext                = IsTimeline() ? &timelineInfo : nullptr,
+                .waitSemaphoreCount   = numWaits,
+                .pWaitSemaphores      = waitSemaphores,
+                .pWaitDstStageMask    = waitStages,
+                .commandBufferCount   = submit.numCommandBuffers,
+                .pCommandBuffers      = submit.commandBuffers,
+                .signalSemaphoreCount = numSignals,
+                .pSignalSemaphores    = signalSemaphores,
+            };
+
+        VkFence fence = IsTimeline() ? VK_NULL_HANDLE : device->m_fencePool.Acquire( device );
+
+        VK_CHECK( vkQueueSubmit( m_vkQueue, 1, &submitInfo, fence ),
+                  "Failed to submit queue" );
+
+        if( fence != VK_NULL_HANDLE )
+            {
+                m_pendingFences.push_back( { value, fence } );
+            }
+    }
+
+    m_lastSubmitted = value;
+    return value;
+}
+
+VkResult
+voQueue::Present( const VkPresentInfoKHR & presentInfo )
+{
+    std::lock_guard< std::mutex > lock( m_mutex );
+    return vkQueuePresentKHR( m_vkQueue, &presentInfo );
+}
+
+bool
+voQueue::IsComplete( voDeviceContext * device, uint64_t value )
+{
+    std::lock_guard< std::mutex > lock( m_mutex );
+
+    if( value <= m_completed )
+        {
+            return true;
+        }
+
+    if( IsTimeline() )
+        {
+            VK_CHECK( vkGetSemaphoreCounterValue( device->deviceInfo.logical, m_vkTimeline, &m_completed ),
+                      "Failed to get timeline value" );
+        }
+    else
+        {
+            RetireFences( device );
+        }
+
+    return value <= m_completed;
+}
+
+void
+voQueue::Wait( voDeviceContext * device, uint64_t value )
+{
+    if( IsComplete( device, value ) )
+        {
+            return;
+        }
+
+    if( IsTimeline() )
+        {
+            VkSemaphoreWaitInfo waitInfo =
+                {
+                    .sType          = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+                    .semaphoreCount = 1,
+                    .pSemaphores    = &m_vkTimeline,
+                    .pValues        = &value,
+                };
+
+            VK_CHECK( vkWaitSemaphores( device->deviceInfo.logical, &waitInfo, UINT64_MAX ),
+                      "Failed to wait for timeline value" );
+
+            std::lock_guard< std::mutex > lock( m_mutex );
+            m_completed = std::max( m_completed, value );
+            return;
+        }
+
+    VkFence fence = VK_NULL_HANDLE;
+    {
+        std::lock_guard< std::mutex > lock( m_mutex );
+
+        for( const pending_fence_t & pending : m_pendingFences )
+            {
+                if( pending.value >= value )
+                    {
+                        fence = pending.fence;
+                        break;
+                    }
+            }
+
+        // The fence is not recycled by another thread until the wait is over
+        ++m_numFenceWaits;
+    }
+
+    // Without the lock, submissions to the queue go on meanwhile
+    if( fence != VK_NULL_HANDLE )
+        {
+            VK_CHECK( vkWaitForFences( device->deviceInfo.logical, 1, &fence, VK_TRUE, UINT64_MAX ),
+                      "Failed to wait for fence!" );
+        }
+
+    std::lock_guard< std::mutex > lock( m_mutex );
+    --m_numFenceWaits;
+    RetireFences( device );
+}
+
+void
+voQueue::WaitIdle( voDeviceContext * device )
+{
+    Wait( device, GetLastSubmitted() );
+}
+
+uint64_t
+voQueue::GetLastSubmitted()
+{
+    std::lock_guard< std::mutex > lock( m_mutex );
+    return m_lastSubmitted;
+}
+
+void
+voQueue::RetireFences( voDeviceContext * device )
+{
+    // Submissions on a queue complete in order, the first unsignaled fence ends the scan
+    while( !m_pendingFences.empty() &&
+           vkGetFenceStatus( device->deviceInfo.logical, m_pendingFences.front().fence ) == VK_SUCCESS )
+        {
+            m_completed = m_pendingFences.front().value;
+            m_retiredFences.push_back( m_pendingFences.front().fence );
+            m_pendingFences.pop_front();
+        }
+
+    // A fence reset by the pool would never signal for a thread still waiting on it
+    if( m_numFenceWaits == 0 )
+        {
+            for( VkFence fence : m_retiredFences )
+                {
+                    device->m_fencePool.Release( device, fence );
+                }
+            m_retiredFences.clear();
+        }
+}
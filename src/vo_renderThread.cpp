@@ -0,0 +1,126 @@
+#include "vulkano/vo_renderThread.hpp"
+#include "vulkano/vo_deviceContext.hpp"
+
+bool
+voRenderThread::Create( voDeviceContext * device, const CreateParms_t & parms )
+{
+    voAssert( !IsRunning() && "Render thread already created" );
+
+    m_device       = device;
+    m_record       = parms.record;
+    m_writeIndex   = 0;
+    m_pendingIndex = NO_LIST;
+    m_renderIndex  = NO_LIST;
+    m_resized      = false;
+    m_stop         = false;
+
+    m_thread = std::thread( &voRenderThread::ThreadLoop, this );
+
+    return true;
+}
+
+void
+voRenderThread::Cleanup()
+{
+    if( !IsRunning() )
+        {
+            return;
+        }
+
+    {
+        std::lock_guard< std::mutex > lock( m_mutex );
+        m_stop = true;
+    }
+    m_cond.notify_all();
+
+    m_thread.join();
+}
+
+voRenderList &
+voRenderThread::BeginList()
+{
+    std::unique_lock< std::mutex > lock( m_mutex );
+
+    // The main thread is a whole frame ahead, wait for the render thread to be done with the list,
+    // and to have picked up the submitted one so the next Submit has a free slot
+    m_cond.wait( lock, [this]() { return m_renderIndex != m_writeIndex && m_pendingIndex == NO_LIST; } );
+
+    voRenderList & list = m_lists[m_writeIndex];
+    list.Clear();
+
+    return list;
+}
+
+void
+voRenderThread::Submit()
+{
+    {
+        std::lock_guard< std::mutex > lock( m_mutex );
+        voAssert( m_pendingIndex == NO_LIST && "BeginList was not called" );
+
+        m_pendingIndex = m_writeIndex;
+        m_writeIndex ^= 1;
+    }
+    m_cond.notify_all();
+
+    // Frames are no longer begun on the main thread
+    m_device->m_jobSystem.RunMainThreadJobs();
+}
+
+void
+voRenderThread::Resize( int width, int height )
+{
+    // Successive requests are coalesced, like the swapchain does
+    std::lock_guard< std::mutex > lock( m_mutex );
+    m_width   = width;
+    m_height  = height;
+    m_resized = true;
+}
+
+void
+voRenderThread::ThreadLoop()
+{
+    while( true )
+        {
+            int  listIndex;
+            int  width;
+            int  height;
+            bool resized;
+
+            {
+                std::unique_lock< std::mutex > lock( m_mutex );
+                m_cond.wait( lock, [this]() { return m_stop || m_pendingIndex != NO_LIST; } );
+
+                // The last submitted list is rendered before leaving
+                if( m_pendingIndex == NO_LIST )
+                    {
+                        return;
+                    }
+
+                listIndex      = m_pendingIndex;
+                m_renderIndex  = m_pendingIndex;
+                m_pendingIndex = NO_LIST;
+
+                width     = m_width;
+                height    = m_height;
+                resized   = m_resized;
+                m_resized = false;
+            }
+            m_cond.notify_all();
+
+            if( resized )
+                {
+                    m_device->ResizeWindow( width, height );
+                }
+
+            const uint32_t frameIndex = m_device->BeginFrame();
+            m_record( m_device, frameIndex, m_lists[listIndex] );
+            m_device->EndFrame();
+
+            {
+                std::lock_guard< std::mutex > lock( m_mutex );
+                m_renderIndex = NO_LIST;
+            }
+            m_cond.notify_all();
+        }
+}
@@ -58,6 +58,16 @@ Renderer::Initialize()
             return false;
         }
 
+    // Frames are begun, recorded and presented by the render thread from now on
+    if( m_config.renderThread )
+        {
+            voRenderThread::CreateParms_t renderThreadParms = {
+                .record = [this]( voDeviceContext *, uint32_t frameIndex, const voRenderList & list ) { RecordList( frameIndex, list ); },
+            };
+
+            m_renderThread.Create( &m_deviceContext, renderThreadParms );
+        }
+
     return true;
 }
 
@@ -86,10 +96,12 @@ Renderer::CreatePipeline()
 void
 Renderer::Cleanup()
 {
-    vkDeviceWaitIdle( m_deviceContext.deviceInfo.logical );
+    // The last submitted frame is presented before the render thread leaves
+    m_renderThread.Cleanup();
 
+    // The device context waits for the last frames before flushing the deletion queue
     m_shader.Cleanup( &m_deviceContext );
-    m_pipeline.Cleanup( &m_deviceContext );
+    m_deviceContext.m_deletionQueue.Release( m_pipeline );
 
     m_deviceContext.Cleanup();
 }
@@ -97,6 +109,13 @@ Renderer::Cleanup()
 void
 Renderer::BeginFrame()
 {
+    // Only waits when the render thread is a whole frame behind
+    if( m_renderThread.IsRunning() )
+        {
+            m_renderList = &m_renderThread.BeginList();
+            return;
+        }
+
     m_deviceContext.BeginFrame();
     m_deviceContext.BeginRenderPass();
 }
@@ -104,25 +123,73 @@ Renderer::BeginFrame()
 void
 Renderer::EndFrame()
 {
+    if( m_renderThread.IsRunning() )
+        {
+            m_renderThread.Submit();
+            m_renderList = nullptr;
+            return;
+        }
+
     m_deviceContext.EndRenderPass();
     m_deviceContext.EndFrame();
 }
 
+void
+Renderer::RecordList( uint32_t frameIndex, const voRenderList & list )
+{
+    VkCommandBuffer cmdBuffer = m_deviceContext.m_vkCommandBuffers[frameIndex];
+
+    m_deviceContext.BeginRenderPass();
+
+    const voPipeline * boundPipeline = nullptr;
+    for( const voRenderList::draw_t & draw : list.draws )
+        {
+            if( draw.pipeline != boundPipeline )
+                {
+                    // Skipped until the pipeline, or its fallback, is compiled
+                    if( !draw.pipeline->BindPipeline( cmdBuffer ) )
+                        {
+                            continue;
+                        }
+                    boundPipeline = draw.pipeline;
+                }
+
+            draw.model->DrawIndexed( cmdBuffer );
+        }
+
+    m_deviceContext.EndRenderPass();
+}
+
 void
 Renderer::DrawModel( voModel & model )
 {
-    const uint32_t imageIndex = m_deviceContext.BeginFrame();
-    VkCommandBuffer cmdBuffer = m_deviceContext.m_vkCommandBuffers[imageIndex];
-    m_pipeline.BindPipeline( cmdBuffer );
-    model.DrawIndexed( cmdBuffer );
+    // Only described, the render thread records it
+    if( m_renderThread.IsRunning() )
+        {
+            m_renderList->draws.push_back( { .pipeline = &m_pipeline, .model = &model } );
+            return;
+        }
+
+    // Records into the frame opened by BeginFrame
+    const uint32_t frameIndex = m_deviceContext.swapChain.GetFrameIndex();
+    VkCommandBuffer cmdBuffer = m_deviceContext.m_vkCommandBuffers[frameIndex];
+    if( m_pipeline.BindPipeline( cmdBuffer ) )
+        {
+            model.DrawIndexed( cmdBuffer );
+        }
 }
 
 void
 Renderer::Resize( int width, int height )
 {
+    // Viewport and scissor are dynamic, the pipeline outlives the swapchain
+    if( m_renderThread.IsRunning() )
+        {
+            m_renderThread.Resize( width, height );
+            return;
+        }
+
     m_deviceContext.ResizeWindow( width, height );
-    m_pipeline.Cleanup( &m_deviceContext );
-    CreatePipeline();
 }
 
 bool
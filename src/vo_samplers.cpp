@@ -1,5 +1,6 @@
 #include "vulkano/vo_samplers.hpp"
 
+#include "vulkano/vo_descriptor.hpp"
 #include "vulkano/vo_deviceContext.hpp"
 
 VkSampler voSamplers::m_samplerStandard { VK_NULL_HANDLE };
@@ -60,6 +61,8 @@ voSamplers::InitializeSamplers( voDeviceContext * device )
 void
 voSamplers::Cleanup( voDeviceContext * device )
 {
+    voDescriptors::Forget( device, reinterpret_cast< uint64_t >( m_samplerStandard ) );
+    voDescriptors::Forget( device, reinterpret_cast< uint64_t >( m_samplerDepth ) );
     vkDestroySampler( device->deviceInfo.logical, m_samplerStandard, nullptr );
     vkDestroySampler( device->deviceInfo.logical, m_samplerDepth, nullptr );
 }
@@ -1,13 +1,218 @@
 #include "vulkano/vo_shader.hpp"
 
+#include <algorithm>
 #include <vulkan/vulkan_core.h>
 #include "vo_utilities.hpp"
 #include "vulkano/vo_deviceContext.hpp"
 #include "vulkano/vo_tools.hpp"
 
+/* ---- SPIR-V ---- */
+
+// Only what the reflection reads, from the SPIR-V specification
+static constexpr uint32_t SPV_MAGIC = 0x07230203;
+
+static constexpr uint32_t SPV_OP_TYPE_INT           = 21;
+static constexpr uint32_t SPV_OP_TYPE_FLOAT         = 22;
+static constexpr uint32_t SPV_OP_TYPE_VECTOR        = 23;
+static constexpr uint32_t SPV_OP_TYPE_MATRIX        = 24;
+static constexpr uint32_t SPV_OP_TYPE_IMAGE         = 25;
+static constexpr uint32_t SPV_OP_TYPE_SAMPLER       = 26;
+static constexpr uint32_t SPV_OP_TYPE_SAMPLED_IMAGE = 27;
+static constexpr uint32_t SPV_OP_TYPE_ARRAY         = 28;
+static constexpr uint32_t SPV_OP_TYPE_RUNTIME_ARRAY = 29;
+static constexpr uint32_t SPV_OP_TYPE_STRUCT        = 30;
+static constexpr uint32_t SPV_OP_TYPE_POINTER       = 32;
+static constexpr uint32_t SPV_OP_CONSTANT           = 43;
+static constexpr uint32_t SPV_OP_VARIABLE           = 59;
+static constexpr uint32_t SPV_OP_DECORATE           = 71;
+static constexpr uint32_t SPV_OP_MEMBER_DECORATE    = 72;
+
+static constexpr uint32_t SPV_DECORATION_BLOCK         = 2;
+static constexpr uint32_t SPV_DECORATION_BUFFER_BLOCK  = 3;
+static constexpr uint32_t SPV_DECORATION_ARRAY_STRIDE  = 6;
+static constexpr uint32_t SPV_DECORATION_MATRIX_STRIDE = 7;
+static constexpr uint32_t SPV_DECORATION_BUILTIN       = 11;
+static constexpr uint32_t SPV_DECORATION_LOCATION      = 30;
+static constexpr uint32_t SPV_DECORATION_BINDING       = 33;
+static constexpr uint32_t SPV_DECORATION_SET           = 34;
+static constexpr uint32_t SPV_DECORATION_OFFSET        = 35;
+
+static constexpr uint32_t SPV_STORAGE_UNIFORM_CONSTANT = 0;
+static constexpr uint32_t SPV_STORAGE_INPUT            = 1;
+static constexpr uint32_t SPV_STORAGE_UNIFORM          = 2;
+static constexpr uint32_t SPV_STORAGE_PUSH_CONSTANT    = 9;
+static constexpr uint32_t SPV_STORAGE_STORAGE_BUFFER   = 12;
+
+static constexpr uint32_t SPV_DIM_BUFFER       = 5;
+static constexpr uint32_t SPV_DIM_SUBPASS_DATA = 6;
+
+/**
+ * FNV-1a hash of the SPIR-V code, the same code gives the same hash from one load to the other.
+ */
+static uint64_t
+HashCode( const uint8_t * code, size_t size )
+{
+    uint64_t hash = 14695981039346656037ull;
+    for( size_t i = 0; i < size; i++ )
+        {
+            hash = ( hash ^ code[i] ) * 1099511628211ull;
+        }
+
+    return hash;
+}
+
+/**
+ * What the reflection knows about a SPIR-V id, a type, a constant or a variable.
+ */
+struct spvId_t
+{
+    uint32_t opcode { 0 };
+    uint32_t typeId { 0 };       ///< Pointee, element, component or column type, type of constants and variables
+    uint32_t storageClass { 0 }; ///< Of pointers and variables
+    uint32_t value { 0 };        ///< Width of scalars, count of vectors and matrices, length id of arrays, value of constants
+    uint32_t signedness { 0 };
+    uint32_t dim { 0 };     ///< Of images
+    uint32_t sampled { 0 }; ///< Of images, 2 for storage images
+
+    uint32_t set { 0 };
+    uint32_t binding { UINT32_MAX };
+    uint32_t location { UINT32_MAX };
+    uint32_t arrayStride { 0 };
+    bool     builtIn { false };
+    bool     block { false };
+    bool     bufferBlock { false };
+
+    std::vector< uint32_t > members {};        ///< Types of the members of structs
+    std::vector< uint32_t > memberOffsets {};  ///< Decorated before the struct is declared
+    std::vector< uint32_t > memberStrides {};  ///< Matrix strides of the members
+};
+
+/**
+ * Size in bytes of a type laid out in a block, zero for runtime sized arrays.
+ */
+static uint32_t
+GetTypeSize( const std::vector< spvId_t > & ids, uint32_t typeId, uint32_t matrixStride = 0 )
+{
+    const spvId_t & type = ids[typeId];
+    switch( type.opcode )
+        {
+            case SPV_OP_TYPE_INT:
+            case SPV_OP_TYPE_FLOAT:
+                return type.value / 8;
+
+            case SPV_OP_TYPE_VECTOR:
+                return type.value * GetTypeSize( ids, type.typeId );
+
+            case SPV_OP_TYPE_MATRIX:
+                return type.value * ( matrixStride != 0 ? matrixStride : GetTypeSize( ids, type.typeId ) );
+
+            case SPV_OP_TYPE_ARRAY:
+                return ids[type.value].value * ( type.arrayStride != 0 ? type.arrayStride : GetTypeSize( ids, type.typeId ) );
+
+            case SPV_OP_TYPE_STRUCT:
+                {
+                    uint32_t size = 0;
+                    for( size_t i = 0; i < type.members.size(); i++ )
+                        {
+                            const uint32_t offset = i < type.memberOffsets.size() ? type.memberOffsets[i] : 0;
+                            const uint32_t stride = i < type.memberStrides.size() ? type.memberStrides[i] : 0;
+                            size                  = std::max( size, offset + GetTypeSize( ids, type.members[i], stride ) );
+                        }
+                    return size;
+                }
+
+            default:
+                return 0;
+        }
+}
+
+/**
+ * Descriptor type of a resource variable, `VK_DESCRIPTOR_TYPE_MAX_ENUM` if it is not one.
+ */
+static VkDescriptorType
+GetDescriptorType( const std::vector< spvId_t > & ids, uint32_t storageClass, uint32_t typeId )
+{
+    const spvId_t & type = ids[typeId];
+
+    if( storageClass == SPV_STORAGE_STORAGE_BUFFER )
+        {
+            return VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        }
+
+    if( storageClass == SPV_STORAGE_UNIFORM )
+        {
+            // Storage buffers of older SPIR-V are uniforms decorated as buffer blocks
+            return type.bufferBlock ? VK_DESCRIPTOR_TYPE_STORAGE_BUFFER : VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        }
+
+    if( storageClass != SPV_STORAGE_UNIFORM_CONSTANT )
+        {
+            return VK_DESCRIPTOR_TYPE_MAX_ENUM;
+        }
+
+    switch( type.opcode )
+        {
+            case SPV_OP_TYPE_SAMPLER:
+                return VK_DESCRIPTOR_TYPE_SAMPLER;
+
+            case SPV_OP_TYPE_SAMPLED_IMAGE:
+                return ids[type.typeId].dim == SPV_DIM_BUFFER ? VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER : VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+
+            case SPV_OP_TYPE_IMAGE:
+                if( type.dim == SPV_DIM_SUBPASS_DATA )
+                    {
+                        return VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+                    }
+                if( type.dim == SPV_DIM_BUFFER )
+                    {
+                        return type.sampled == 2 ? VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER : VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER;
+                    }
+                return type.sampled == 2 ? VK_DESCRIPTOR_TYPE_STORAGE_IMAGE : VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+
+            default:
+                return VK_DESCRIPTOR_TYPE_MAX_ENUM;
+        }
+}
+
+/**
+ * Format of a vertex input, 32-bit scalars and vectors only.
+ */
+static VkFormat
+GetVertexFormat( const std::vector< spvId_t > & ids, uint32_t typeId )
+{
+    const spvId_t & type          = ids[typeId];
+    const bool      isVector      = type.opcode == SPV_OP_TYPE_VECTOR;
+    const spvId_t & component     = isVector ? ids[type.typeId] : type;
+    const uint32_t  numComponents = isVector ? type.value : 1;
+
+    if( component.value != 32 || numComponents < 1 || numComponents > 4 )
+        {
+            return VK_FORMAT_UNDEFINED;
+        }
+
+    // The formats of each component type follow each other, by number of components
+    static const VkFormat floatFormats[4] = { VK_FORMAT_R32_SFLOAT, VK_FORMAT_R32G32_SFLOAT, VK_FORMAT_R32G32B32_SFLOAT, VK_FORMAT_R32G32B32A32_SFLOAT };
+    static const VkFormat sintFormats[4]  = { VK_FORMAT_R32_SINT, VK_FORMAT_R32G32_SINT, VK_FORMAT_R32G32B32_SINT, VK_FORMAT_R32G32B32A32_SINT };
+    static const VkFormat uintFormats[4]  = { VK_FORMAT_R32_UINT, VK_FORMAT_R32G32_UINT, VK_FORMAT_R32G32B32_UINT, VK_FORMAT_R32G32B32A32_UINT };
+
+    switch( component.opcode )
+        {
+            case SPV_OP_TYPE_FLOAT:
+                return floatFormats[numComponents - 1];
+
+            case SPV_OP_TYPE_INT:
+                return component.signedness != 0 ? sintFormats[numComponents - 1] : uintFormats[numComponents - 1];
+
+            default:
+                return VK_FORMAT_UNDEFINED;
+        }
+}
+
 bool
 voShader::Load( voDeviceContext * device, const char * name )
 {
+    this->name = name;
+
     // Mount the shaders file fileExtensions table
     const char * fileExtensions[SHADER_STAGE_NUM] {};
 #define EXT( S, N ) fileExtensions[SHADER_STAGE_##S] = N
@@ -44,7 +249,12 @@ voShader::Load( voDeviceContext * device, const char * name )
                         static_cast< int >( code.size() ) );
 
                     VkShaderStageFlagBits stage = GetShaderStageFlag( i );
-                    modules[id]               = { stage, module };
+                    modules[id]               = { stage, module, HashCode( reinterpret_cast< const uint8_t * >( code.data() ), code.size() ) };
+
+                    if( !Reflect( reinterpret_cast< const uint32_t * >( code.data() ), code.size() / sizeof( uint32_t ), stage, reflection ) )
+                        {
+                            spdlog::warn( "Failed to reflect shader {}", nameSpirv );
+                        }
                 }
         }
 
@@ -54,11 +264,40 @@ voShader::Load( voDeviceContext * device, const char * name )
 void
 voShader::Cleanup( voDeviceContext * device )
 {
+    std::vector< voJobSystem::handle_t > compiles;
+    {
+        std::lock_guard< std::mutex > lock( m_compilesMutex );
+        compiles.swap( m_compiles );
+    }
+
+    // The calling thread helps with the jobs meanwhile
+    for( const voJobSystem::handle_t & compile : compiles )
+        {
+            device->m_jobSystem.Wait( compile );
+        }
+
     for( const auto & [key, moduleData] : modules )
         {
             vkDestroyShaderModule( device->deviceInfo.logical, moduleData.module, nullptr );
         }
     modules.clear();
+    reflection = {};
+    name.clear();
+}
+
+void
+voShader::AddCompile( const voJobSystem::handle_t & job )
+{
+    if( voJobSystem::IsComplete( job ) )
+        {
+            return;
+        }
+
+    std::lock_guard< std::mutex > lock( m_compilesMutex );
+
+    // Compiles that have run no longer hold the modules
+    std::erase_if( m_compiles, []( const voJobSystem::handle_t & compile ) { return voJobSystem::IsComplete( compile ); } );
+    m_compiles.push_back( job );
 }
 
 VkShaderModule
@@ -77,3 +316,263 @@ voShader::CreateShaderModule( VkDevice vkDevice, const char * code, const int si
 
     return shaderModule;
 }
+
+bool
+voShader::Reflect( const uint32_t * code, size_t numWords, VkShaderStageFlagBits stage, reflection_t & reflection )
+{
+    // Header: magic, version, generator, bound of the ids, schema
+    if( numWords < 5 || code[0] != SPV_MAGIC )
+        {
+            return false;
+        }
+
+    std::vector< spvId_t > ids( code[3] );
+    std::vector< uint32_t > variables {};
+
+    const auto isValidId = [&]( uint32_t id ) { return id < ids.size(); };
+
+    /* ----------------------------------------- Instructions ----------------------------------------- */
+
+    for( size_t word = 5; word < numWords; )
+        {
+            const uint32_t   opcode    = code[word] & 0xFFFF;
+            const uint32_t   wordCount = code[word] >> 16;
+            const uint32_t * operands  = code + word + 1;
+
+            if( wordCount == 0 || word + wordCount > numWords )
+                {
+                    return false;
+                }
+            word += wordCount;
+
+            switch( opcode )
+                {
+                    case SPV_OP_DECORATE:
+                        {
+                            if( wordCount < 3 || !isValidId( operands[0] ) ) break;
+
+                            spvId_t &      target = ids[operands[0]];
+                            const uint32_t value  = wordCount > 3 ? operands[2] : 0;
+                            switch( operands[1] )
+                                {
+                                    case SPV_DECORATION_BLOCK: target.block = true; break;
+                                    case SPV_DECORATION_BUFFER_BLOCK: target.bufferBlock = true; break;
+                                    case SPV_DECORATION_ARRAY_STRIDE: target.arrayStride = value; break;
+                                    case SPV_DECORATION_BUILTIN: target.builtIn = true; break;
+                                    case SPV_DECORATION_LOCATION: target.location = value; break;
+                                    case SPV_DECORATION_BINDING: target.binding = value; break;
+                                    case SPV_DECORATION_SET: target.set = value; break;
+                                    default: break;
+                                }
+                        }
+                        break;
+
+                    case SPV_OP_MEMBER_DECORATE:
+                        {
+                            if( wordCount < 5 || !isValidId( operands[0] ) ) break;
+
+                            spvId_t &      target = ids[operands[0]];
+                            const uint32_t member = operands[1];
+                            if( operands[2] == SPV_DECORATION_OFFSET )
+                                {
+                                    target.memberOffsets.resize( std::max< size_t >( target.memberOffsets.size(), member + 1 ) );
+                                    target.memberOffsets[member] = operands[3];
+                                }
+                            else if( operands[2] == SPV_DECORATION_MATRIX_STRIDE )
+                                {
+                                    target.memberStrides.resize( std::max< size_t >( target.memberStrides.size(), member + 1 ) );
+                                    target.memberStrides[member] = operands[3];
+                                }
+                        }
+                        break;
+
+                    case SPV_OP_TYPE_INT:
+                    case SPV_OP_TYPE_FLOAT:
+                        if( wordCount < 3 || !isValidId( operands[0] ) ) break;
+                        ids[operands[0]].opcode     = opcode;
+                        ids[operands[0]].value      = operands[1];
+                        ids[operands[0]].signedness = wordCount > 3 ? operands[2] : 0;
+                        break;
+
+                    case SPV_OP_TYPE_VECTOR:
+                    case SPV_OP_TYPE_MATRIX:
+                    case SPV_OP_TYPE_ARRAY:
+                        if( wordCount < 4 || !isValidId( operands[0] ) ) break;
+                        ids[operands[0]].opcode = opcode;
+                        ids[operands[0]].typeId = operands[1];
+                        ids[operands[0]].value  = operands[2];
+                        break;
+
+                    case SPV_OP_TYPE_IMAGE:
+                        if( wordCount < 9 || !isValidId( operands[0] ) ) break;
+                        ids[operands[0]].opcode  = opcode;
+                        ids[operands[0]].typeId  = operands[1];
+                        ids[operands[0]].dim     = operands[2];
+                        ids[operands[0]].sampled = operands[6];
+                        break;
+
+                    case SPV_OP_TYPE_SAMPLER:
+                        if( wordCount < 2 || !isValidId( operands[0] ) ) break;
+                        ids[operands[0]].opcode = opcode;
+                        break;
+
+                    case SPV_OP_TYPE_SAMPLED_IMAGE:
+                    case SPV_OP_TYPE_RUNTIME_ARRAY:
+                        if( wordCount < 3 || !isValidId( operands[0] ) ) break;
+                        ids[operands[0]].opcode = opcode;
+                        ids[operands[0]].typeId = operands[1];
+                        break;
+
+                    case SPV_OP_TYPE_STRUCT:
+                        if( wordCount < 2 || !isValidId( operands[0] ) ) break;
+                        ids[operands[0]].opcode = opcode;
+                        ids[operands[0]].members.assign( operands + 1, operands + wordCount - 1 );
+                        break;
+
+                    case SPV_OP_TYPE_POINTER:
+                        if( wordCount < 4 || !isValidId( operands[0] ) ) break;
+                        ids[operands[0]].opcode       = opcode;
+                        ids[operands[0]].storageClass = operands[1];
+                        ids[operands[0]].typeId       = operands[2];
+                        break;
+
+                    case SPV_OP_CONSTANT:
+                        if( wordCount < 4 || !isValidId( operands[1] ) ) break;
+                        ids[operands[1]].opcode = opcode;
+                        ids[operands[1]].typeId = operands[0];
+                        ids[operands[1]].value  = operands[2];
+                        break;
+
+                    case SPV_OP_VARIABLE:
+                        if( wordCount < 4 || !isValidId( operands[1] ) ) break;
+                        ids[operands[1]].opcode       = opcode;
+                        ids[operands[1]].typeId       = operands[0];
+                        ids[operands[1]].storageClass = operands[2];
+                        variables.push_back( operands[1] );
+                        break;
+
+                    default:
+                        break;
+                }
+        }
+
+    /* ----------------------------------------- Variables ----------------------------------------- */
+
+    for( uint32_t variableId : variables )
+        {
+            const spvId_t & variable = ids[variableId];
+            if( !isValidId( variable.typeId ) || !isValidId( ids[variable.typeId].typeId ) )
+                {
+                    continue;
+                }
+
+            uint32_t typeId = ids[variable.typeId].typeId; // Pointee of the variable pointer
+
+            switch( variable.storageClass )
+                {
+                    case SPV_STORAGE_UNIFORM_CONSTANT:
+                    case SPV_STORAGE_UNIFORM:
+                    case SPV_STORAGE_STORAGE_BUFFER:
+                        {
+                            if( variable.binding == UINT32_MAX )
+                                {
+                                    break;
+                                }
+
+                            // Arrays of descriptors
+                            uint32_t descriptorCount = 1;
+                            while( ids[typeId].opcode == SPV_OP_TYPE_ARRAY || ids[typeId].opcode == SPV_OP_TYPE_RUNTIME_ARRAY )
+                                {
+                                    const spvId_t & array = ids[typeId];
+                                    descriptorCount *= array.opcode == SPV_OP_TYPE_ARRAY && isValidId( array.value ) ? ids[array.value].value : 0;
+                                    typeId = array.typeId;
+                                }
+
+                            const VkDescriptorType descriptorType = GetDescriptorType( ids, variable.storageClass, typeId );
+                            if( descriptorType == VK_DESCRIPTOR_TYPE_MAX_ENUM )
+                                {
+                                    break;
+                                }
+
+                            // Merged with the same binding of the other stages
+                            auto found = std::find_if( reflection.bindings.begin(), reflection.bindings.end(), [&]( const binding_t & binding )
+                                                       { return binding.set == variable.set && binding.binding == variable.binding; } );
+                            if( found != reflection.bindings.end() )
+                                {
+                                    if( found->descriptorType != descriptorType )
+                                        {
+                                            spdlog::warn( "Shader binding {} of set {} has different types across stages", variable.binding, variable.set );
+                                        }
+                                    found->stageFlags |= stage;
+                                    break;
+                                }
+
+                            reflection.bindings.push_back( {
+                                .set             = variable.set,
+                                .binding         = variable.binding,
+                                .descriptorType  = descriptorType,
+                                .descriptorCount = descriptorCount,
+                                .stageFlags      = static_cast< VkShaderStageFlags >( stage ),
+                            } );
+                        }
+                        break;
+
+                    case SPV_STORAGE_PUSH_CONSTANT:
+                        {
+                            const spvId_t & block = ids[typeId];
+
+                            uint32_t offset = UINT32_MAX;
+                            for( size_t i = 0; i < block.members.size(); i++ )
+                                {
+                                    offset = std::min( offset, i < block.memberOffsets.size() ? block.memberOffsets[i] : 0 );
+                                }
+                            if( offset == UINT32_MAX )
+                                {
+                                    offset = 0;
+                                }
+
+                            const uint32_t        end           = GetTypeSize( ids, typeId );
+                            VkPushConstantRange & pushConstants = reflection.pushConstants;
+
+                            // One range covering every stage
+                            if( pushConstants.size == 0 )
+                                {
+                                    pushConstants = { .stageFlags = static_cast< VkShaderStageFlags >( stage ), .offset = offset, .size = end - offset };
+                                }
+                            else
+                                {
+                                    const uint32_t rangeEnd = std::max( pushConstants.offset + pushConstants.size, end );
+                                    pushConstants.offset    = std::min( pushConstants.offset, offset );
+                                    pushConstants.size      = rangeEnd - pushConstants.offset;
+                                    pushConstants.stageFlags |= stage;
+                                }
+                        }
+                        break;
+
+                    case SPV_STORAGE_INPUT:
+                        {
+                            // Built-ins, like gl_VertexIndex, are not fed by vertex buffers
+                            if( stage != VK_SHADER_STAGE_VERTEX_BIT || variable.builtIn || variable.location == UINT32_MAX )
+                                {
+                                    break;
+                                }
+
+                            reflection.vertexInputs.push_back( {
+                                .location = variable.location,
+                                .format   = GetVertexFormat( ids, typeId ),
+                            } );
+                        }
+                        break;
+
+                    default:
+                        break;
+                }
+        }
+
+    std::sort( reflection.bindings.begin(), reflection.bindings.end(), []( const binding_t & a, const binding_t & b )
+               { return a.set != b.set ? a.set < b.set : a.binding < b.binding; } );
+    std::sort( reflection.vertexInputs.begin(), reflection.vertexInputs.end(), []( const vertexInput_t & a, const vertexInput_t & b )
+               { return a.location < b.location; } );
+
+    return true;
+}
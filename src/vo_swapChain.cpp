@@ -1,15 +1,17 @@
 #include "vulkano/vo_swapChain.hpp"
 #include <vulkan/vulkan_core.h>
+#include <algorithm>
 #include <array>
 #include "vulkano/vo_deviceContext.hpp"
 
 bool
-voSwapChain::Create( voDeviceContext * device, int width, int height )
+voSwapChain::Create( voDeviceContext * device, int width, int height, uint32_t framesInFlight )
 {
     SetExtent( device->GetPhysicalProperties()->surfaceCapabilities, width, height );
 
-    CreateSemaphores( device );
+    CreateFrames( device, framesInFlight );
     CreateSwapchain( device );
+    CreateSemaphores( device );
     CreateDepthStencil( device );
     CreateRenderPass( device );
     CreateFramebuffers( device );
@@ -20,24 +22,36 @@ voSwapChain::Create( voDeviceContext * device, int width, int height )
 void
 voSwapChain::Cleanup( voDeviceContext * device )
 {
-    // semaphores
+    // Frames may still be in flight
+    vkDeviceWaitIdle( device->deviceInfo.logical );
+
+    // frames
     {
-        vkDestroySemaphore( device->deviceInfo.logical, m_vkRenderFinishedSemaphore, nullptr );
-        vkDestroySemaphore( device->deviceInfo.logical, m_vkImageAvailableSemaphore, nullptr );
+        for( auto & frame : m_frames )
+            {
+                vkDestroySemaphore( device->deviceInfo.logical, frame.imageAvailableSemaphore, nullptr );
+            }
+        m_frames.clear();
+        m_frameIndex = 0;
+    }
 
-        m_vkRenderFinishedSemaphore = VK_NULL_HANDLE;
-        m_vkImageAvailableSemaphore = VK_NULL_HANDLE;
+    // semaphores
+    {
+        for( auto & semaphore : m_vkRenderFinishedSemaphores )
+            {
+                vkDestroySemaphore( device->deviceInfo.logical, semaphore, nullptr );
+            }
+        m_vkRenderFinishedSemaphores.clear();
     }
 
     // depth buffer
     {
         vkDestroyImageView( device->deviceInfo.logical, m_vkDepthImageView, nullptr );
-        vkDestroyImage( device->deviceInfo.logical, m_vkDepthImage, nullptr );
-        vkFreeMemory( device->deviceInfo.logical, m_vkDepthImageMemory, nullptr );
+        device->m_memory->DestroyImage( m_vkDepthImage, m_vmaDepthAllocation );
 
         m_vkDepthImageView   = VK_NULL_HANDLE;
         m_vkDepthImage       = VK_NULL_HANDLE;
-        m_vkDepthImageMemory = VK_NULL_HANDLE;
+        m_vmaDepthAllocation = VK_NULL_HANDLE;
     }
 
     // frame buffer
@@ -72,72 +86,111 @@ voSwapChain::Cleanup( voDeviceContext * device )
 }
 
 void
-voSwapChain::Resize( voDeviceContext * device, int width, int height )
+voSwapChain::Resize( voDeviceContext *, int width, int height )
 {
-    vkDeviceWaitIdle( device->deviceInfo.logical );
-
+    // Bursts of resize events only keep the last size, the next BeginFrame rebuilds the swapchain once
+    m_width   = width;
+    m_height  = height;
     m_resized = true;
+}
 
-    SetExtent( device->GetPhysicalProperties()->surfaceCapabilities, width, height );
+void
+voSwapChain::Recreate( voDeviceContext * device )
+{
+    m_resized = false;
+
+    VkSurfaceCapabilitiesKHR * capabilities = &device->GetPhysicalProperties()->surfaceCapabilities;
+
+    VK_CHECK( vkGetPhysicalDeviceSurfaceCapabilitiesKHR( device->deviceInfo.physical, device->VkSurface, capabilities ),
+              "Failed to vkGetPhysicalDeviceSurfaceCapabilitiesKHR!" );
+
+    // The render pass only depends on the formats, it is kept along with every pipeline built against it
+    SetExtent( *capabilities, static_cast< int >( m_width ), static_cast< int >( m_height ) );
     CreateSwapchain( device );
+    CreateSemaphores( device );
     CreateDepthStencil( device );
     CreateFramebuffers( device );
+
+    spdlog::info( "Swapchain recreated ({}, {})", m_vkExtent.width, m_vkExtent.height );
 }
 
 uint32_t
 voSwapChain::BeginFrame( voDeviceContext * device )
 {
+    voAssert( m_frameIndex < device->m_vkCommandBuffers.size() && "Not enough command buffers for the frames in flight" );
+
+    const frame_t & frame = m_frames[m_frameIndex];
+
     m_currentImageIndex = 0;
 
+    // Only blocks when the GPU is still executing the last submission of this slot
+    device->m_graphicsQueue.Wait( device, frame.submitValue );
+
+    // Pending resize requests are applied once, the retired resources outlive the frames still using them
+    if( m_resized )
+        {
+            Recreate( device );
+        }
+
     // Get image index
     {
-        VkResult result = vkAcquireNextImageKHR( device->deviceInfo.logical, m_vkSwapChain, UINT64_MAX, m_vkImageAvailableSemaphore, VK_NULL_HANDLE, &m_currentImageIndex );
+        VkResult result = vkAcquireNextImageKHR( device->deviceInfo.logical, m_vkSwapChain, UINT64_MAX, frame.imageAvailableSemaphore, VK_NULL_HANDLE, &m_currentImageIndex );
+        if( VK_ERROR_OUT_OF_DATE_KHR == result )
+            {
+                // The semaphore is left unsignaled, it can be used again with the new swapchain
+                Recreate( device );
+                result = vkAcquireNextImageKHR( device->deviceInfo.logical, m_vkSwapChain, UINT64_MAX, frame.imageAvailableSemaphore, VK_NULL_HANDLE, &m_currentImageIndex );
+            }
+
         voAssert( ( VK_SUCCESS == result || VK_SUBOPTIMAL_KHR == result ) &&
                   "Failed to acquire swap chain image" );
     }
 
     // Reset the command buffer
-    vkResetCommandBuffer( device->m_vkCommandBuffers[m_currentImageIndex], VK_COMMAND_BUFFER_RESET_RELEASE_RESOURCES_BIT );
+    vkResetCommandBuffer( device->m_vkCommandBuffers[m_frameIndex], VK_COMMAND_BUFFER_RESET_RELEASE_RESOURCES_BIT );
 
     // Begin recording draw commands
     VkCommandBufferBeginInfo beginInfo =
         {
             .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
-            .flags = VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT,
+            .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
         };
 
-    vkBeginCommandBuffer( device->m_vkCommandBuffers[m_currentImageIndex], &beginInfo );
+    vkBeginCommandBuffer( device->m_vkCommandBuffers[m_frameIndex], &beginInfo );
 
-    return m_currentImageIndex;
+    return m_frameIndex;
 }
 
 void
 voSwapChain::EndFrame( voDeviceContext * device )
 {
-    VK_CHECK( vkEndCommandBuffer( device->m_vkCommandBuffers[m_currentImageIndex] ),
+    const uint32_t frameIndex = m_frameIndex;
+    frame_t &      frame      = m_frames[frameIndex];
+
+    VK_CHECK( vkEndCommandBuffer( device->m_vkCommandBuffers[frameIndex] ),
               "Failed to record command buffer" );
 
+    // Recording moves on to the next slot, whatever the outcome of the presentation
+    m_frameIndex = ( m_frameIndex + 1 ) % static_cast< uint32_t >( m_frames.size() );
+
     /* ------------------------------------------------ Submit ------------------------------------------------------------ */
     {
-        VkPipelineStageFlags waitStages[1] =
+        voQueue::submit_t submit =
             {
-                VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                .numCommandBuffers   = 1,
+                .commandBuffers      = &device->m_vkCommandBuffers[frameIndex],
+                .numWaits            = static_cast< uint32_t >( m_frameWaits.size() ),
+                .waits               = m_frameWaits.data(),
+                .waitSemaphore       = frame.imageAvailableSemaphore,
+                .waitSemaphoreStages = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                .signalSemaphore     = m_vkRenderFinishedSemaphores[m_currentImageIndex],
             };
 
-        VkSubmitInfo submitInfo =
-            {
-                .sType                = VK_STRUCTURE_TYPE_SUBMIT_INFO,
-                .waitSemaphoreCount   = 1,
-                .pWaitSemaphores      = &m_vkImageAvailableSemaphore,
-                .pWaitDstStageMask    = waitStages,
-                .commandBufferCount   = 1,
-                .pCommandBuffers      = &device->m_vkCommandBuffers[m_currentImageIndex],
-                .signalSemaphoreCount = 1,
-                .pSignalSemaphores    = &m_vkRenderFinishedSemaphore,
-            };
+        frame.submitValue = device->m_graphicsQueue.Submit( device, submit );
+        m_frameWaits.clear();
 
-        VK_CHECK( vkQueueSubmit( device->m_vkGraphicsQueue, 1, &submitInfo, VK_NULL_HANDLE ),
-                  "Failed to submit queue" );
+        // Objects released while recording the frame are destroyed once it has been executed
+        device->m_deletionQueue.Stamp( &device->m_graphicsQueue, frame.submitValue );
     }
 
     /* ------------------------------------------------ Present ------------------------------------------------------------ */
@@ -146,28 +199,44 @@ voSwapChain::EndFrame( voDeviceContext * device )
             {
                 .sType              = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
                 .waitSemaphoreCount = 1,
-                .pWaitSemaphores    = &m_vkRenderFinishedSemaphore,
+                .pWaitSemaphores    = &m_vkRenderFinishedSemaphores[m_currentImageIndex],
                 .swapchainCount     = 1,
                 .pSwapchains        = &m_vkSwapChain,
                 .pImageIndices      = &m_currentImageIndex,
             };
 
-        VkResult result = vkQueuePresentKHR( device->presentQueue, &presentInfo );
-        if( m_resized || VK_SUBOPTIMAL_KHR == result || VK_ERROR_OUT_OF_DATE_KHR == result )
+        VkResult result = device->queueIds.IsGraphicsAndPresentationEqual() ? device->m_graphicsQueue.Present( presentInfo )
+                                                                             : vkQueuePresentKHR( device->presentQueue, &presentInfo );
+        if( VK_SUBOPTIMAL_KHR == result || VK_ERROR_OUT_OF_DATE_KHR == result )
             {
-                m_resized = false;
-                Resize( device, m_width, m_height );
+                // Rebuilt by the next BeginFrame, along with any resize requested meanwhile
+                m_resized = true;
                 return;
             }
 
         voAssert( VK_SUCCESS == result && "Failed to acquire swap chain image" );
     }
+}
+
+void
+voSwapChain::AddWait( const voQueue::wait_t & wait )
+{
+    // Several waits on the same queue collapse into the latest value
+    for( voQueue::wait_t & frameWait : m_frameWaits )
+        {
+            if( frameWait.queue == wait.queue )
+                {
+                    frameWait.value = std::max( frameWait.value, wait.value );
+                    frameWait.stages |= wait.stages;
+                    return;
+                }
+        }
 
-    vkQueueWaitIdle( device->presentQueue );
+    m_frameWaits.push_back( wait );
 }
 
 void
-voSwapChain::BeginRenderPass( voDeviceContext * device )
+voSwapChain::BeginRenderPass( voDeviceContext * device, VkSubpassContents contents )
 {
     /* ------------------------------------------------ Render Pass ------------------------------------------------------------ */
     {
@@ -187,9 +256,15 @@ voSwapChain::BeginRenderPass( voDeviceContext * device )
                 .clearValueCount = 2,
                 .pClearValues    = clearValues,
         };
-        vkCmdBeginRenderPass( device->m_vkCommandBuffers[m_currentImageIndex], &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE );
+        vkCmdBeginRenderPass( device->m_vkCommandBuffers[m_frameIndex], &renderPassInfo, contents );
     }
 
+    // Only secondary command buffers can be executed, they set their own dynamic state
+    if( VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS == contents )
+        {
+            return;
+        }
+
     /* ------------------------------------------------ Viewport --------------------------------------------------------------- */
     {
         VkViewport viewport = {
@@ -200,7 +275,7 @@ voSwapChain::BeginRenderPass( voDeviceContext * device )
             .minDepth = 0.0F,
             .maxDepth = 1.0F,
         };
-        vkCmdSetViewport( device->m_vkCommandBuffers[m_currentImageIndex], 0, 1, &viewport );
+        vkCmdSetViewport( device->m_vkCommandBuffers[m_frameIndex], 0, 1, &viewport );
     }
 
     /* ----------------------------------------------- Scissor ------------------------------------------------------------------- */
@@ -215,26 +290,62 @@ voSwapChain::BeginRenderPass( voDeviceContext * device )
                        .height = static_cast< uint32_t >( m_height ),
                        }
         };
-        vkCmdSetScissor( device->m_vkCommandBuffers[m_currentImageIndex], 0, 1, &scissor );
+        vkCmdSetScissor( device->m_vkCommandBuffers[m_frameIndex], 0, 1, &scissor );
     }
 }
 
 void
 voSwapChain::EndRenderPass( voDeviceContext * device ) const
 {
-    vkCmdEndRenderPass( device->m_vkCommandBuffers[m_currentImageIndex] );
+    vkCmdEndRenderPass( device->m_vkCommandBuffers[m_frameIndex] );
+}
+
+void
+voSwapChain::CreateFrames( voDeviceContext * device, uint32_t framesInFlight )
+{
+    framesInFlight = std::clamp( framesInFlight, 1U, MAX_FRAMES_IN_FLIGHT );
+
+    VkSemaphoreCreateInfo semaphoreInfo = { .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO };
+
+    m_frames.resize( framesInFlight );
+    m_frameIndex = 0;
+
+    for( auto & frame : m_frames )
+        {
+            frame.submitValue = 0;
+
+            VK_CHECK( vkCreateSemaphore( device->deviceInfo.logical, &semaphoreInfo, nullptr, &frame.imageAvailableSemaphore ),
+                      "Failed to create semaphore!" );
+        }
 }
 
 void
 voSwapChain::CreateSemaphores( voDeviceContext * device )
 {
+    if( m_vkRenderFinishedSemaphores.size() == m_buffers.size() )
+        {
+            return;
+        }
+
+    // Pending presentations may still wait on the previous semaphores
+    device->m_deletionQueue.Destroy(
+        [oldSemaphores = m_vkRenderFinishedSemaphores]( voDeviceContext * device )
+        {
+            for( VkSemaphore semaphore : oldSemaphores )
+                {
+                    vkDestroySemaphore( device->deviceInfo.logical, semaphore, nullptr );
+                }
+        } );
+
     VkSemaphoreCreateInfo semaphoreInfo = { .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO };
 
-    VK_CHECK( vkCreateSemaphore( device->deviceInfo.logical, &semaphoreInfo, nullptr, &m_vkImageAvailableSemaphore ),
-              "Failed to create semaphore!" );
+    m_vkRenderFinishedSemaphores.resize( m_buffers.size() );
 
-    VK_CHECK( vkCreateSemaphore( device->deviceInfo.logical, &semaphoreInfo, nullptr, &m_vkRenderFinishedSemaphore ),
-              "Failed to create semaphore!" );
+    for( auto & semaphore : m_vkRenderFinishedSemaphores )
+        {
+            VK_CHECK( vkCreateSemaphore( device->deviceInfo.logical, &semaphoreInfo, nullptr, &semaphore ),
+                      "Failed to create semaphore!" );
+        }
 }
 
 void
@@ -319,18 +430,27 @@ voSwapChain::CreateSwapchain( voDeviceContext * device )
     VK_CHECK( vkCreateSwapchainKHR( device->deviceInfo.logical, &createInfo, VK_NULL_HANDLE, &m_vkSwapChain ),
               "Failed to create swap chain" );
 
-    /* -------------------------------------- Destroy previous Swapchain ------------------------------------------------ */
-    // If recreating a swapchain, destroy the previous one.
-    // Cleans all presentable images
+    /* -------------------------------------- Retire previous Swapchain ------------------------------------------------- */
+    // If recreating a swapchain, the previous one is retired: its images may still be rendered to or presented
+    // by the frames in flight, so it is destroyed along with its views once they have been executed
     if( VK_NULL_HANDLE != oldSwapchain )
         {
+            std::vector< VkImageView > oldViews;
             for( auto & buffer : m_buffers )
                 {
-                    vkDestroyImageView( device->deviceInfo.logical, buffer.view, VK_NULL_HANDLE );
+                    oldViews.push_back( buffer.view );
                 }
 
-            // swapchain
-            vkDestroySwapchainKHR( device->deviceInfo.logical, oldSwapchain, VK_NULL_HANDLE );
+            device->m_deletionQueue.Destroy(
+                [oldSwapchain, oldViews]( voDeviceContext * device )
+                {
+                    for( VkImageView view : oldViews )
+                        {
+                            vkDestroyImageView( device->deviceInfo.logical, view, VK_NULL_HANDLE );
+                        }
+
+                    vkDestroySwapchainKHR( device->deviceInfo.logical, oldSwapchain, VK_NULL_HANDLE );
+                } );
         }
 
     /* -------------------------------------- Color images -------------------------------------------------------------- */
@@ -387,12 +507,15 @@ voSwapChain::CreateSwapchain( voDeviceContext * device )
 void
 voSwapChain::CreateDepthStencil( voDeviceContext * device )
 {
-    // Clear previous depth image
+    // Retire previous depth image, frames in flight may still be using it
     if( VK_NULL_HANDLE != m_vkDepthImageView )
         {
-            vkDestroyImageView( device->deviceInfo.logical, m_vkDepthImageView, nullptr );
-            vkDestroyImage( device->deviceInfo.logical, m_vkDepthImage, nullptr );
-            vkFreeMemory( device->deviceInfo.logical, m_vkDepthImageMemory, nullptr );
+            device->m_deletionQueue.Destroy(
+                [view = m_vkDepthImageView, image = m_vkDepthImage, allocation = m_vmaDepthAllocation]( voDeviceContext * device )
+                {
+                    vkDestroyImageView( device->deviceInfo.logical, view, nullptr );
+                    device->m_memory->DestroyImage( image, allocation );
+                } );
         }
 
     /* -------------------------------------- Depth Format ------------------------------------------------------------ */
@@ -427,32 +550,20 @@ voSwapChain::CreateDepthStencil( voDeviceContext * device )
                 .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED, // Layout of the image data on creation
         };
 
-        VK_CHECK( vkCreateImage( device->deviceInfo.logical, &imageInfo, nullptr, &m_vkDepthImage ),
-                  "Failed to create image" );
-
         /**
-         * `VkMemoryRequirements` provides information about the memory requirements of an image or buffer,
-         * including size, alignment, and memory type indices.
+         * The depth buffer is recreated on every resize and lives as long as the swapchain,
+         * so it gets a dedicated allocation instead of fragmenting the render target pool.
          */
-        VkMemoryRequirements memRequirements {};
-        vkGetImageMemoryRequirements( device->deviceInfo.logical, m_vkDepthImage, &memRequirements );
-
-        VkMemoryAllocateInfo allocInfo =
+        voMemory::AllocationParms_t allocParms =
             {
-                .sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
-                .allocationSize  = memRequirements.size,
-                .memoryTypeIndex = device->FindMemoryTypeIndex( memRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT ),
+                .memoryClass = voMemory::MEMORY_CLASS_RENDER_TARGET,
+                .usage       = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE,
+                .dedicated   = true,
+                .debugName   = "Swapchain Depth",
             };
 
-        VK_CHECK( vkAllocateMemory( device->deviceInfo.logical, &allocInfo, nullptr, &m_vkDepthImageMemory ),
-                  "Failed to allocate image memory" );
-
-        /**
-         * `vkBindImageMemory` associates an image with a memory allocation,
-         * effectively assigning the memory to store the image data.
-         */
-        VK_CHECK( vkBindImageMemory( device->deviceInfo.logical, m_vkDepthImage, m_vkDepthImageMemory, 0 ),
-                  "Failed to bind image memory" );
+        VK_CHECK( device->m_memory->CreateImage( imageInfo, allocParms, m_vkDepthImage, m_vmaDepthAllocation ),
+                  "Failed to create image" );
     }
 
     /* -------------------------------------- Create Depth Image View ------------------------------------------------------ */
@@ -564,11 +675,13 @@ voSwapChain::CreateRenderPass( voDeviceContext * device )
             .srcSubpass = VK_SUBPASS_EXTERNAL,
             .dstSubpass = 0,
 
-            .srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
-            .dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+            // The depth buffer is shared by every frame in flight, so the previous frame's depth writes are waited on too
+            .srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+            .dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT,
 
-            .srcAccessMask = 0,
-            .dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+            .srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+            .dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
+                             VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
         };
 
     /* -------------------------------------- Render Pass -------------------------------------------------------------------- */
@@ -593,13 +706,17 @@ voSwapChain::CreateRenderPass( voDeviceContext * device )
 void
 voSwapChain::CreateFramebuffers( voDeviceContext * device )
 {
-    /* -------------------------------------- Cleanup Framebuffers ------------------------------------------------------ */
+    /* -------------------------------------- Retire Framebuffers ------------------------------------------------------- */
     if( !m_framebuffers.empty() )
         {
-            for( auto & framebuffer : m_framebuffers )
+            device->m_deletionQueue.Destroy(
+                [oldFramebuffers = m_framebuffers]( voDeviceContext * device )
                 {
-                    vkDestroyFramebuffer( device->deviceInfo.logical, framebuffer, nullptr );
-                }
+                    for( VkFramebuffer framebuffer : oldFramebuffers )
+                        {
+                            vkDestroyFramebuffer( device->deviceInfo.logical, framebuffer, nullptr );
+                        }
+                } );
             m_framebuffers.clear();
         }
 
@@ -0,0 +1,63 @@
+#include "vulkano/vo_uniformAllocator.hpp"
+#include <algorithm>
+#include "vulkano/vo_deviceContext.hpp"
+
+bool
+voUniformAllocator::Create( voDeviceContext * device, const CreateParms_t & parms )
+{
+    const VkPhysicalDeviceLimits & limits = device->GetPhysicalProperties()->deviceProperties.limits;
+
+    m_alignment = std::max< VkDeviceSize >( limits.minUniformBufferOffsetAlignment, 16 );
+    m_frameSize = ( parms.frameSize + m_alignment - 1 ) & ~( m_alignment - 1 );
+    m_numFrames = std::max( parms.numFrames, 1U );
+    m_frame     = 0;
+    m_head      = 0;
+
+    voBuffer::CreateParms_t bufferParms =
+        {
+            .size        = m_frameSize * m_numFrames,
+            .usageFlags  = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+            .memoryClass = voMemory::MEMORY_CLASS_FRAME_LINEAR,
+            .persistent  = true,
+        };
+
+    return m_buffer.Create( device, bufferParms );
+}
+
+void
+voUniformAllocator::Cleanup( voDeviceContext * device )
+{
+    m_buffer.Cleanup( device );
+    m_buffer = {};
+}
+
+void
+voUniformAllocator::BeginFrame( uint32_t frameIndex )
+{
+    m_frame = frameIndex % m_numFrames;
+    m_head  = 0;
+}
+
+void
+voUniformAllocator::EndFrame( voDeviceContext * device )
+{
+    m_buffer.MarkDirty( m_frameSize * m_frame, m_head );
+    m_buffer.FlushDirty( device );
+}
+
+voUniformAllocator::allocation_t< void >
+voUniformAllocator::Allocate( VkDeviceSize size )
+{
+    const VkDeviceSize alignedSize = ( size + m_alignment - 1 ) & ~( m_alignment - 1 );
+
+    if( m_head + alignedSize > m_frameSize )
+        {
+            spdlog::error( "Uniform allocator out of space ({} of {} bytes used)", m_head, m_frameSize );
+            return {};
+        }
+
+    const VkDeviceSize offset = m_frameSize * m_frame + m_head;
+    m_head += alignedSize;
+
+    return { static_cast< uint8_t * >( m_buffer.GetMappedPtr() ) + offset, static_cast< uint32_t >( offset ) };
+}
@@ -0,0 +1,667 @@
+#include "vulkano/vo_uploadContext.hpp"
+#include <algorithm>
+#include <cstring>
+#include "vulkano/vo_deviceContext.hpp"
+
+/// Stages allowed to consume uploaded data
+#ifndef UPLOAD_CONSUMER_STAGES
+#    define UPLOAD_CONSUMER_STAGES ( VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT )
+#endif /** UPLOAD_CONSUMER_STAGES */
+
+/// Accesses allowed to consume uploaded data
+#ifndef UPLOAD_CONSUMER_ACCESS
+#    define UPLOAD_CONSUMER_ACCESS ( VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_UNIFORM_READ_BIT | VK_ACCESS_SHADER_READ_BIT )
+#endif /** UPLOAD_CONSUMER_ACCESS */
+
+bool
+voUploadContext::Create( voDeviceContext * device, const CreateParms_t & parms )
+{
+    m_stagingSize = parms.stagingSize;
+    m_frameBudget = parms.frameBudget;
+    m_stagingHead = 0;
+    m_batchBegin  = 0;
+
+    m_transferQueue = device->GetTransferQueue();
+    m_graphicsQueue = &device->m_graphicsQueue;
+
+    // Keep every copy source aligned for the transfer engine
+    const VkPhysicalDeviceLimits & limits = device->GetPhysicalProperties()->deviceProperties.limits;
+    m_copyAlignment = std::max< VkDeviceSize >( limits.optimalBufferCopyOffsetAlignment, 16 );
+
+    /* ------------------------------------------------ Staging Ring ---------------------------------------------------- */
+    {
+        VkBufferCreateInfo bufferInfo =
+            {
+                .sType       = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+                .size        = m_stagingSize,
+                .usage       = VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+            };
+
+        voMemory::AllocationParms_t allocParms =
+            {
+                .memoryClass = voMemory::MEMORY_CLASS_DEFAULT,
+                .usage       = VMA_MEMORY_USAGE_AUTO_PREFER_HOST,
+                .flags       = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT,
+                .dedicated   = true,
+                .debugName   = "Staging Ring",
+            };
+
+        VmaAllocationInfo allocationInfo {};
+        VK_CHECK( device->m_memory->CreateBuffer( bufferInfo, allocParms, m_vkStagingBuffer, m_vmaStagingAllocation, &allocationInfo ),
+                  "Failed to create staging buffer" );
+
+        m_stagingPtr = static_cast< uint8_t * >( allocationInfo.pMappedData );
+    }
+
+    /* ------------------------------------------------ Command Pools --------------------------------------------------- */
+    {
+        VkCommandPoolCreateInfo poolInfo =
+            {
+                .sType            = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+                .flags            = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+                .queueFamilyIndex = m_transferQueue->GetFamily(),
+            };
+
+        VK_CHECK( vkCreateCommandPool( device->deviceInfo.logical, &poolInfo, nullptr, &m_vkCommandPool ),
+                  "Failed to create upload command pool" );
+
+        // Ownership acquisitions and copies into buffers in use are recorded on the graphics family
+        if( IsOwnershipTransfer() )
+            {
+                poolInfo.queueFamilyIndex = m_graphicsQueue->GetFamily();
+
+                VK_CHECK( vkCreateCommandPool( device->deviceInfo.logical, &poolInfo, nullptr, &m_vkGraphicsPool ),
+                          "Failed to create upload graphics command pool" );
+            }
+    }
+
+    return true;
+}
+
+void
+voUploadContext::Cleanup( voDeviceContext * device )
+{
+    std::lock_guard< std::recursive_mutex > lock( m_mutex );
+
+    // Queued uploads are dropped, their destinations are being destroyed anyway
+    m_queuedUploads.clear();
+
+    Flush( device );
+
+    while( !m_inFlight.empty() )
+        {
+            Retire( device, true );
+        }
+
+    RunCallbacks( device );
+
+    vkDestroyCommandPool( device->deviceInfo.logical, m_vkGraphicsPool, nullptr );
+    vkDestroyCommandPool( device->deviceInfo.logical, m_vkCommandPool, nullptr );
+    device->m_memory->DestroyBuffer( m_vkStagingBuffer, m_vmaStagingAllocation );
+
+    m_vkGraphicsPool       = VK_NULL_HANDLE;
+    m_vkCommandPool        = VK_NULL_HANDLE;
+    m_vkStagingBuffer      = VK_NULL_HANDLE;
+    m_vmaStagingAllocation = VK_NULL_HANDLE;
+    m_stagingPtr           = nullptr;
+}
+
+void
+voUploadContext::UploadBuffer( voDeviceContext * device, VkBuffer dstBuffer, VkDeviceSize dstOffset, const void * data, VkDeviceSize size, bool dstInUse )
+{
+    std::lock_guard< std::recursive_mutex > lock( m_mutex );
+
+    const auto * src = static_cast< const uint8_t * >( data );
+
+    // Stream the data in chunks no larger than the ring
+    while( size > 0 )
+        {
+            const VkDeviceSize chunkSize = std::min( size, m_stagingSize );
+            const VkDeviceSize srcOffset = Reserve( device, chunkSize );
+
+            memcpy( m_stagingPtr + srcOffset, src, chunkSize );
+
+            m_pendingCopies.push_back(
+                {
+                    .dstBuffer = dstBuffer,
+                    .region    = {
+                                  .srcOffset = srcOffset,
+                                  .dstOffset = dstOffset,
+                                  .size      = chunkSize },
+                    .dstInUse  = dstInUse,
+            } );
+
+            src += chunkSize;
+            dstOffset += chunkSize;
+            size -= chunkSize;
+        }
+
+    // Outside of a batch the upload is submitted before returning
+    if( m_batchDepth == 0 )
+        {
+            Flush( device );
+        }
+}
+
+void
+voUploadContext::UploadImage( voDeviceContext * device, VkImage dstImage, VkImageAspectFlags aspect, VkExtent3D extent, const void * data, VkDeviceSize size, VkImageLayout finalLayout )
+{
+    std::lock_guard< std::recursive_mutex > lock( m_mutex );
+
+    voAssert( size <= m_stagingSize && "Image larger than the staging ring" );
+
+    const VkDeviceSize srcOffset = Reserve( device, size );
+
+    memcpy( m_stagingPtr + srcOffset, data, size );
+
+    m_pendingImages.push_back(
+        {
+            .image     = dstImage,
+            .range     = { .aspectMask = aspect, .baseMipLevel = 0, .levelCount = 1, .baseArrayLayer = 0, .layerCount = 1 },
+            .oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+            .newLayout = finalLayout,
+            .region    = {
+                          .bufferOffset     = srcOffset,
+                          .imageSubresource = { .aspectMask = aspect, .mipLevel = 0, .baseArrayLayer = 0, .layerCount = 1 },
+                          .imageExtent      = extent },
+            .hasCopy   = true,
+    } );
+
+    if( m_batchDepth == 0 )
+        {
+            Flush( device );
+        }
+}
+
+void
+voUploadContext::TransitionImage( voDeviceContext * device, VkImage image, VkImageAspectFlags aspect, VkImageLayout oldLayout, VkImageLayout newLayout )
+{
+    std::lock_guard< std::recursive_mutex > lock( m_mutex );
+
+    m_pendingImages.push_back(
+        {
+            .image     = image,
+            .range     = { .aspectMask = aspect, .baseMipLevel = 0, .levelCount = VK_REMAINING_MIP_LEVELS, .baseArrayLayer = 0, .layerCount = VK_REMAINING_ARRAY_LAYERS },
+            .oldLayout = oldLayout,
+            .newLayout = newLayout,
+            .region    = {},
+            .hasCopy   = false,
+        } );
+
+    if( m_batchDepth == 0 )
+        {
+            Flush( device );
+        }
+}
+
+void
+voUploadContext::Record( voDeviceContext * device, const std::function< void( VkCommandBuffer ) > & func )
+{
+    std::lock_guard< std::recursive_mutex > lock( m_mutex );
+
+    if( m_setupCmd == VK_NULL_HANDLE )
+        {
+            m_setupCmd = BeginCommandBuffer( device, GetGraphicsPool() );
+        }
+
+    func( m_setupCmd );
+
+    if( m_batchDepth == 0 )
+        {
+            Flush( device );
+        }
+}
+
+bool
+voUploadContext::IsComplete( voDeviceContext * device, token_t token )
+{
+    std::lock_guard< std::recursive_mutex > lock( m_mutex );
+
+    // Still being collected, or nothing was ever recorded for it
+    if( token > m_submittedToken )
+        {
+            return !HasPendingCopies();
+        }
+
+    Retire( device, false );
+    return token <= m_retiredToken;
+}
+
+void
+voUploadContext::Wait( voDeviceContext * device, token_t token )
+{
+    std::lock_guard< std::recursive_mutex > lock( m_mutex );
+
+    if( token > m_submittedToken )
+        {
+            Flush( device );
+        }
+
+    while( token > m_retiredToken && token <= m_submittedToken )
+        {
+            Retire( device, true );
+        }
+}
+
+void
+voUploadContext::OnComplete( token_t token, callback_t && callback )
+{
+    std::lock_guard< std::recursive_mutex > lock( m_mutex );
+
+    m_completions.push_back( { token, std::move( callback ) } );
+}
+
+void
+voUploadContext::RunCallbacks( voDeviceContext * device )
+{
+    if( m_completions.empty() )
+        {
+            return;
+        }
+
+    // Callbacks may register other callbacks, they are run from a copy
+    std::vector< completion_t > completed;
+    for( auto it = m_completions.begin(); it != m_completions.end(); )
+        {
+            if( IsComplete( device, it->token ) )
+                {
+                    completed.push_back( std::move( *it ) );
+                    it = m_completions.erase( it );
+                }
+            else
+                {
+                    ++it;
+                }
+        }
+
+    for( completion_t & completion : completed )
+        {
+            completion.callback();
+        }
+}
+
+void
+voUploadContext::Enqueue( VkBuffer dstBuffer, VkDeviceSize dstOffset, const void * data, VkDeviceSize size )
+{
+    std::lock_guard< std::recursive_mutex > lock( m_mutex );
+
+    const auto * src = static_cast< const uint8_t * >( data );
+
+    m_queuedUploads.push_back(
+        {
+            .dstBuffer = dstBuffer,
+            .dstOffset = dstOffset,
+            .consumed  = 0,
+            .data      = std::vector< uint8_t >( src, src + size ),
+        } );
+}
+
+void
+voUploadContext::Pump( voDeviceContext * device )
+{
+    std::lock_guard< std::recursive_mutex > lock( m_mutex );
+
+    Retire( device, false );
+    RunCallbacks( device );
+
+    if( m_queuedUploads.empty() )
+        {
+            return;
+        }
+
+    VkDeviceSize budget = m_frameBudget;
+
+    BeginBatch();
+
+    // Oldest uploads first, the last one may be split across frames
+    while( budget > 0 && !m_queuedUploads.empty() )
+        {
+            queued_upload_t & upload = m_queuedUploads.front();
+
+            const VkDeviceSize remaining = upload.data.size() - upload.consumed;
+            const VkDeviceSize chunkSize = std::min( remaining, budget );
+
+            UploadBuffer( device, upload.dstBuffer, upload.dstOffset + upload.consumed, upload.data.data() + upload.consumed, chunkSize, false );
+
+            upload.consumed += chunkSize;
+            budget -= chunkSize;
+
+            if( upload.consumed == upload.data.size() )
+                {
+                    m_queuedUploads.pop_front();
+                }
+        }
+
+    EndBatch( device );
+}
+
+VkDeviceSize
+voUploadContext::Reserve( voDeviceContext * device, VkDeviceSize size )
+{
+    VkDeviceSize offset = ( m_stagingHead + m_copyAlignment - 1 ) & ~( m_copyAlignment - 1 );
+
+    // Ring is full, submit what is pending and wrap around
+    if( offset + size > m_stagingSize )
+        {
+            Flush( device );
+            offset = 0;
+        }
+
+    // Wait for the submitted batches still reading the region
+    const auto overlaps = [&]( const in_flight_t & batch ) { return batch.stagingBegin < offset + size && offset < batch.stagingEnd; };
+    while( std::any_of( m_inFlight.begin(), m_inFlight.end(), overlaps ) )
+        {
+            Retire( device, true );
+        }
+
+    if( !HasStagedCopies() )
+        {
+            m_batchBegin = offset;
+        }
+
+    m_stagingHead = offset + size;
+    return offset;
+}
+
+void
+voUploadContext::Retire( voDeviceContext * device, bool wait )
+{
+    if( wait && !m_inFlight.empty() )
+        {
+            m_graphicsQueue->Wait( device, m_inFlight.front().value );
+        }
+
+    while( !m_inFlight.empty() && m_graphicsQueue->IsComplete( device, m_inFlight.front().value ) )
+        {
+            const in_flight_t & batch = m_inFlight.front();
+
+            if( batch.transferCmd != VK_NULL_HANDLE )
+                {
+                    vkFreeCommandBuffers( device->deviceInfo.logical, m_vkCommandPool, 1, &batch.transferCmd );
+                }
+            if( batch.setupCmd != VK_NULL_HANDLE )
+                {
+                    vkFreeCommandBuffers( device->deviceInfo.logical, GetGraphicsPool(), 1, &batch.setupCmd );
+                }
+            vkFreeCommandBuffers( device->deviceInfo.logical, GetGraphicsPool(), 1, &batch.graphicsCmd );
+
+            m_retiredToken = batch.token;
+
+            m_inFlight.pop_front();
+        }
+}
+
+VkCommandBuffer
+voUploadContext::BeginCommandBuffer( voDeviceContext * device, VkCommandPool pool )
+{
+    VkCommandBufferAllocateInfo allocInfo =
+        {
+            .sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+            .commandPool        = pool,
+            .level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+            .commandBufferCount = 1,
+        };
+
+    VkCommandBuffer cmdBuffer;
+    VK_CHECK( vkAllocateCommandBuffers( device->deviceInfo.logical, &allocInfo, &cmdBuffer ),
+              "Failed to allocate upload command buffer" );
+
+    VkCommandBufferBeginInfo beginInfo =
+        {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+            .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+        };
+
+    VK_CHECK( vkBeginCommandBuffer( cmdBuffer, &beginInfo ),
+              "Failed to begin upload command buffer" );
+
+    return cmdBuffer;
+}
+
+void
+voUploadContext::RecordCopies( VkCommandBuffer cmdBuffer, const pending_copy_t * copies, size_t numCopies, std::vector< VkBuffer > & dstBuffers ) const
+{
+    std::vector< VkBufferCopy > regions;
+    regions.reserve( numCopies );
+
+    for( size_t i = 0; i < numCopies; ++i )
+        {
+            regions.push_back( copies[i].region );
+
+            const bool isLast = ( i + 1 == numCopies ) || ( copies[i + 1].dstBuffer != copies[i].dstBuffer );
+            if( isLast )
+                {
+                    vkCmdCopyBuffer( cmdBuffer, m_vkStagingBuffer, copies[i].dstBuffer,
+                                     static_cast< uint32_t >( regions.size() ), regions.data() );
+                    regions.clear();
+
+                    dstBuffers.push_back( copies[i].dstBuffer );
+                }
+        }
+}
+
+void
+voUploadContext::RecordImages( VkCommandBuffer cmdBuffer ) const
+{
+    std::vector< VkImageMemoryBarrier > barriers;
+    barriers.reserve( m_pendingImages.size() );
+
+    // Transitions, to the transfer layout for the images being filled
+    for( const pending_image_t & image : m_pendingImages )
+        {
+            barriers.push_back(
+                {
+                    .sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+                    .srcAccessMask       = VK_ACCESS_MEMORY_WRITE_BIT,
+                    .dstAccessMask       = image.hasCopy ? VkAccessFlags( VK_ACCESS_TRANSFER_WRITE_BIT ) : VkAccessFlags( VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT ),
+                    .oldLayout           = image.oldLayout,
+                    .newLayout           = image.hasCopy ? VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL : image.newLayout,
+                    .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                    .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                    .image               = image.image,
+                    .subresourceRange    = image.range,
+                } );
+        }
+
+    vkCmdPipelineBarrier( cmdBuffer,
+                          VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                          0, 0, nullptr, 0, nullptr, static_cast< uint32_t >( barriers.size() ), barriers.data() );
+
+    // Copies, then the images being filled go to their final layout
+    barriers.clear();
+    for( const pending_image_t & image : m_pendingImages )
+        {
+            if( !image.hasCopy )
+                {
+                    continue;
+                }
+
+            vkCmdCopyBufferToImage( cmdBuffer, m_vkStagingBuffer, image.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &image.region );
+
+            barriers.push_back(
+                {
+                    .sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+                    .srcAccessMask       = VK_ACCESS_TRANSFER_WRITE_BIT,
+                    .dstAccessMask       = VK_ACCESS_MEMORY_READ_BIT,
+                    .oldLayout           = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                    .newLayout           = image.newLayout,
+                    .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                    .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                    .image               = image.image,
+                    .subresourceRange    = image.range,
+                } );
+        }
+
+    if( !barriers.empty() )
+        {
+            vkCmdPipelineBarrier( cmdBuffer,
+                                  VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                                  0, 0, nullptr, 0, nullptr, static_cast< uint32_t >( barriers.size() ), barriers.data() );
+        }
+}
+
+voUploadContext::token_t
+voUploadContext::Flush( voDeviceContext * device )
+{
+    std::lock_guard< std::recursive_mutex > lock( m_mutex );
+
+    if( !HasPendingCopies() )
+        {
+            return m_submittedToken;
+        }
+
+    const auto byBuffer = []( const pending_copy_t & a, const pending_copy_t & b ) { return a.dstBuffer < b.dstBuffer; };
+
+    // Fresh destinations first, copies to the same destination are recorded with a single command
+    const auto inUseBegin = std::stable_partition( m_pendingCopies.begin(), m_pendingCopies.end(),
+                                                   []( const pending_copy_t & copy ) { return !copy.dstInUse; } );
+    std::stable_sort( m_pendingCopies.begin(), inUseBegin, byBuffer );
+    std::stable_sort( inUseBegin, m_pendingCopies.end(), byBuffer );
+
+    const size_t numFresh = static_cast< size_t >( inUseBegin - m_pendingCopies.begin() );
+
+    // Batches made of transitions and records only do not hold any staging memory
+    in_flight_t batch =
+        {
+            .stagingBegin = HasStagedCopies() ? m_batchBegin : 0,
+            .stagingEnd   = HasStagedCopies() ? m_stagingHead : 0,
+            .value        = 0,
+            .token        = ++m_submittedToken,
+            .transferCmd  = VK_NULL_HANDLE,
+            .graphicsCmd  = VK_NULL_HANDLE,
+            .setupCmd     = m_setupCmd,
+        };
+
+    std::vector< VkBufferMemoryBarrier > ownershipBarriers;
+    voQueue::wait_t                      transferWait {};
+    size_t                               graphicsBegin = 0; ///< First copy recorded on the graphics queue
+
+    /* ------------------------------------------------ Transfer -------------------------------------------------------- */
+    if( IsOwnershipTransfer() && numFresh > 0 )
+        {
+            batch.transferCmd = BeginCommandBuffer( device, m_vkCommandPool );
+
+            std::vector< VkBuffer > dstBuffers;
+            RecordCopies( batch.transferCmd, m_pendingCopies.data(), numFresh, dstBuffers );
+
+            // One ownership barrier per destination buffer
+            for( VkBuffer dstBuffer : dstBuffers )
+                {
+                    ownershipBarriers.push_back(
+                        {
+                            .sType               = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+                            .srcAccessMask       = VK_ACCESS_TRANSFER_WRITE_BIT,
+                            .dstAccessMask       = 0,
+                            .srcQueueFamilyIndex = m_transferQueue->GetFamily(),
+                            .dstQueueFamilyIndex = m_graphicsQueue->GetFamily(),
+                            .buffer              = dstBuffer,
+                            .offset              = 0,
+                            .size                = VK_WHOLE_SIZE,
+                        } );
+                }
+
+            // Release the destinations to the graphics family
+            vkCmdPipelineBarrier( batch.transferCmd,
+                                  VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                                  0, 0, nullptr, static_cast< uint32_t >( ownershipBarriers.size() ), ownershipBarriers.data(), 0, nullptr );
+
+            VK_CHECK( vkEndCommandBuffer( batch.transferCmd ),
+                      "Failed to end upload command buffer" );
+
+            voQueue::submit_t submit =
+                {
+                    .numCommandBuffers = 1,
+                    .commandBuffers    = &batch.transferCmd,
+                };
+
+            // The graphics queue waits for the copies on the GPU
+            transferWait =
+                {
+                    .queue  = m_transferQueue,
+                    .value  = m_transferQueue->Submit( device, submit ),
+                    .stages = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                };
+
+            graphicsBegin = numFresh;
+        }
+
+    /* ------------------------------------------------ Graphics -------------------------------------------------------- */
+    {
+        batch.graphicsCmd = BeginCommandBuffer( device, GetGraphicsPool() );
+
+        if( !ownershipBarriers.empty() )
+            {
+                // Acquire the destinations released by the transfer family
+                for( VkBufferMemoryBarrier & barrier : ownershipBarriers )
+                    {
+                        barrier.srcAccessMask = 0;
+                        barrier.dstAccessMask = UPLOAD_CONSUMER_ACCESS;
+                    }
+
+                vkCmdPipelineBarrier( batch.graphicsCmd,
+                                      VK_PIPELINE_STAGE_TRANSFER_BIT, UPLOAD_CONSUMER_STAGES,
+                                      0, 0, nullptr, static_cast< uint32_t >( ownershipBarriers.size() ), ownershipBarriers.data(), 0, nullptr );
+            }
+
+        if( numFresh < m_pendingCopies.size() )
+            {
+                // Earlier frames may still read the destinations, an execution dependency is enough for write-after-read
+                vkCmdPipelineBarrier( batch.graphicsCmd,
+                                      UPLOAD_CONSUMER_STAGES, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                      0, 0, nullptr, 0, nullptr, 0, nullptr );
+            }
+
+        std::vector< VkBuffer > dstBuffers;
+        RecordCopies( batch.graphicsCmd, m_pendingCopies.data() + graphicsBegin, m_pendingCopies.size() - graphicsBegin, dstBuffers );
+
+        if( !dstBuffers.empty() )
+            {
+                // Make the transfer visible to every stage that may consume the uploaded data
+                VkMemoryBarrier barrier =
+                    {
+                        .sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+                        .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+                        .dstAccessMask = UPLOAD_CONSUMER_ACCESS,
+                    };
+
+                vkCmdPipelineBarrier( batch.graphicsCmd,
+                                      VK_PIPELINE_STAGE_TRANSFER_BIT, UPLOAD_CONSUMER_STAGES,
+                                      0, 1, &barrier, 0, nullptr, 0, nullptr );
+            }
+
+        if( !m_pendingImages.empty() )
+            {
+                RecordImages( batch.graphicsCmd );
+            }
+
+        VK_CHECK( vkEndCommandBuffer( batch.graphicsCmd ),
+                  "Failed to end upload graphics command buffer" );
+
+        if( batch.setupCmd != VK_NULL_HANDLE )
+            {
+                VK_CHECK( vkEndCommandBuffer( batch.setupCmd ),
+                          "Failed to end upload setup command buffer" );
+            }
+
+        // Later submissions of the graphics queue are ordered after the uploads
+        const VkCommandBuffer cmdBuffers[] = { batch.graphicsCmd, batch.setupCmd };
+
+        voQueue::submit_t submit =
+            {
+                .numCommandBuffers = batch.setupCmd != VK_NULL_HANDLE ? 2U : 1U,
+                .commandBuffers    = cmdBuffers,
+                .numWaits          = transferWait.value != 0 ? 1U : 0U,
+                .waits             = &transferWait,
+            };
+
+        batch.value = m_graphicsQueue->Submit( device, submit );
+    }
+
+    m_inFlight.push_back( batch );
+    m_pendingCopies.clear();
+    m_pendingImages.clear();
+    m_setupCmd = VK_NULL_HANDLE;
+
+    return batch.token;
+}